@@ -0,0 +1,148 @@
+#
+# Copyright (C) 2021 Dr. Michael Steffens
+#
+# SPDX-License-Identifier:	BSL-1.0
+#
+
+set(BUILTIN_CONFIGURATION_TEMPLATE ${CMAKE_CURRENT_LIST_DIR}/BuiltinConfigurationTables.h.in)
+
+# Fails configuration on any item ParseConfiguration would reject, given a configuration stripped of white space. Pool
+# ranges are checked for being disjunct and ascending at compile time.
+function(validate_builtin_configuration configuration)
+	if(NOT configuration MATCHES "^{(.*)}$")
+		message(FATAL_ERROR "ARENA_ALLOCATOR_BUILTIN_CONFIGURATION: expected '{' ... '}' around configuration items")
+	endif()
+	set(items "${CMAKE_MATCH_1}")
+	if(items MATCHES ",$")
+		message(FATAL_ERROR "ARENA_ALLOCATOR_BUILTIN_CONFIGURATION: unexpected ',' after last configuration item")
+	endif()
+	set(pool "\\[[0-9]+,[0-9]+\\]:[0-9]+")
+	set(control "(signal:[1-9][0-9]*|socket:[0-9]+|page:[0-9]+)")
+	set(profile "(sizes|threads):[0-9]+")
+	set(phase "(signal:[1-9][0-9]*|seconds:[0-9]+)")
+	set(itemPatterns
+		"class:[A-Za-z0-9_]+(\\([A-Za-z0-9_]+)*\\)*"
+		"logLevel:(NONE|ERROR|INFO|TRACE|DEBUG)"
+		"logger:[A-Za-z0-9_]+"
+		"sampling:{(rate|interval):[1-9][0-9]*}"
+		"control:{(${control}(,${control})*)?}"
+		"profile:{(${profile}(,${profile})*)?}"
+		"phase:{(${phase}(,${phase})*)?}"
+		"pools:{(${pool}(,${pool})*)?}")
+	set(seen "")
+	while(NOT items STREQUAL "")
+		set(item "")
+		foreach(pattern IN LISTS itemPatterns)
+			if(item STREQUAL "" AND items MATCHES "^(${pattern})(,|$)")
+				set(item "${CMAKE_MATCH_1}")
+				string(LENGTH "${CMAKE_MATCH_0}" length)
+			endif()
+		endforeach()
+		if(item STREQUAL "")
+			message(FATAL_ERROR "ARENA_ALLOCATOR_BUILTIN_CONFIGURATION: invalid or unsupported item at \"${items}\"")
+		endif()
+		string(REGEX MATCH "^[A-Za-z]+" name "${item}")
+		if(name IN_LIST seen)
+			message(FATAL_ERROR "ARENA_ALLOCATOR_BUILTIN_CONFIGURATION: duplicate ${name} item")
+		endif()
+		list(APPEND seen ${name})
+		if(name STREQUAL "class")
+			string(REGEX MATCHALL "\\(" opening "${item}")
+			string(REGEX MATCHALL "\\)" closing "${item}")
+			list(LENGTH opening nOpening)
+			list(LENGTH closing nClosing)
+			if(NOT nOpening EQUAL nClosing)
+				message(FATAL_ERROR "ARENA_ALLOCATOR_BUILTIN_CONFIGURATION: unbalanced parentheses in \"${item}\"")
+			endif()
+		endif()
+		string(SUBSTRING "${items}" ${length} -1 items)
+	endwhile()
+endfunction()
+
+# Generates ArenaAllocator/BuiltinConfigurationTables.h from a configuration file using the same grammar as the
+# ARENA_ALLOCATOR_CONFIGURATION environment variable. Without a file, the generated tables are marked unavailable.
+function(generate_builtin_configuration CONFIGURATION_FILE OUTPUT_FILE)
+	set(BUILTIN_AVAILABLE false)
+	set(BUILTIN_CLASS "std::nullopt")
+	set(BUILTIN_LOG_LEVEL "std::nullopt")
+	set(BUILTIN_LOGGER "std::nullopt")
+	set(BUILTIN_SAMPLING "std::nullopt")
+	set(BUILTIN_CONTROL "std::nullopt")
+	set(BUILTIN_PROFILE "std::nullopt")
+	set(BUILTIN_PHASE "std::nullopt")
+	set(BUILTIN_POOLS "")
+	set(BUILTIN_N_POOLS 0)
+	if(CONFIGURATION_FILE)
+		if(NOT EXISTS "${CONFIGURATION_FILE}")
+			message(FATAL_ERROR "ARENA_ALLOCATOR_BUILTIN_CONFIGURATION: ${CONFIGURATION_FILE} not found")
+		endif()
+		set_property(DIRECTORY APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS "${CONFIGURATION_FILE}")
+		file(READ "${CONFIGURATION_FILE}" configuration)
+		string(REGEX REPLACE "[ \t\r\n]" "" configuration "${configuration}")
+		validate_builtin_configuration("${configuration}")
+		set(BUILTIN_AVAILABLE true)
+		if(configuration MATCHES "class:([A-Za-z0-9_()]+)")
+			set(BUILTIN_CLASS "\"${CMAKE_MATCH_1}\"")
+		endif()
+		if(configuration MATCHES "logLevel:(NONE|ERROR|INFO|TRACE|DEBUG)")
+			set(BUILTIN_LOG_LEVEL "LogLevel::${CMAKE_MATCH_1}")
+		endif()
+		if(configuration MATCHES "logger:([A-Za-z0-9_]+)")
+			set(BUILTIN_LOGGER "\"${CMAKE_MATCH_1}\"")
+		endif()
+		if(configuration MATCHES "sampling:{rate:([1-9][0-9]*)}")
+			set(BUILTIN_SAMPLING "Sampling{Sampling::Mode::RATE, ${CMAKE_MATCH_1}U}")
+		elseif(configuration MATCHES "sampling:{interval:([1-9][0-9]*)}")
+			set(BUILTIN_SAMPLING "Sampling{Sampling::Mode::INTERVAL, ${CMAKE_MATCH_1}U}")
+		endif()
+		if(configuration MATCHES "control:{([^}]*)}")
+			set(control "${CMAKE_MATCH_1}")
+			set(controlSignal 0)
+			set(controlSocket false)
+			set(controlPage false)
+			if(control MATCHES "signal:([0-9]+)")
+				set(controlSignal ${CMAKE_MATCH_1})
+			endif()
+			if(control MATCHES "socket:([1-9][0-9]*)")
+				set(controlSocket true)
+			endif()
+			if(control MATCHES "page:([1-9][0-9]*)")
+				set(controlPage true)
+			endif()
+			set(BUILTIN_CONTROL "Control{${controlSignal}, ${controlSocket}, ${controlPage}}")
+		endif()
+		if(configuration MATCHES "profile:{([^}]*)}")
+			set(profile "${CMAKE_MATCH_1}")
+			set(profileSizes false)
+			set(profileThreads false)
+			if(profile MATCHES "sizes:([1-9][0-9]*)")
+				set(profileSizes true)
+			endif()
+			if(profile MATCHES "threads:([1-9][0-9]*)")
+				set(profileThreads true)
+			endif()
+			set(BUILTIN_PROFILE "Profile{${profileSizes}, ${profileThreads}}")
+		endif()
+		if(configuration MATCHES "phase:{([^}]*)}")
+			set(phase "${CMAKE_MATCH_1}")
+			set(phaseSignal 0)
+			set(phaseSeconds 0)
+			if(phase MATCHES "signal:([0-9]+)")
+				set(phaseSignal ${CMAKE_MATCH_1})
+			endif()
+			if(phase MATCHES "seconds:([0-9]+)")
+				set(phaseSeconds ${CMAKE_MATCH_1})
+			endif()
+			set(BUILTIN_PHASE "Phase{${phaseSignal}, ${phaseSeconds}U}")
+		endif()
+		if(configuration MATCHES "pools:{([^}]*)}")
+			string(REGEX MATCHALL "\\[[0-9]+,[0-9]+\\]:[0-9]+" pools "${CMAKE_MATCH_1}")
+			foreach(pool IN LISTS pools)
+				string(REGEX REPLACE "\\[([0-9]+),([0-9]+)\\]:([0-9]+)" "\t{{\\1U, \\2U}, \\3U},\n" entry "${pool}")
+				string(APPEND BUILTIN_POOLS "${entry}")
+				math(EXPR BUILTIN_N_POOLS "${BUILTIN_N_POOLS} + 1")
+			endforeach()
+		endif()
+	endif()
+	configure_file(${BUILTIN_CONFIGURATION_TEMPLATE} "${OUTPUT_FILE}" @ONLY)
+endfunction()
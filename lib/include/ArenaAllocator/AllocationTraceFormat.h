@@ -0,0 +1,45 @@
+//
+// Copyright (C) 2021 Dr. Michael Steffens
+//
+// SPDX-License-Identifier:     BSL-1.0
+//
+
+
+#ifndef ArenaAllocator_AllocationTraceFormat_h_INCLUDED
+#define ArenaAllocator_AllocationTraceFormat_h_INCLUDED
+
+#include <cstdint>
+
+namespace ArenaAllocator {
+
+// Files written by the AllocationTrace allocator are a sequence of blocks, each an AllocationTraceHeader followed by
+// nRecords AllocationTraceRecord entries of a single thread, in the order that thread invoked the operations. Integers
+// are in host byte order.
+struct AllocationTraceHeader
+{
+	static constexpr std::uint32_t magic{0x41524c41}; // "ALRA" in little endian byte order
+
+	std::uint32_t blockMagic;
+	std::uint32_t nRecords;
+	std::uint32_t pid;
+	std::uint32_t tid;
+};
+
+// Pointers are replaced by symbolic allocation ids, unique within a process and never reused. Every successful
+// allocation or reallocation yields a new id, as does a failed reallocation for the pointer left allocated. Each id is
+// therefore passed to at most one operation. 0 stands for nullptr or an allocation not traced.
+struct AllocationTraceRecord
+{
+	std::uint64_t id; // Allocation returned, or left allocated by a failed reallocation
+	std::uint64_t ptrId; // Allocation passed to free, realloc or reallocarray
+	std::uint64_t size; // Requested size, element size for calloc and reallocarray
+	std::uint64_t nmemb; // Number of elements for calloc and reallocarray, 1 otherwise
+	std::uint32_t alignment; // Requested alignment for posix_memalign, aligned_alloc and memalign, 0 otherwise
+	std::uint32_t operationType; // OperationType
+};
+
+static_assert(sizeof(AllocationTraceHeader) == 16 && sizeof(AllocationTraceRecord) == 40, "unexpected allocation trace padding");
+
+} // namespace ArenaAllocator
+
+#endif // ArenaAllocator_AllocationTraceFormat_h_INCLUDED
@@ -0,0 +1,39 @@
+//
+// Copyright (C) 2021 Dr. Michael Steffens
+//
+// SPDX-License-Identifier:     BSL-1.0
+//
+
+
+#ifndef ArenaAllocator_BinaryTraceFormat_h_INCLUDED
+#define ArenaAllocator_BinaryTraceFormat_h_INCLUDED
+
+#include <cstdint>
+
+namespace ArenaAllocator {
+
+// Files written by the BinaryTrace logger are a sequence of blocks, each a BinaryTraceHeader followed by nRecords
+// BinaryTraceRecord entries of a single thread. Integers are in host byte order.
+struct BinaryTraceHeader
+{
+	static constexpr std::uint32_t magic{0x41524254}; // "TBRA" in little endian byte order
+
+	std::uint32_t blockMagic;
+	std::uint32_t nRecords;
+	std::uint32_t pid;
+	std::uint32_t tid;
+};
+
+struct BinaryTraceRecord
+{
+	std::uint64_t nanoseconds; // 0 if discarded due to context switch
+	std::uint64_t size; // Requested size, for free the size the chunk was allocated with
+	std::uint32_t operationType; // OperationType
+	std::uint32_t pool; // Position of the pool in arenaAllocatorGetCounters counting from 1, 0 if not known
+};
+
+static_assert(sizeof(BinaryTraceHeader) == 16 && sizeof(BinaryTraceRecord) == 24, "unexpected binary trace padding");
+
+} // namespace ArenaAllocator
+
+#endif // ArenaAllocator_BinaryTraceFormat_h_INCLUDED
@@ -13,8 +13,25 @@ namespace ArenaAllocator {
 class BuildConfiguration
 {
 public:
+	enum class TimerClock
+	{
+		STEADY_CLOCK, // std::chrono::steady_clock
+		TSC // Invariant time stamp counter where available, steady clock otherwise
+	};
+
+	enum class ContextSwitchDetection
+	{
+		NONE,
+		RUSAGE_THREAD, // Voluntary and involuntary context switches of the calling thread, two system calls per timing
+		CPU_MIGRATION // Thread migrated to a different CPU, without system calls, but missing switches back to the same CPU
+	};
+
 	constexpr static bool useMlock{true};
-	constexpr static bool discardTimingAcrossContextSwitch{true};
+	constexpr static TimerClock timerClock{TimerClock::TSC};
+	// Keeps system calls off timed operations. RUSAGE_THREAD detects all context switches, at the expense of tracing overhead.
+	constexpr static ContextSwitchDetection contextSwitchDetection{ContextSwitchDetection::CPU_MIGRATION};
+	constexpr static char const* binaryTraceDirectory{"/tmp"};
+	constexpr static char const* statisticsPageDirectory{"/dev/shm"};
 };
 
 } // namespace ArenaAllocator
@@ -8,11 +8,16 @@
 #ifndef ArenaAllocator_Configuration_h_INCLUDED
 #define ArenaAllocator_Configuration_h_INCLUDED
 
+#include "ArenaAllocator/Control.h"
 #include "ArenaAllocator/LogLevel.h"
 #include "ArenaAllocator/Logger.h"
 #include "ArenaAllocator/PassThroughCXXAllocator.h"
+#include "ArenaAllocator/Phase.h"
+#include "ArenaAllocator/Profile.h"
+#include "ArenaAllocator/Sampling.h"
 #include "ArenaAllocator/SizeRangeMap.h"
 #include <cstddef>
+#include <list>
 #include <map>
 #include <string_view>
 
@@ -23,12 +28,27 @@ class Configuration
 public:
 	using PoolMapType = SizeRangeMap<std::size_t>;
 
+	// Pools private to a named group of threads, see PoolGroups
+	struct PoolGroup
+	{
+		std::string_view name;
+		std::string_view threadPrefix; // Threads whose name starts with it join the group, empty for joining by API only
+		PoolMapType pools;
+	};
+
+	using PoolGroupsType = std::list<PoolGroup, PassThroughCXXAllocator<PoolGroup>>;
+
 	virtual ~Configuration() noexcept = default;
 
 	[[nodiscard]] virtual std::string_view const& getClass() const noexcept = 0;
 	[[nodiscard]] virtual PoolMapType const& getPools() const noexcept = 0;
 	[[nodiscard]] virtual LogLevel const& getLogLevel() const noexcept = 0;
 	[[nodiscard]] virtual std::string_view const& getLogger() const noexcept = 0;
+	[[nodiscard]] virtual Sampling const& getSampling() const noexcept = 0;
+	[[nodiscard]] virtual Control const& getControl() const noexcept = 0;
+	[[nodiscard]] virtual Profile const& getProfile() const noexcept = 0;
+	[[nodiscard]] virtual Phase const& getPhase() const noexcept = 0;
+	[[nodiscard]] virtual PoolGroupsType const& getGroups() const noexcept = 0;
 };
 
 } // namespace ArenaAllocator
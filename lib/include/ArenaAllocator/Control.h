@@ -0,0 +1,23 @@
+//
+// Copyright (C) 2021 Dr. Michael Steffens
+//
+// SPDX-License-Identifier:     BSL-1.0
+//
+
+
+#ifndef ArenaAllocator_Control_h_INCLUDED
+#define ArenaAllocator_Control_h_INCLUDED
+
+namespace ArenaAllocator {
+
+// Runtime introspection channels. Signal and socket are served by a control thread started after initialization.
+struct Control
+{
+	int signal; // Signal triggering a dump of allocator and loggers, 0 for none
+	bool socket; // Serve commands on abstract Unix domain socket ArenaAllocator-<pid>
+	bool page; // Publish pool counters in a shared memory StatisticsPage, see StatisticsPageFormat.h
+};
+
+} // namespace ArenaAllocator
+
+#endif // ArenaAllocator_Control_h_INCLUDED
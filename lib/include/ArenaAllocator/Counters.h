@@ -0,0 +1,54 @@
+//
+// Copyright (C) 2021 Dr. Michael Steffens
+//
+// SPDX-License-Identifier:     BSL-1.0
+//
+
+
+#ifndef ArenaAllocator_Counters_h_INCLUDED
+#define ArenaAllocator_Counters_h_INCLUDED
+
+#include "ArenaAllocator/OperationType.h"
+#include "ArenaAllocator/SizeRange.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace ArenaAllocator {
+
+// Snapshot of a SegregatedFreeLists pool. Operation counters are cumulative since start, to be turned into rates by
+// the caller.
+struct PoolCounters
+{
+	SizeRange range;
+	std::size_t nChunks;
+	std::size_t free;
+	std::size_t allocated;
+	std::size_t hwm;
+	std::uint64_t allocations;
+	std::uint64_t frees;
+	std::uint64_t failures; // Allocations failed due to pool exhaustion
+	std::uint64_t spills; // Allocations in the pool's size range passed to the delegate due to alignment
+	std::uint64_t inPlaceReallocs; // Reallocations to a size within the pool's range
+	std::uint64_t movingReallocs; // Reallocations moving a chunk of this pool to another pool
+	std::uint64_t bytesMoved; // Bytes copied by moving reallocations
+	std::uint64_t bytesZeroed; // Bytes cleared on deallocation, which calloc relies on
+	std::uint32_t group; // 0 for the top level pools, i for the pools of the i-th entry of configuration item groups
+};
+
+// Operations SegregatedFreeLists passed to its delegate, indexed by OperationType
+struct DelegateCounters
+{
+	std::array<std::uint64_t, static_cast<std::size_t>(OperationType::UNKNOWN)> operations;
+};
+
+} // namespace ArenaAllocator
+
+// Fills at most capacity pool snapshots of the preloaded allocator, and the delegate counters if not nullptr. Snapshots
+// are ordered by group, top level pools first, then by ascending size range. Returns the total number of pools, 0 if the
+// allocator class has none. Applications not linking the library may look it up by
+// dlsym(RTLD_DEFAULT, "arenaAllocatorGetCounters").
+extern "C" std::size_t arenaAllocatorGetCounters(
+	ArenaAllocator::PoolCounters* pools, std::size_t capacity, ArenaAllocator::DelegateCounters* delegate) noexcept;
+
+#endif // ArenaAllocator_Counters_h_INCLUDED
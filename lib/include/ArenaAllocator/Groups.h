@@ -0,0 +1,17 @@
+//
+// Copyright (C) 2021 Dr. Michael Steffens
+//
+// SPDX-License-Identifier:     BSL-1.0
+//
+
+
+#ifndef ArenaAllocator_Groups_h_INCLUDED
+#define ArenaAllocator_Groups_h_INCLUDED
+
+// The calling thread allocates from the pools of the named group of configuration item groups from now on, or from the
+// top level pools item by name "default", rather than by its thread name. Returns 0 on success, -1 if name is nullptr or
+// the preloaded allocator has no such group. Applications not linking the library may look it up by
+// dlsym(RTLD_DEFAULT, "arenaAllocatorJoinGroup").
+extern "C" int arenaAllocatorJoinGroup(char const* name) noexcept;
+
+#endif // ArenaAllocator_Groups_h_INCLUDED
@@ -12,6 +12,8 @@
 #include "ArenaAllocator/OperationType.h"
 #include <Static/BasicLogger.h>
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
 
 namespace ArenaAllocator {
 
@@ -34,6 +36,22 @@ public:
 		log(duration, operationType, FormattingCallback{callback});
 	}
 
+	template<typename F>
+	void operator()(std::chrono::nanoseconds duration, OperationType operationType, std::size_t size, F callback) const noexcept
+	{
+		log(duration, operationType, size, FormattingCallback{callback});
+	}
+
+	template<typename F>
+	void operator()(std::chrono::nanoseconds duration,
+					OperationType operationType,
+					std::size_t size,
+					std::uint32_t pool,
+					F callback) const noexcept
+	{
+		log(duration, operationType, size, pool, FormattingCallback{callback});
+	}
+
 	template<typename F>
 	void operator()(LogLevel level, F callback) const noexcept
 	{
@@ -46,6 +64,23 @@ public:
 protected:
 	virtual void log(std::chrono::nanoseconds duration, OperationType operationType, Formatter const& formatter) const noexcept = 0;
 	virtual void log(LogLevel level, Formatter const& formatter) const noexcept = 0;
+
+	// Loggers not interested in the requested size of an operation need not override this.
+	virtual void log(
+		std::chrono::nanoseconds duration, OperationType operationType, std::size_t, Formatter const& formatter) const noexcept
+	{
+		log(duration, operationType, formatter);
+	}
+
+	// Loggers not interested in the pool serving an operation need not override this.
+	virtual void log(std::chrono::nanoseconds duration,
+					 OperationType operationType,
+					 std::size_t size,
+					 std::uint32_t,
+					 Formatter const& formatter) const noexcept
+	{
+		log(duration, operationType, size, formatter);
+	}
 };
 
 } // namespace ArenaAllocator
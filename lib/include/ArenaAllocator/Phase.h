@@ -0,0 +1,27 @@
+//
+// Copyright (C) 2021 Dr. Michael Steffens
+//
+// SPDX-License-Identifier:     BSL-1.0
+//
+
+
+#ifndef ArenaAllocator_Phase_h_INCLUDED
+#define ArenaAllocator_Phase_h_INCLUDED
+
+namespace ArenaAllocator {
+
+// Triggers ending the startup phase of PhaseSwitch, in addition to arenaAllocatorSwitchPhase. Whichever fires first wins.
+struct Phase
+{
+	int signal; // Signal switching to the arena phase, 0 for none
+	unsigned seconds; // Switch on the first allocation this many seconds after start, 0 for none
+};
+
+} // namespace ArenaAllocator
+
+// Ends the startup phase of a preloaded PhaseSwitch allocator: Allocations are served from its delegate from now on,
+// rather than passed through. Returns 0 on success, -1 if the allocator has no startup phase or has already left it.
+// Applications not linking the library may look it up by dlsym(RTLD_DEFAULT, "arenaAllocatorSwitchPhase").
+extern "C" int arenaAllocatorSwitchPhase() noexcept;
+
+#endif // ArenaAllocator_Phase_h_INCLUDED
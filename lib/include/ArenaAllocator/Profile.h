@@ -0,0 +1,21 @@
+//
+// Copyright (C) 2021 Dr. Michael Steffens
+//
+// SPDX-License-Identifier:     BSL-1.0
+//
+
+
+#ifndef ArenaAllocator_Profile_h_INCLUDED
+#define ArenaAllocator_Profile_h_INCLUDED
+
+namespace ArenaAllocator {
+
+struct Profile
+{
+	bool sizes; // Histogram of live allocations by size, independent of the configured pools, see SizeHistogram
+	bool threads; // Pool usage by allocating thread, see ThreadProfile
+};
+
+} // namespace ArenaAllocator
+
+#endif // ArenaAllocator_Profile_h_INCLUDED
@@ -0,0 +1,30 @@
+//
+// Copyright (C) 2021 Dr. Michael Steffens
+//
+// SPDX-License-Identifier:     BSL-1.0
+//
+
+
+#ifndef ArenaAllocator_Sampling_h_INCLUDED
+#define ArenaAllocator_Sampling_h_INCLUDED
+
+#include <cstddef>
+
+namespace ArenaAllocator {
+
+struct Sampling
+{
+	enum class Mode
+	{
+		NONE, // Record every allocation
+		RATE, // Record one in period allocations on average
+		INTERVAL // Record one allocation per period bytes allocated on average
+	};
+
+	Mode mode;
+	std::size_t period;
+};
+
+} // namespace ArenaAllocator
+
+#endif // ArenaAllocator_Sampling_h_INCLUDED
@@ -0,0 +1,51 @@
+//
+// Copyright (C) 2021 Dr. Michael Steffens
+//
+// SPDX-License-Identifier:     BSL-1.0
+//
+
+
+#ifndef ArenaAllocator_StatisticsPageFormat_h_INCLUDED
+#define ArenaAllocator_StatisticsPageFormat_h_INCLUDED
+
+#include <atomic>
+#include <cstdint>
+
+namespace ArenaAllocator {
+
+// With configuration item control:{page:1}, SegregatedFreeLists maps file <statisticsPageDirectory>/ArenaAllocator-<pid>,
+// a StatisticsPageHeader followed by nPools StatisticsPagePool entries, ordered by group, top level pools first, then by
+// ascending size range. pageMagic is set last, once ranges and chunk counts are in place. Integers are in host byte order.
+struct alignas(64) StatisticsPageHeader
+{
+	static constexpr std::uint32_t magic{0x50535241}; // "ARSP" in little endian byte order
+
+	std::atomic<std::uint32_t> pageMagic;
+	std::uint32_t nPools;
+	std::uint32_t pid;
+	std::atomic<std::uint64_t> delegateCalls; // Operations passed to the delegate allocator
+};
+
+// Counters are updated by the thread holding the pool's mutex. Readers take a consistent snapshot by retrying while
+// sequence is odd or changed while reading the counters (seqlock).
+struct alignas(64) StatisticsPagePool
+{
+	std::uint64_t first;
+	std::uint64_t last;
+	std::uint64_t nChunks;
+	std::uint64_t group; // 0 for the top level pools, i for the pools of the i-th entry of configuration item groups
+	std::atomic<std::uint64_t> sequence;
+	std::atomic<std::uint64_t> free;
+	std::atomic<std::uint64_t> allocated;
+	std::atomic<std::uint64_t> hwm;
+	std::atomic<std::uint64_t> allocations; // Successful allocations since start
+	std::atomic<std::uint64_t> failures; // Allocations failed due to pool exhaustion
+	std::atomic<std::uint64_t> spills; // Allocations in the pool's size range passed to the delegate due to alignment
+};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "statistics page counters require lock-free atomics");
+static_assert(sizeof(StatisticsPageHeader) == 64 && sizeof(StatisticsPagePool) == 128, "unexpected statistics page padding");
+
+} // namespace ArenaAllocator
+
+#endif // ArenaAllocator_StatisticsPageFormat_h_INCLUDED
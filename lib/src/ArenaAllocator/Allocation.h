@@ -10,6 +10,7 @@
 
 #include "ArenaAllocator/PoolStatistics.h"
 #include <cstddef>
+#include <cstdint>
 
 namespace ArenaAllocator {
 
@@ -17,6 +18,14 @@ struct Allocation
 {
 	PoolStatistics* pool;
 	std::size_t size;
+	std::size_t weight; // Number of allocations represented, see Sampler
+	std::uint64_t timestamp; // Timer::now() of initial allocation, retained across reallocation
+	// Growth chain: pool of the initial allocation, reallocations so far, those moving to another pool and bytes they copied
+	PoolStatistics* origin;
+	std::uint32_t reallocs;
+	std::uint32_t moves;
+	std::size_t bytesCopied;
+	std::uint32_t thread; // Allocating thread, see ThreadProfile::getThread
 };
 
 } // namespace ArenaAllocator
@@ -6,90 +6,134 @@
 
 
 #include "ArenaAllocator/AllocationMap.h"
+#include "ArenaAllocator/Timer.h"
+#include <algorithm>
 
 namespace ArenaAllocator {
 
-AllocationMap::AllocationMap(PoolMap<PoolStatistics>& pools, PoolStatistics& delegatePool, Logger const& log) noexcept :
-	log{log}, pools{pools}, delegatePool{delegatePool}
+AllocationMap::AllocationMap(
+	PoolMap<PoolStatistics>& pools,
+	PoolStatistics& delegatePool,
+	Sampler const& sampler,
+	SizeHistogram& sizes,
+	ThreadProfile& threads,
+	Logger const& log) noexcept :
+	log{log}, pools{pools}, delegatePool{delegatePool}, sampler{sampler}, sizes{sizes}, threads{threads}
 {
 }
 
 void AllocationMap::registerAllocate(std::size_t size, void* result) noexcept
 {
 	log(LogLevel::DEBUG, [&] { return Message("AllocationMap::registerAllocate({}, {})", size, result); });
-	PoolStatistics* pool{pools.at(size)};
-	if (pool == nullptr) {
-		pool = &delegatePool;
+	const std::size_t weight{sampler(size)};
+	if (weight > 0) {
+		PoolStatistics* pool{pools.at(size)};
+		if (pool == nullptr) {
+			pool = &delegatePool;
+		}
+		insertAllocation(result, {pool, size, weight, Timer::now(), pool, 0, 0, 0, threads.getThread()});
 	}
-	insertAllocation(result, {pool, size});
 }
 
 void AllocationMap::registerAllocate(std::size_t size, void* result, std::size_t alignment) noexcept
 {
 	log(LogLevel::DEBUG, [&] { return Message("AllocationMap::registerAllocate({}, {})", size, result); });
-	PoolStatistics* pool{alignment <= sizeof(std::max_align_t) ? pools.at(size) : &delegatePool};
-	if (pool == nullptr) {
-		pool = &delegatePool;
+	const std::size_t weight{sampler(size)};
+	if (weight > 0) {
+		PoolStatistics* pool{alignment <= sizeof(std::max_align_t) ? pools.at(size) : &delegatePool};
+		if (pool == nullptr) {
+			pool = &delegatePool;
+		}
+		insertAllocation(result, {pool, size, weight, Timer::now(), pool, 0, 0, 0, threads.getThread()});
 	}
-	insertAllocation(result, {pool, size});
 }
 
-void AllocationMap::registerDeallocate(void* ptr) noexcept
+void AllocationMap::registerDeallocate(Shard& shard, void* ptr) noexcept
 {
 	log(LogLevel::DEBUG, [&] { return Message("AllocationMap::registerDeallocate({})", ptr); });
-	if (ptr != nullptr) {
-		AggregateType::iterator it{allocations.find(ptr)};
-		if (it != allocations.end()) {
-			eraseAllocation(it);
-		} else {
-			log(LogLevel::ERROR, [&] { return Message("AllocationMap::registerDeallocate({}) allocation not found", ptr); });
-			if (log.isLevel(LogLevel::DEBUG)) {
-				dump();
-			}
+	AggregateType::iterator it{shard.values.find(ptr)};
+	if (it != shard.values.end()) {
+		eraseAllocation(shard, it);
+	} else if (!sampler.isEnabled()) {
+		log(LogLevel::ERROR, [&] { return Message("AllocationMap::registerDeallocate({}) allocation not found", ptr); });
+		if (log.isLevel(LogLevel::DEBUG)) {
+			dump(&shard);
 		}
 	}
 }
 
-void AllocationMap::registerReallocate(void* ptr, std::size_t size, void* result) noexcept
+void AllocationMap::registerReallocate(
+	Shard& shard,
+	std::unique_lock<std::mutex>& guard,
+	void* ptr,
+	std::size_t size,
+	void* result) noexcept
 {
 	log(LogLevel::DEBUG, [&] { return Message("AllocationMap::registerReallocate({}, {}, {})", ptr, size, result); });
-	if (ptr != nullptr) {
-		AggregateType::iterator it{allocations.find(ptr)};
-		if (it != allocations.end()) {
-			if (size > 0) {
-				PoolStatistics* destinationPool{pools.at(size)};
-				if (destinationPool == nullptr) {
-					destinationPool = &delegatePool;
-					if (it->second.pool != &delegatePool) {
-						log(LogLevel::ERROR, [&] {
-							return Message(
-								"AllocationMap::registerReallocate({}, {}, {}) allocation moved out of arena pools",
-								ptr,
-								size,
-								result);
-						});
-					}
-				}
-				updateAllocation(it, result, {destinationPool, size});
-			} else {
-				eraseAllocation(it);
+	AggregateType::iterator it{shard.values.find(ptr)};
+	if (it != shard.values.end()) {
+		PoolStatistics* destinationPool{pools.at(size)};
+		if (destinationPool == nullptr) {
+			destinationPool = &delegatePool;
+			if (it->second.pool != &delegatePool) {
+				log(LogLevel::ERROR, [&] {
+					return Message(
+						"AllocationMap::registerReallocate({}, {}, {}) allocation moved out of arena pools", ptr, size, result);
+				});
 			}
+		}
+		// A reallocated allocation keeps representing the same number of allocations. Changing pools, SegregatedFreeLists
+		// would move it, copying the smaller of both sizes.
+		const bool move{destinationPool != it->second.pool};
+		const Allocation allocation{
+			destinationPool,
+			size,
+			it->second.weight,
+			it->second.timestamp,
+			it->second.origin,
+			it->second.reallocs + 1,
+			it->second.moves + (move ? 1 : 0),
+			it->second.bytesCopied + (move ? std::min(it->second.size, size) : 0),
+			it->second.thread};
+		if (result == ptr) {
+			log(LogLevel::DEBUG, [&] {
+				return Message(
+					"AllocationMap::updateAllocation({}, {[{}, {}], {}})",
+					ptr,
+					allocation.pool->getRange().first,
+					allocation.pool->getRange().last,
+					allocation.size);
+			});
+			removeUsage(it->second);
+			addUsage(allocation);
+			it->second = allocation;
 		} else {
-			log(LogLevel::ERROR,
-				[&] { return Message("AllocationMap::registerReallocate({}, {}, {}): allocation not found", ptr, size, result); });
+			// Moved, but the allocation lives on: No lifetime to register.
+			removeUsage(it->second);
+			shard.values.erase(it);
+			guard.unlock();
+			insertAllocation(result, allocation);
+		}
+	} else {
+		// Not sampled while sampling, otherwise unexpected. Either way give the sampler a chance to record it now.
+		if (!sampler.isEnabled()) {
+			log(LogLevel::ERROR, [&] {
+				return Message("AllocationMap::registerReallocate({}, {}, {}): allocation not found", ptr, size, result);
+			});
 			if (log.isLevel(LogLevel::DEBUG)) {
-				dump();
+				dump(&shard);
 			}
-			registerAllocate(size, result);
 		}
-	} else {
+		guard.unlock();
 		registerAllocate(size, result);
 	}
 }
 
 void AllocationMap::insertAllocation(void* ptr, Allocation const& allocation) noexcept
 {
-	if (allocations.emplace(ptr, allocation).second) {
+	Shard& shard{shards.getShard(ptr)};
+	std::lock_guard<std::mutex> guard{shard.mutex};
+	if (shard.values.emplace(ptr, allocation).second) {
 		log(LogLevel::DEBUG, [&] {
 			return Message(
 				"AllocationMap::insertAllocation({}, {[{}, {}], {}})",
@@ -98,7 +142,7 @@ void AllocationMap::insertAllocation(void* ptr, Allocation const& allocation) no
 				allocation.pool->getRange().last,
 				allocation.size);
 		});
-		allocation.pool->registerAllocate(allocation.size);
+		addUsage(allocation);
 	} else {
 		log(LogLevel::ERROR, [&] {
 			return Message(
@@ -111,7 +155,7 @@ void AllocationMap::insertAllocation(void* ptr, Allocation const& allocation) no
 	}
 }
 
-void AllocationMap::eraseAllocation(AggregateType::iterator it) noexcept
+void AllocationMap::eraseAllocation(Shard& shard, AggregateType::iterator it) noexcept
 {
 	log(LogLevel::DEBUG, [&] {
 		return Message(
@@ -121,42 +165,120 @@ void AllocationMap::eraseAllocation(AggregateType::iterator it) noexcept
 			it->second.pool->getRange().last,
 			it->second.size);
 	});
-	it->second.pool->registerDeallocate();
-	allocations.erase(it);
+	removeUsage(it->second);
+	it->second.pool->registerLifetime(it->second.weight, Timer::getElapsed(it->second.timestamp, Timer::now()));
+	if (it->second.reallocs > 0) {
+		registerGrowthChain(shard.growthChains, it->second);
+	}
+	shard.values.erase(it);
 }
 
-void AllocationMap::updateAllocation(AggregateType::iterator it, void* ptr, Allocation const& allocation) noexcept
+void AllocationMap::addUsage(Allocation const& allocation) noexcept
 {
-	if (it->first == ptr) {
-		log(LogLevel::DEBUG, [&] {
-			return Message(
-				"AllocationMap::updateAllocation({}, {[{}, {}], {}})",
-				ptr,
-				allocation.pool->getRange().first,
-				allocation.pool->getRange().last,
-				allocation.size);
-		});
-		it->second.pool->registerDeallocate();
-		allocation.pool->registerAllocate(allocation.size);
-		it->second = allocation;
-	} else {
-		eraseAllocation(it);
-		insertAllocation(ptr, allocation);
+	allocation.pool->registerAllocate(allocation.size, allocation.weight);
+	sizes.registerAllocate(allocation.size, allocation.weight);
+	threads.registerAllocate(allocation.thread, allocation.pool, allocation.size, allocation.weight);
+}
+
+void AllocationMap::removeUsage(Allocation const& allocation) noexcept
+{
+	allocation.pool->registerDeallocate(allocation.weight);
+	sizes.registerDeallocate(allocation.size, allocation.weight);
+	threads.registerDeallocate(allocation.thread, allocation.pool, allocation.size, allocation.weight);
+}
+
+void AllocationMap::registerGrowthChain(GrowthChainMap& chains, Allocation const& allocation) noexcept
+{
+	GrowthChain& chain{chains[std::make_pair(allocation.origin, allocation.pool)]};
+	chain.chains += allocation.weight;
+	chain.reallocs += allocation.reallocs * allocation.weight;
+	chain.moves += allocation.moves * allocation.weight;
+	chain.bytesCopied += allocation.bytesCopied * allocation.weight;
+	chain.finalBytes += allocation.size * allocation.weight;
+	chain.maxFinalSize = std::max(chain.maxFinalSize, allocation.size);
+}
+
+void AllocationMap::mergeGrowthChains(GrowthChainMap& chains, GrowthChainMap const& other) noexcept
+{
+	for (GrowthChainMap::value_type const& element : other) {
+		GrowthChain& chain{chains[element.first]};
+		chain.chains += element.second.chains;
+		chain.reallocs += element.second.reallocs;
+		chain.moves += element.second.moves;
+		chain.bytesCopied += element.second.bytesCopied;
+		chain.finalBytes += element.second.finalBytes;
+		chain.maxFinalSize = std::max(chain.maxFinalSize, element.second.maxFinalSize);
 	}
 }
 
 void AllocationMap::dump() const noexcept
 {
-	for (typename AggregateType::value_type const& allocation : allocations) {
+	dump(nullptr);
+}
+
+void AllocationMap::dumpGrowthChains() const noexcept
+{
+	// Chains ended by deallocation, plus those of reallocated allocations still live.
+	GrowthChainMap chains;
+	for (Shard const& shard : shards) {
+		std::lock_guard<std::mutex> guard{shard.mutex};
+		mergeGrowthChains(chains, shard.growthChains);
+		for (AggregateType::value_type const& allocation : shard.values) {
+			if (allocation.second.reallocs > 0) {
+				registerGrowthChain(chains, allocation.second);
+			}
+		}
+	}
+	std::vector<GrowthChainMap::const_pointer, PassThroughCXXAllocator<GrowthChainMap::const_pointer>> hottest;
+	hottest.reserve(chains.size());
+	for (GrowthChainMap::value_type const& chain : chains) {
+		hottest.push_back(&chain);
+	}
+	// Hottest by bytes copied, then by number of reallocations
+	std::sort(hottest.begin(), hottest.end(), [](GrowthChainMap::const_pointer lhs, GrowthChainMap::const_pointer rhs) {
+		return std::make_pair(lhs->second.bytesCopied, lhs->second.reallocs) >
+			std::make_pair(rhs->second.bytesCopied, rhs->second.reallocs);
+	});
+	hottest.resize(std::min(hottest.size(), nGrowthChainPatterns));
+	for (GrowthChainMap::const_pointer chain : hottest) {
+		SizeRange const& origin{chain->first.first->getRange()};
+		SizeRange const& final{chain->first.second->getRange()};
 		log([&] {
 			return Message(
-				"{}: {pool: [{}, {}], size: {}}",
-				allocation.first,
-				allocation.second.pool->getRange().first,
-				allocation.second.pool->getRange().last,
-				allocation.second.size);
+				"GrowthChains [{}, {}] -> [{}, {}]: {chains: {}, reallocs: {}, moves: {}, bytesCopied: {}, meanFinalSize: {}, "
+				"maxFinalSize: {}}",
+				origin.first,
+				origin.last,
+				final.first,
+				final.last,
+				chain->second.chains,
+				chain->second.reallocs,
+				chain->second.moves,
+				chain->second.bytesCopied,
+				chain->second.finalBytes / chain->second.chains,
+				chain->second.maxFinalSize);
 		});
 	}
 }
 
+void AllocationMap::dump(Shard const* lockedShard) const noexcept
+{
+	for (Shard const& shard : shards) {
+		std::unique_lock<std::mutex> guard{shard.mutex, std::defer_lock};
+		if (&shard != lockedShard) {
+			guard.lock();
+		}
+		for (typename AggregateType::value_type const& allocation : shard.values) {
+			log([&] {
+				return Message(
+					"{}: {pool: [{}, {}], size: {}}",
+					allocation.first,
+					allocation.second.pool->getRange().first,
+					allocation.second.pool->getRange().last,
+					allocation.second.size);
+			});
+		}
+	}
+}
+
 } // namespace ArenaAllocator
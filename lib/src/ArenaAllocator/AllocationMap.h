@@ -13,40 +13,113 @@
 #include "ArenaAllocator/PassThroughCXXAllocator.h"
 #include "ArenaAllocator/PoolMap.h"
 #include "ArenaAllocator/PoolStatistics.h"
+#include "ArenaAllocator/Sampler.h"
+#include "ArenaAllocator/ShardedAddressMap.h"
+#include "ArenaAllocator/SizeHistogram.h"
+#include "ArenaAllocator/ThreadProfile.h"
+#include <cstddef>
+#include <map>
 #include <mutex>
 #include <optional>
-#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace ArenaAllocator {
 
 class AllocationMap
 {
 public:
-	AllocationMap(PoolMap<PoolStatistics>& pools, PoolStatistics& delegatePool, Logger const& log) noexcept;
+	AllocationMap(
+		PoolMap<PoolStatistics>& pools,
+		PoolStatistics& delegatePool,
+		Sampler const& sampler,
+		SizeHistogram& sizes,
+		ThreadProfile& threads,
+		Logger const& log) noexcept;
 
+	// Allocations not selected by the sampler are not registered.
 	void registerAllocate(std::size_t size, void* result) noexcept;
 	void registerAllocate(std::size_t size, void* result, std::size_t alignment) noexcept;
-	void registerDeallocate(void* ptr) noexcept;
-	void registerReallocate(void* ptr, std::size_t size, void* result) noexcept;
-	void registerReallocate(void* ptr, std::size_t nmemb, std::size_t size, void* result) noexcept;
+
+	// The delegate is invoked under the lock of the shard containing ptr, see ShardedAddressMap.
+	template<typename DelegateF>
+	void deallocate(void* ptr, DelegateF delegateF) noexcept
+	{
+		shards.deallocate(ptr, delegateF, [&](Shard& shard) { registerDeallocate(shard, ptr); });
+	}
+
+	template<typename DelegateF>
+	void* reallocate(void* ptr, std::size_t size, DelegateF delegateF) noexcept
+	{
+		void* result{shards.reallocate(ptr, delegateF, [&](Shard& shard, std::unique_lock<std::mutex>& guard, void* newPtr) {
+			if (size == 0) {
+				registerDeallocate(shard, ptr);
+			} else if (newPtr != nullptr) {
+				registerReallocate(shard, guard, ptr, size, newPtr);
+			}
+		})};
+		if (ptr == nullptr && size > 0 && result != nullptr) {
+			registerAllocate(size, result);
+		}
+		return result;
+	}
+
 	void dump() const noexcept;
+	// Realloc growth chains by pool of initial and current allocation, the patterns copying the most bytes first.
+	void dumpGrowthChains() const noexcept;
+
+	static constexpr std::size_t nGrowthChainPatterns{16};
 
 private:
-	using AggregateType = std::unordered_map<
-		void*,
-		Allocation,
-		std::hash<void*>,
-		std::equal_to<void*>,
-		PassThroughCXXAllocator<std::pair<void* const, Allocation>>>;
+	struct GrowthChain
+	{
+		std::size_t chains;
+		std::size_t reallocs;
+		std::size_t moves;
+		std::size_t bytesCopied;
+		std::size_t finalBytes;
+		std::size_t maxFinalSize;
+	};
+
+	using GrowthChainMap = std::map<
+		std::pair<PoolStatistics const*, PoolStatistics const*>,
+		GrowthChain,
+		std::less<std::pair<PoolStatistics const*, PoolStatistics const*>>,
+		PassThroughCXXAllocator<std::pair<std::pair<PoolStatistics const*, PoolStatistics const*> const, GrowthChain>>>;
+
+	// Growth chains ended by deallocation are kept by the shard of the allocation, under the lock held anyway.
+	struct ShardData
+	{
+		GrowthChainMap growthChains;
+	};
+
+	using ShardedMapType = ShardedAddressMap<Allocation, ShardData>;
+	using AggregateType = ShardedMapType::MapType;
+	using Shard = ShardedMapType::Shard;
 
+	void registerDeallocate(Shard& shard, void* ptr) noexcept;
+	void registerReallocate(
+		Shard& shard,
+		std::unique_lock<std::mutex>& guard,
+		void* ptr,
+		std::size_t size,
+		void* result) noexcept;
 	void insertAllocation(void* ptr, Allocation const& allocation) noexcept;
-	void eraseAllocation(AggregateType::iterator it) noexcept;
-	void updateAllocation(AggregateType::iterator it, void* ptr, Allocation const& allocation) noexcept;
+	// Pool, size histogram and thread profile accounting of a live allocation
+	void addUsage(Allocation const& allocation) noexcept;
+	void removeUsage(Allocation const& allocation) noexcept;
+	static void registerGrowthChain(GrowthChainMap& chains, Allocation const& allocation) noexcept;
+	static void mergeGrowthChains(GrowthChainMap& chains, GrowthChainMap const& other) noexcept;
+	void eraseAllocation(Shard& shard, AggregateType::iterator it) noexcept;
+	void dump(Shard const* lockedShard) const noexcept;
 
 	Logger const& log;
 	PoolMap<PoolStatistics>& pools;
 	PoolStatistics& delegatePool;
-	AggregateType allocations;
+	Sampler const& sampler;
+	SizeHistogram& sizes;
+	ThreadProfile& threads;
+	ShardedMapType shards;
 };
 
 } // namespace ArenaAllocator
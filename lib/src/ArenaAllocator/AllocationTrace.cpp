@@ -0,0 +1,170 @@
+//
+// Copyright (C) 2021 Dr. Michael Steffens
+//
+// SPDX-License-Identifier:     BSL-1.0
+//
+
+
+#include "ArenaAllocator/AllocationTrace.h"
+#include <unistd.h>
+
+namespace ArenaAllocator {
+
+AllocationTrace::AllocationTrace(Allocator& delegate, Logger const& log) noexcept :
+	delegate{delegate}, log{log}, nextId{1}, writer{"allocations"}
+{
+	log(LogLevel::DEBUG, [&] { return Message("{}::{}(Allocator&, Logger const&) -> this:{}", className, className, this); });
+}
+
+AllocationTrace::~AllocationTrace() noexcept
+{
+	log(LogLevel::DEBUG, [&] { return Message("{}::~{}(this:{})", className, className, this); });
+}
+
+void* AllocationTrace::malloc(std::size_t size) noexcept
+{
+	void* result{delegate.malloc(size)};
+	writer.append(AllocationTraceRecord{
+		registerAllocation(result), 0, size, 1, 0, static_cast<std::uint32_t>(OperationType::MALLOC)});
+	return result;
+}
+
+void AllocationTrace::free(void* ptr) noexcept
+{
+	std::uint64_t ptrId{0};
+	shards.deallocate(
+		ptr,
+		[&] { delegate.free(ptr); },
+		[&](Shard& shard) {
+			IdMapType::iterator it{shard.values.find(ptr)};
+			if (it != shard.values.end()) {
+				ptrId = it->second;
+				shard.values.erase(it);
+			}
+		});
+	writer.append(AllocationTraceRecord{0, ptrId, 0, 1, 0, static_cast<std::uint32_t>(OperationType::FREE)});
+}
+
+void* AllocationTrace::calloc(std::size_t nmemb, std::size_t size) noexcept
+{
+	void* result{delegate.calloc(nmemb, size)};
+	writer.append(AllocationTraceRecord{
+		registerAllocation(result), 0, size, nmemb, 0, static_cast<std::uint32_t>(OperationType::CALLOC)});
+	return result;
+}
+
+void* AllocationTrace::realloc(void* ptr, std::size_t size) noexcept
+{
+	return reallocate(ptr, 1, size, OperationType::REALLOC, [&] { return delegate.realloc(ptr, size); });
+}
+
+void* AllocationTrace::reallocarray(void* ptr, std::size_t nmemb, std::size_t size) noexcept
+{
+	return reallocate(
+		ptr, nmemb, size, OperationType::REALLOCARRAY, [&] { return delegate.reallocarray(ptr, nmemb, size); });
+}
+
+int AllocationTrace::posix_memalign(void** memptr, std::size_t alignment, std::size_t size) noexcept
+{
+	int result{delegate.posix_memalign(memptr, alignment, size)};
+	writer.append(AllocationTraceRecord{
+		result == 0 ? registerAllocation(*memptr) : 0,
+		0,
+		size,
+		1,
+		static_cast<std::uint32_t>(alignment),
+		static_cast<std::uint32_t>(OperationType::POSIX_MEMALIGN)});
+	return result;
+}
+
+void* AllocationTrace::aligned_alloc(std::size_t alignment, std::size_t size) noexcept
+{
+	void* result{delegate.aligned_alloc(alignment, size)};
+	writer.append(AllocationTraceRecord{
+		registerAllocation(result),
+		0,
+		size,
+		1,
+		static_cast<std::uint32_t>(alignment),
+		static_cast<std::uint32_t>(OperationType::ALIGNED_ALLOC)});
+	return result;
+}
+
+void* AllocationTrace::valloc(std::size_t size) noexcept
+{
+	void* result{delegate.valloc(size)};
+	writer.append(AllocationTraceRecord{
+		registerAllocation(result), 0, size, 1, 0, static_cast<std::uint32_t>(OperationType::VALLOC)});
+	return result;
+}
+
+void* AllocationTrace::memalign(std::size_t alignment, std::size_t size) noexcept
+{
+	void* result{delegate.memalign(alignment, size)};
+	writer.append(AllocationTraceRecord{
+		registerAllocation(result),
+		0,
+		size,
+		1,
+		static_cast<std::uint32_t>(alignment),
+		static_cast<std::uint32_t>(OperationType::MEMALIGN)});
+	return result;
+}
+
+void* AllocationTrace::pvalloc(std::size_t size) noexcept
+{
+	void* result{delegate.pvalloc(size)};
+	writer.append(AllocationTraceRecord{
+		registerAllocation(result), 0, size, 1, 0, static_cast<std::uint32_t>(OperationType::PVALLOC)});
+	return result;
+}
+
+std::size_t AllocationTrace::getCounters(
+	PoolCounters* poolCounters, std::size_t capacity, DelegateCounters* delegateCounters) const noexcept
+{
+	return delegate.getCounters(poolCounters, capacity, delegateCounters);
+}
+
+bool AllocationTrace::joinGroup(std::string_view name) noexcept
+{
+	return delegate.joinGroup(name);
+}
+
+bool AllocationTrace::switchPhase() noexcept
+{
+	return delegate.switchPhase();
+}
+
+void AllocationTrace::dump(bool force) const noexcept
+{
+	writer.flush();
+	if (force || log.isLevel(LogLevel::INFO)) {
+		log([&] {
+			return Message(
+				"{}: {allocations:{}, file:{}/ArenaAllocator-{}.allocations}",
+				className,
+				nextId.load(std::memory_order_relaxed) - 1,
+				BuildConfiguration::binaryTraceDirectory,
+				::getpid());
+		});
+	}
+	delegate.dump(force);
+}
+
+std::uint64_t AllocationTrace::registerAllocation(void* ptr) noexcept
+{
+	std::uint64_t result{0};
+	if (ptr != nullptr) {
+		Shard& shard{shards.getShard(ptr)};
+		std::lock_guard<std::mutex> guard{shard.mutex};
+		// An address still registered is shared by empty allocations, e.g. SegregatedFreeLists' ptrToEmpty, and gets no
+		// further id. Otherwise a thread freeing it might consume an id produced after its free in replay order.
+		auto [it, inserted]{shard.values.try_emplace(ptr, 0)};
+		if (inserted) {
+			result = it->second = nextId.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+	return result;
+}
+
+} // namespace ArenaAllocator
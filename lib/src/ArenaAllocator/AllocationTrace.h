@@ -0,0 +1,95 @@
+//
+// Copyright (C) 2021 Dr. Michael Steffens
+//
+// SPDX-License-Identifier:     BSL-1.0
+//
+
+
+#ifndef ArenaAllocator_AllocationTrace_h_INCLUDED
+#define ArenaAllocator_AllocationTrace_h_INCLUDED
+
+#include "ArenaAllocator/AllocationTraceFormat.h"
+#include "ArenaAllocator/Allocator.h"
+#include "ArenaAllocator/Logger.h"
+#include "ArenaAllocator/OperationType.h"
+#include "ArenaAllocator/ShardedAddressMap.h"
+#include "ArenaAllocator/TraceWriter.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string_view>
+
+namespace ArenaAllocator {
+
+// Records every operation forwarded to its delegate to <binaryTraceDirectory>/ArenaAllocator-<pid>.allocations, with
+// pointers replaced by symbolic allocation ids, for deterministic replay by utils/replayAllocationTrace.
+class AllocationTrace : public Allocator
+{
+public:
+	AllocationTrace(Allocator& delegate, Logger const& log) noexcept;
+	AllocationTrace(AllocationTrace const&) = delete;
+	void operator=(AllocationTrace const&) = delete;
+	~AllocationTrace() noexcept override;
+
+	void* malloc(std::size_t size) noexcept override;
+	void free(void* ptr) noexcept override;
+	void* calloc(std::size_t nmemb, std::size_t size) noexcept override;
+	void* realloc(void* ptr, std::size_t size) noexcept override;
+	void* reallocarray(void* ptr, std::size_t nmemb, std::size_t size) noexcept override;
+	int posix_memalign(void** memptr, std::size_t alignment, std::size_t size) noexcept override;
+	void* aligned_alloc(std::size_t alignment, std::size_t size) noexcept override;
+	void* valloc(std::size_t size) noexcept override;
+	void* memalign(std::size_t alignment, std::size_t size) noexcept override;
+	void* pvalloc(std::size_t size) noexcept override;
+	void dump(bool force) const noexcept override;
+	std::size_t getCounters(
+		PoolCounters* poolCounters, std::size_t capacity, DelegateCounters* delegateCounters) const noexcept override;
+	bool joinGroup(std::string_view name) noexcept override;
+	bool switchPhase() noexcept override;
+
+	static constexpr char const* className{"AllocationTrace"};
+
+private:
+	using ShardedMapType = ShardedAddressMap<std::uint64_t>;
+	using IdMapType = ShardedMapType::MapType;
+	using Shard = ShardedMapType::Shard;
+
+	// The delegate is invoked under the lock of the shard containing ptr, see ShardedAddressMap, so another thread
+	// receiving the same address from the delegate cannot register it before its previous id got erased.
+	template<typename DelegateF>
+	void* reallocate(void* ptr, std::size_t nmemb, std::size_t size, OperationType operationType, DelegateF delegateF) noexcept
+	{
+		std::uint64_t id{0};
+		std::uint64_t ptrId{0};
+		void* result{shards.reallocate(ptr, delegateF, [&](Shard& shard, std::unique_lock<std::mutex>&, void* newPtr) {
+			IdMapType::iterator it{shard.values.find(ptr)};
+			if (it != shard.values.end()) {
+				ptrId = it->second;
+				if (newPtr == nullptr && nmemb > 0 && size > 0) {
+					// Failed, but ptr lives on. A new id keeps every id consumed exactly once.
+					id = it->second = nextId.fetch_add(1, std::memory_order_relaxed);
+				} else {
+					shard.values.erase(it);
+				}
+			}
+		})};
+		if (result != nullptr) {
+			id = registerAllocation(result);
+		}
+		writer.append(AllocationTraceRecord{id, ptrId, size, nmemb, 0, static_cast<std::uint32_t>(operationType)});
+		return result;
+	}
+
+	std::uint64_t registerAllocation(void* ptr) noexcept;
+
+	Allocator& delegate;
+	Logger const& log;
+	std::atomic<std::uint64_t> nextId;
+	ShardedMapType shards;
+	TraceWriter<AllocationTraceHeader, AllocationTraceRecord> writer;
+};
+
+} // namespace ArenaAllocator
+
+#endif // ArenaAllocator_AllocationTrace_h_INCLUDED
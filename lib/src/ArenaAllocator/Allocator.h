@@ -8,8 +8,10 @@
 #ifndef ArenaAllocator_Allocator_h_INCLUDED
 #define ArenaAllocator_Allocator_h_INCLUDED
 
+#include "ArenaAllocator/Counters.h"
 #include <cstddef>
 #include <map>
+#include <string_view>
 
 namespace ArenaAllocator {
 
@@ -28,7 +30,26 @@ public:
 	virtual void* valloc(std::size_t size) noexcept = 0;
 	virtual void* memalign(std::size_t alignment, std::size_t size) noexcept = 0;
 	virtual void* pvalloc(std::size_t size) noexcept = 0;
-	virtual void dump() const noexcept = 0;
+	// Logs statistics if the log level is INFO or above, regardless of it if forced.
+	virtual void dump(bool force) const noexcept = 0;
+
+	// See arenaAllocatorGetCounters. Allocators without pools of their own forward to their delegate, if any.
+	virtual std::size_t getCounters(PoolCounters*, std::size_t, DelegateCounters*) const noexcept
+	{
+		return 0;
+	}
+
+	// See arenaAllocatorJoinGroup, forwarded likewise.
+	virtual bool joinGroup(std::string_view) noexcept
+	{
+		return false;
+	}
+
+	// See arenaAllocatorSwitchPhase, forwarded likewise.
+	virtual bool switchPhase() noexcept
+	{
+		return false;
+	}
 };
 
 } // namespace ArenaAllocator
@@ -0,0 +1,34 @@
+//
+// Copyright (C) 2021 Dr. Michael Steffens
+//
+// SPDX-License-Identifier:     BSL-1.0
+//
+
+
+#ifndef ArenaAllocator_AtomicExtreme_h_INCLUDED
+#define ArenaAllocator_AtomicExtreme_h_INCLUDED
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+
+namespace ArenaAllocator {
+
+// Atomic min/max, returning the previous value. Loads first, so unchanged extremes cost no read-modify-write.
+template<typename Compare>
+std::size_t updateExtreme(std::atomic<std::size_t>& extreme, std::size_t value, Compare compare) noexcept
+{
+	std::size_t previous{extreme.load(std::memory_order_relaxed)};
+	while (compare(value, previous) && !extreme.compare_exchange_weak(previous, value, std::memory_order_relaxed)) {
+	}
+	return previous;
+}
+
+inline std::size_t updateMaximum(std::atomic<std::size_t>& maximum, std::size_t value) noexcept
+{
+	return updateExtreme(maximum, value, std::greater<>{});
+}
+
+} // namespace ArenaAllocator
+
+#endif // ArenaAllocator_AtomicExtreme_h_INCLUDED
@@ -0,0 +1,88 @@
+//
+// Copyright (C) 2021 Dr. Michael Steffens
+//
+// SPDX-License-Identifier:     BSL-1.0
+//
+
+
+#include "ArenaAllocator/BinaryTrace.h"
+#include <unistd.h>
+
+namespace ArenaAllocator {
+
+namespace {
+
+void writeToBuffer(Static::FormatResult message) noexcept
+{
+	Message out("[pid:{}]\t\t{}", ::getpid(), message);
+	Static::BasicLogger::writeLine(out.getResult());
+}
+
+} // namespace
+
+BinaryTrace::BinaryTrace() noexcept : logLevel{LogLevel::NONE}, writer{"trace"}
+{
+	BinaryTrace::log(LogLevel::DEBUG, FormattingCallback{[&] { return Message("BinaryTrace::BinaryTrace() -> this:{}", this); }});
+}
+
+BinaryTrace::~BinaryTrace() noexcept
+{
+	BinaryTrace::log(LogLevel::DEBUG, FormattingCallback{[&] { return Message("BinaryTrace::~BinaryTrace(this:{})", this); }});
+}
+
+bool BinaryTrace::isLevel(LogLevel level) const noexcept
+{
+	return logLevel.load(std::memory_order_relaxed) >= level;
+}
+
+void BinaryTrace::setLevel(LogLevel level) noexcept
+{
+	logLevel.store(level, std::memory_order_relaxed);
+}
+
+void BinaryTrace::start() noexcept
+{
+	writer.start();
+}
+
+void BinaryTrace::flush() const noexcept
+{
+	writer.flush();
+}
+
+void BinaryTrace::log(Formatter const& formatter) const noexcept
+{
+	Message message = formatter();
+	writeToBuffer(message.getResult());
+}
+
+void BinaryTrace::log(std::chrono::nanoseconds duration, OperationType operationType, Formatter const& formatter) const noexcept
+{
+	log(duration, operationType, 0, formatter);
+}
+
+void BinaryTrace::log(LogLevel level, Formatter const& formatter) const noexcept
+{
+	if (isLevel(level)) {
+		Message message = formatter();
+		writeToBuffer(message.getResult());
+	}
+}
+
+void BinaryTrace::log(
+	std::chrono::nanoseconds duration, OperationType operationType, std::size_t size, Formatter const& formatter) const noexcept
+{
+	log(duration, operationType, size, 0, formatter);
+}
+
+void BinaryTrace::log(std::chrono::nanoseconds duration,
+					  OperationType operationType,
+					  std::size_t size,
+					  std::uint32_t pool,
+					  Formatter const&) const noexcept
+{
+	writer.append(BinaryTraceRecord{
+		static_cast<std::uint64_t>(duration.count()), size, static_cast<std::uint32_t>(operationType), pool});
+}
+
+} // namespace ArenaAllocator
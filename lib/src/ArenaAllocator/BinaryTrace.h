@@ -0,0 +1,61 @@
+//
+// Copyright (C) 2021 Dr. Michael Steffens
+//
+// SPDX-License-Identifier:     BSL-1.0
+//
+
+
+#ifndef ArenaAllocator_BinaryTrace_h_INCLUDED
+#define ArenaAllocator_BinaryTrace_h_INCLUDED
+
+#include "ArenaAllocator/BinaryTraceFormat.h"
+#include "ArenaAllocator/Logger.h"
+#include "ArenaAllocator/TraceWriter.h"
+#include <atomic>
+
+namespace ArenaAllocator {
+
+// Appends timed operations as binary records to per thread buffers, written to a trace file by a background thread
+// when full, and on thread exit and on flush. Other log messages are written to the console.
+class BinaryTrace : public Logger
+{
+public:
+	BinaryTrace() noexcept;
+	BinaryTrace(BinaryTrace const&) = delete;
+	BinaryTrace& operator=(BinaryTrace const&) = delete;
+	~BinaryTrace() noexcept override;
+
+	[[nodiscard]] bool isLevel(LogLevel level) const noexcept override;
+	void setLevel(LogLevel level) noexcept override;
+
+	// Starts writing full buffers in the background.
+	void start() noexcept;
+
+	// Writes the buffers of all threads not appending concurrently.
+	void flush() const noexcept;
+
+	static constexpr char const* className{"BinaryTrace"};
+	static constexpr std::size_t bufferRecords{1024};
+
+protected:
+	void log(Formatter const& formatter) const noexcept override;
+	void log(std::chrono::nanoseconds duration, OperationType operationType, Formatter const& formatter) const noexcept override;
+	void log(LogLevel level, Formatter const& formatter) const noexcept override;
+	void log(std::chrono::nanoseconds duration,
+			 OperationType operationType,
+			 std::size_t size,
+			 Formatter const& formatter) const noexcept override;
+	void log(std::chrono::nanoseconds duration,
+			 OperationType operationType,
+			 std::size_t size,
+			 std::uint32_t pool,
+			 Formatter const& formatter) const noexcept override;
+
+private:
+	std::atomic<LogLevel> logLevel; // Set by the control thread
+	TraceWriter<BinaryTraceHeader, BinaryTraceRecord, bufferRecords> writer;
+};
+
+} // namespace ArenaAllocator
+
+#endif // ArenaAllocator_BinaryTrace_h_INCLUDED
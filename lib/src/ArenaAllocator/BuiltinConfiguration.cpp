@@ -0,0 +1,76 @@
+//
+// Copyright (C) 2021 Dr. Michael Steffens
+//
+// SPDX-License-Identifier:     BSL-1.0
+//
+
+
+#include "ArenaAllocator/BuiltinConfiguration.h"
+
+namespace ArenaAllocator {
+
+namespace {
+
+constexpr bool hasDisjunctAscendingPools() noexcept
+{
+	bool result{true};
+	for (std::size_t i = 0; i < BuiltinConfigurationTables::pools.size(); ++i) {
+		SizeRange const& range{BuiltinConfigurationTables::pools[i].range};
+		if (range.first > range.last || (i > 0 && BuiltinConfigurationTables::pools[i - 1].range.last >= range.first)) {
+			result = false;
+		}
+	}
+	return result;
+}
+
+static_assert(hasDisjunctAscendingPools(), "builtin configuration expects disjunct pool size ranges in ascending order");
+static_assert(
+	!BuiltinConfigurationTables::sampling.has_value() || BuiltinConfigurationTables::sampling->mode == Sampling::Mode::NONE ||
+		BuiltinConfigurationTables::sampling->period > 0,
+	"builtin configuration expects a positive sampling period");
+
+} // namespace
+
+BuiltinConfiguration::BuiltinConfiguration(std::optional<Configuration::PoolMapType>& pools) noexcept : pools{pools}
+{
+}
+
+void BuiltinConfiguration::operator()(
+	std::optional<std::string_view>& className,
+	std::optional<LogLevel>& logLevel,
+	std::optional<std::string_view>& loggerName,
+	std::optional<Sampling>& sampling,
+	std::optional<Control>& control,
+	std::optional<Profile>& profile,
+	std::optional<Phase>& phase) noexcept
+{
+	if (!pools.has_value() && !BuiltinConfigurationTables::pools.empty()) {
+		pools.emplace();
+		for (BuiltinConfigurationTables::Pool const& pool : BuiltinConfigurationTables::pools) {
+			pools.value().emplace(pool.range, pool.nChunks);
+		}
+	}
+	if (!className.has_value()) {
+		className = BuiltinConfigurationTables::className;
+	}
+	if (!logLevel.has_value()) {
+		logLevel = BuiltinConfigurationTables::logLevel;
+	}
+	if (!loggerName.has_value()) {
+		loggerName = BuiltinConfigurationTables::loggerName;
+	}
+	if (!sampling.has_value()) {
+		sampling = BuiltinConfigurationTables::sampling;
+	}
+	if (!control.has_value()) {
+		control = BuiltinConfigurationTables::control;
+	}
+	if (!profile.has_value()) {
+		profile = BuiltinConfigurationTables::profile;
+	}
+	if (!phase.has_value()) {
+		phase = BuiltinConfigurationTables::phase;
+	}
+}
+
+} // namespace ArenaAllocator
@@ -0,0 +1,96 @@
+//
+// Copyright (C) 2021 Dr. Michael Steffens
+//
+// SPDX-License-Identifier:     BSL-1.0
+//
+
+
+#ifndef ArenaAllocator_BuiltinConfiguration_h_INCLUDED
+#define ArenaAllocator_BuiltinConfiguration_h_INCLUDED
+
+#include "ArenaAllocator/BuiltinConfigurationTables.h"
+#include "ArenaAllocator/Configuration.h"
+#include "ArenaAllocator/Control.h"
+#include "ArenaAllocator/LogLevel.h"
+#include "ArenaAllocator/Phase.h"
+#include "ArenaAllocator/Profile.h"
+#include "ArenaAllocator/Sampling.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+namespace ArenaAllocator {
+
+// Size lookup in the builtin pools, resolved at compile time for constant sizes. Sizes up to smallSizeLimit map to their
+// pool by table, larger ones by binary search over the disjunct, ascending ranges.
+namespace BuiltinPools {
+
+constexpr std::size_t size{BuiltinConfigurationTables::pools.size()};
+constexpr std::size_t smallSizeLimit{1024};
+
+static_assert(size < UINT16_MAX, "builtin configuration exceeds the pool index range");
+
+// Index of the pool serving size, or BuiltinPools::size if none does.
+constexpr std::size_t search(std::size_t chunkSize) noexcept
+{
+	std::size_t first{0};
+	std::size_t last{size};
+	while (first < last) {
+		const std::size_t middle{first + (last - first) / 2};
+		if (BuiltinConfigurationTables::pools[middle].range.last < chunkSize) {
+			first = middle + 1;
+		} else {
+			last = middle;
+		}
+	}
+	return first < size && BuiltinConfigurationTables::pools[first].range.first <= chunkSize ? first : size;
+}
+
+constexpr std::array<std::uint16_t, smallSizeLimit + 1> makeSmallSizeIndex() noexcept
+{
+	std::array<std::uint16_t, smallSizeLimit + 1> result{};
+	for (std::size_t chunkSize = 0; chunkSize <= smallSizeLimit; ++chunkSize) {
+		result[chunkSize] = static_cast<std::uint16_t>(search(chunkSize));
+	}
+	return result;
+}
+
+inline constexpr std::array<std::uint16_t, smallSizeLimit + 1> smallSizeIndex{makeSmallSizeIndex()};
+
+constexpr std::size_t getIndex(std::size_t chunkSize) noexcept
+{
+	return chunkSize <= smallSizeLimit ? smallSizeIndex[chunkSize] : search(chunkSize);
+}
+
+} // namespace BuiltinPools
+
+// Fills configuration items missing from the environment variable from the tables compiled in via the
+// ARENA_ALLOCATOR_BUILTIN_CONFIGURATION build option. Counterpart of ParseConfiguration, without any parsing.
+class BuiltinConfiguration
+{
+public:
+	explicit BuiltinConfiguration(std::optional<Configuration::PoolMapType>& pools) noexcept;
+	BuiltinConfiguration(BuiltinConfiguration const&) = delete;
+	BuiltinConfiguration& operator=(BuiltinConfiguration const&) = delete;
+	~BuiltinConfiguration() noexcept = default;
+
+	void operator()(
+		std::optional<std::string_view>& className,
+		std::optional<LogLevel>& logLevel,
+		std::optional<std::string_view>& loggerName,
+		std::optional<Sampling>& sampling,
+		std::optional<Control>& control,
+		std::optional<Profile>& profile,
+		std::optional<Phase>& phase) noexcept;
+
+	static constexpr bool available{BuiltinConfigurationTables::available};
+
+private:
+	std::optional<Configuration::PoolMapType>& pools;
+};
+
+} // namespace ArenaAllocator
+
+#endif // ArenaAllocator_BuiltinConfiguration_h_INCLUDED
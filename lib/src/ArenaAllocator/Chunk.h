@@ -14,6 +14,12 @@ namespace ArenaAllocator {
 
 class FreeList;
 
+// Chunks of pools are rounded up to the fundamental alignment.
+constexpr std::size_t getChunkSize(std::size_t size) noexcept
+{
+	return ((size + sizeof(std::max_align_t) - 1U) / sizeof(std::max_align_t)) * sizeof(std::max_align_t);
+}
+
 struct Chunk
 {
 	void* data;
@@ -21,13 +21,22 @@ void* getPtrToEmpty()
 	return &empty;
 }
 
+// Node layouts of libstdc++, list nodes linking to previous and next, hash nodes to next without cached hash code
+constexpr std::size_t listNodeSize{sizeof(Chunk) + 2 * sizeof(void*)};
+constexpr std::size_t hashNodeSize{sizeof(std::pair<void* const, FreeList::ListType::iterator>) + sizeof(void*)};
+
 } // namespace
 
-ChunkMap::ChunkMap(PoolMap<FreeList>& pools, Allocator* delegate, Logger const& log) noexcept :
-	ptrToEmpty{getPtrToEmpty()}, delegate{delegate}, log{log}, pools{pools}
+ChunkMap::ChunkMap(PoolGroups& groups, Allocator* delegate, Logger const& log) noexcept :
+	ptrToEmpty{getPtrToEmpty()}, delegate{delegate}, log{log}, groups{groups}
 {
-	chunks.reserve(pools.nChunks());
-	pools.forEachChunk([&](FreeList::ListType::iterator it) { chunks.insert(AggregateType::value_type(it->data, it)); });
+	// Chunks of all groups, such that frees find the pool a chunk belongs to, whichever thread frees.
+	std::size_t nChunks{0};
+	groups.forEachPoolMap([&](PoolMap<FreeList>& pools) { nChunks += pools.nChunks(); });
+	chunks.reserve(nChunks);
+	groups.forEachPoolMap([&](PoolMap<FreeList>& pools) {
+		pools.forEachChunk([&](FreeList::ListType::iterator it) { chunks.insert(AggregateType::value_type(it->data, it)); });
+	});
 }
 
 ChunkMap::DeallocateResult ChunkMap::deallocate(void* ptr) const noexcept
@@ -36,6 +45,8 @@ ChunkMap::DeallocateResult ChunkMap::deallocate(void* ptr) const noexcept
 	if (ptr != nullptr && ptr != ptrToEmpty) {
 		AggregateType::const_iterator it{chunks.find(ptr)};
 		if (it != chunks.end()) {
+			result.size = it->second->allocatedSize;
+			result.pool = it->second->pool->getId();
 			it->second->pool->deallocate(it->second);
 		} else if (delegate != nullptr) {
 			delegate->free(ptr);
@@ -102,14 +113,17 @@ ChunkMap::AllocateResult ChunkMap::reallocate(FreeList::ListType::iterator const
 {
 	AllocateResult result{nullptr, 0, false};
 	if (size > 0) {
-		FreeList* destinationPool{pools.at(size)};
+		FreeList* destinationPool{groups.getPools().at(size)};
 		if (destinationPool != nullptr) {
 			FreeList* currentPool{currentChunk->pool};
+			result.pool = destinationPool->getId();
 			if (destinationPool == currentPool) {
 				result.ptr = currentPool->reallocate(currentChunk, size);
 			} else {
 				if ((result.ptr = destinationPool->allocate(size)) != nullptr) {
-					std::memcpy(result.ptr, currentChunk->data, std::min(currentChunk->allocatedSize, size));
+					const std::size_t bytesMoved{std::min(currentChunk->allocatedSize, size)};
+					std::memcpy(result.ptr, currentChunk->data, bytesMoved);
+					currentPool->countMove(bytesMoved);
 					currentPool->deallocate(currentChunk);
 				} else {
 					result.propagateErrno = ENOMEM;
@@ -119,9 +133,32 @@ ChunkMap::AllocateResult ChunkMap::reallocate(FreeList::ListType::iterator const
 			result.propagateErrno = ENOMEM;
 		}
 	} else {
+		result.pool = currentChunk->pool->getId();
 		currentChunk->pool->deallocate(currentChunk);
 	}
 	return result;
 }
 
+void ChunkMap::dump() const noexcept
+{
+	std::size_t paddingBytes{0};
+	for (AggregateType::value_type const& element : chunks) {
+		paddingBytes += element.second->pool->getPaddingBytes();
+	}
+	const std::size_t listNodeBytes{chunks.size() * listNodeSize};
+	const std::size_t hashNodeBytes{chunks.size() * hashNodeSize};
+	const std::size_t hashBucketBytes{chunks.bucket_count() * sizeof(void*)};
+	log([&] {
+		return Message(
+			"ChunkMap: {chunks: {}, listNodeBytes: {}, hashNodeBytes: {}, hashBucketBytes: {}, paddingBytes: {}, "
+			"metadataBytes: {}}",
+			chunks.size(),
+			listNodeBytes,
+			hashNodeBytes,
+			hashBucketBytes,
+			paddingBytes,
+			listNodeBytes + hashNodeBytes + hashBucketBytes + paddingBytes);
+	});
+}
+
 } // namespace ArenaAllocator
@@ -13,7 +13,9 @@
 #include "ArenaAllocator/FreeList.h"
 #include "ArenaAllocator/Logger.h"
 #include "ArenaAllocator/PassThroughCXXAllocator.h"
+#include "ArenaAllocator/PoolGroups.h"
 #include "ArenaAllocator/PoolMap.h"
+#include <cstdint>
 #include <limits>
 #include <unistd.h>
 #include <unordered_map>
@@ -28,26 +30,34 @@ public:
 		void* ptr;
 		int propagateErrno;
 		bool fromDelegate;
+		std::uint32_t pool{0}; // FreeList::getId() of the pool allocated from
 	};
 
 	struct DeallocateResult
 	{
 		int propagateErrno;
 		bool fromDelegate;
+		std::size_t size{0}; // Size the chunk was allocated with
+		std::uint32_t pool{0}; // FreeList::getId() of the pool deallocated to
 	};
 
-	ChunkMap(PoolMap<FreeList>& pools, Allocator* delegate, Logger const& log) noexcept;
+	ChunkMap(PoolGroups& groups, Allocator* delegate, Logger const& log) noexcept;
 
 	template<typename DelegateF, typename AlignmentPredicate>
 	AllocateResult allocate(std::size_t size, DelegateF delegateF, AlignmentPredicate alignmentPredicate) const noexcept
 	{
 		AllocateResult result{nullptr, 0, false};
 		if (size) {
-			FreeList* pool{alignmentPredicate() ? pools.at(size) : nullptr};
+			FreeList* pool{groups.getPools().at(size)};
+			if (pool && !alignmentPredicate()) {
+				pool->countSpill();
+				pool = nullptr;
+			}
 			if (pool) {
 				if (!(result.ptr = pool->allocate(size))) {
 					result.propagateErrno = ENOMEM;
 				}
+				result.pool = pool->getId();
 			} else {
 				result = delegateF(size);
 			}
@@ -71,11 +81,12 @@ public:
 		} else {
 			std::size_t totalSize{nmemb * size};
 			if (totalSize) {
-				FreeList* pool{pools.at(totalSize)};
+				FreeList* pool{groups.getPools().at(totalSize)};
 				if (pool) {
 					if (!(result.ptr = pool->allocate(totalSize))) {
 						result.propagateErrno = ENOMEM;
 					}
+					result.pool = pool->getId();
 				} else {
 					result = delegateF(nmemb, size);
 				}
@@ -90,6 +101,8 @@ public:
 	AllocateResult reallocate(void* ptr, std::size_t nmemb, std::size_t size) const noexcept;
 	AllocateResult reallocate(FreeList::ListType::iterator const& currentChunk, std::size_t size) const noexcept;
 
+	void dump() const noexcept;
+
 	static constexpr auto alignAlways{[]() { return true; }};
 
 private:
@@ -103,7 +116,7 @@ private:
 	void* const ptrToEmpty;
 	Allocator* delegate;
 	Logger const& log;
-	PoolMap<FreeList>& pools;
+	PoolGroups& groups;
 	AggregateType chunks;
 };
 
@@ -27,12 +27,12 @@ Console::~Console() noexcept
 
 bool Console::isLevel(LogLevel level) const noexcept
 {
-	return logLevel >= level;
+	return logLevel.load(std::memory_order_relaxed) >= level;
 }
 
 void Console::setLevel(LogLevel level) noexcept
 {
-	logLevel = level;
+	logLevel.store(level, std::memory_order_relaxed);
 }
 
 namespace {
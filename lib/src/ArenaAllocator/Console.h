@@ -9,6 +9,7 @@
 #define ArenaAllocator_Console_h_INCLUDED
 
 #include "ArenaAllocator/Logger.h"
+#include <atomic>
 
 namespace ArenaAllocator {
 
@@ -47,7 +48,7 @@ private:
 	[[noreturn]] static void logAbort(Formatter const& formatter) noexcept;
 	[[noreturn]] static void logExit(Formatter const& formatter) noexcept;
 
-	LogLevel logLevel;
+	std::atomic<LogLevel> logLevel; // Set by the control thread
 };
 
 } // namespace ArenaAllocator
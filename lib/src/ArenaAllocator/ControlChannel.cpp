@@ -0,0 +1,182 @@
+//
+// Copyright (C) 2021 Dr. Michael Steffens
+//
+// SPDX-License-Identifier:     BSL-1.0
+//
+
+
+#include "ArenaAllocator/ControlChannel.h"
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <csignal>
+#include <cstddef>
+#include <cstdio>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace ArenaAllocator {
+
+namespace {
+
+// Written by the signal handler, read by the control thread
+std::array<int, 2> signalPipe{-1, -1};
+
+constexpr std::array<std::pair<std::string_view, LogLevel>, 5> logLevels{
+	{{"NONE", LogLevel::NONE},
+	 {"ERROR", LogLevel::ERROR},
+	 {"INFO", LogLevel::INFO},
+	 {"TRACE", LogLevel::TRACE},
+	 {"DEBUG", LogLevel::DEBUG}}};
+
+} // namespace
+
+ControlChannel::ControlChannel(
+	Control const& control, Allocator& allocator, InternalLoggerFactory& loggerFactory, Logger& log) noexcept :
+	control{control}, allocator{allocator}, loggerFactory{loggerFactory}, log{log}, listenFd{-1}, thread{}
+{
+	log(LogLevel::DEBUG, [&] {
+		return Message(
+			"ControlChannel::ControlChannel({signal:{}, socket:{}, page:{}}) -> this:{}",
+			control.signal,
+			static_cast<int>(control.socket),
+			static_cast<int>(control.page),
+			this);
+	});
+}
+
+ControlChannel::~ControlChannel() noexcept
+{
+	log(LogLevel::DEBUG, [&] { return Message("ControlChannel::~ControlChannel(this:{})", this); });
+}
+
+void ControlChannel::start() noexcept
+{
+	if (control.signal != 0) {
+		if (::pipe2(signalPipe.data(), O_CLOEXEC | O_NONBLOCK) == 0) {
+			struct ::sigaction action{};
+			action.sa_handler = &ControlChannel::handleSignal;
+			action.sa_flags = SA_RESTART;
+			::sigemptyset(&action.sa_mask);
+			if (::sigaction(control.signal, &action, nullptr) != 0) {
+				log(LogLevel::ERROR, [&] { return Message("ControlChannel failed to handle signal {}", control.signal); });
+			}
+		} else {
+			log(LogLevel::ERROR, [&] { return Message("ControlChannel failed to create signal pipe, errno {}", errno); });
+		}
+	}
+	if (control.socket) {
+		listenFd = listen();
+	}
+	if (signalPipe[0] != -1 || listenFd != -1) {
+		::pthread_attr_t attributes;
+		::pthread_attr_init(&attributes);
+		::pthread_attr_setdetachstate(&attributes, PTHREAD_CREATE_DETACHED);
+		if (::pthread_create(&thread, &attributes, &ControlChannel::run, this) != 0) {
+			log(LogLevel::ERROR, [&] { return Message("ControlChannel failed to create control thread"); });
+		}
+		::pthread_attr_destroy(&attributes);
+	}
+}
+
+void* ControlChannel::run(void* self) noexcept
+{
+	ControlChannel& channel{*static_cast<ControlChannel*>(self)};
+	std::array<::pollfd, 2> fds{{{signalPipe[0], POLLIN, 0}, {channel.listenFd, POLLIN, 0}}};
+	while (::poll(fds.data(), fds.size(), -1) >= 0 || errno == EINTR) {
+		if (fds[0].revents & POLLIN) {
+			std::array<char, 64> signals{};
+			while (::read(signalPipe[0], signals.data(), signals.size()) > 0) {
+			}
+			channel.dump();
+		}
+		if (fds[1].revents & POLLIN) {
+			int connection{::accept4(channel.listenFd, nullptr, nullptr, SOCK_CLOEXEC)};
+			if (connection != -1) {
+				channel.serve(connection);
+				::close(connection);
+			}
+		}
+	}
+	channel.log(LogLevel::ERROR, [&] { return Message("ControlChannel control thread terminated, errno {}", errno); });
+	return nullptr;
+}
+
+void ControlChannel::handleSignal(int) noexcept
+{
+	const int savedErrno{errno};
+	[[maybe_unused]] ::ssize_t written{::write(signalPipe[1], "d", 1)};
+	errno = savedErrno;
+}
+
+int ControlChannel::listen() noexcept
+{
+	::sockaddr_un address{};
+	address.sun_family = AF_UNIX;
+	// Abstract namespace, leading null character and no file system entry to clean up
+	const int nameLength{std::snprintf(&address.sun_path[1], sizeof(address.sun_path) - 1, "ArenaAllocator-%d", ::getpid())};
+	const ::socklen_t addressLength{static_cast<::socklen_t>(offsetof(::sockaddr_un, sun_path) + 1 + nameLength)};
+	int result{::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)};
+	if (result == -1 || ::bind(result, reinterpret_cast<::sockaddr*>(&address), addressLength) != 0 ||
+		::listen(result, 4) != 0) {
+		log(LogLevel::ERROR,
+			[&] { return Message("ControlChannel failed to listen on {}, errno {}", &address.sun_path[1], errno); });
+		if (result != -1) {
+			::close(result);
+		}
+		result = -1;
+	}
+	return result;
+}
+
+void ControlChannel::serve(int connection) noexcept
+{
+	::ucred credentials{};
+	::socklen_t credentialsLength{sizeof(credentials)};
+	std::string_view reply;
+	if (::getsockopt(connection, SOL_SOCKET, SO_PEERCRED, &credentials, &credentialsLength) != 0 ||
+		(credentials.uid != ::geteuid() && credentials.uid != 0)) {
+		reply = "error: permission denied\n";
+	} else {
+		std::array<char, 64> buffer{};
+		const ::ssize_t length{::read(connection, buffer.data(), buffer.size())};
+		std::string_view command{buffer.data(), static_cast<std::size_t>(std::max(length, ::ssize_t{0}))};
+		while (!command.empty() && (command.back() == '\n' || command.back() == '\r' || command.back() == ' ')) {
+			command.remove_suffix(1);
+		}
+		reply = execute(command);
+	}
+	[[maybe_unused]] ::ssize_t written{::write(connection, reply.data(), reply.size())};
+}
+
+std::string_view ControlChannel::execute(std::string_view command) noexcept
+{
+	std::string_view result{"error: unknown command\n"};
+	constexpr std::string_view setLevel{"logLevel "};
+	if (command == "dump") {
+		dump();
+		result = "ok\n";
+	} else if (command.substr(0, setLevel.size()) == setLevel) {
+		result = "error: invalid log level\n";
+		for (auto const& [name, level] : logLevels) {
+			if (command.substr(setLevel.size()) == name) {
+				log.setLevel(level);
+				result = "ok\n";
+			}
+		}
+	}
+	log(LogLevel::DEBUG, [&] { return Message("ControlChannel::execute({}) -> {}", command, result); });
+	return result;
+}
+
+void ControlChannel::dump() noexcept
+{
+	// Forced, as services typically run below log level INFO.
+	allocator.dump(true);
+	loggerFactory.dump();
+}
+
+} // namespace ArenaAllocator
@@ -0,0 +1,56 @@
+//
+// Copyright (C) 2021 Dr. Michael Steffens
+//
+// SPDX-License-Identifier:     BSL-1.0
+//
+
+
+#ifndef ArenaAllocator_ControlChannel_h_INCLUDED
+#define ArenaAllocator_ControlChannel_h_INCLUDED
+
+#include "ArenaAllocator/Allocator.h"
+#include "ArenaAllocator/Control.h"
+#include "ArenaAllocator/InternalLoggerFactory.h"
+#include "ArenaAllocator/Logger.h"
+#include <pthread.h>
+#include <string_view>
+
+namespace ArenaAllocator {
+
+// Dumps allocator and loggers of a running process, as finishArenaAllocator does at exit, on request of the configured
+// signal or a connection to abstract Unix domain socket ArenaAllocator-<pid>. The signal handler merely writes to a pipe,
+// the dump is run by a control thread. Socket commands, one per connection, are
+//   dump
+//   logLevel NONE|ERROR|INFO|TRACE|DEBUG
+// answered by "ok" or "error: <reason>". Only processes of the same user are served.
+class ControlChannel
+{
+public:
+	ControlChannel(Control const& control, Allocator& allocator, InternalLoggerFactory& loggerFactory, Logger& log) noexcept;
+	ControlChannel(ControlChannel const&) = delete;
+	ControlChannel& operator=(ControlChannel const&) = delete;
+	~ControlChannel() noexcept;
+
+	// Starts the control thread, if any channel is configured. Threads can't be created before the allocator is in place.
+	void start() noexcept;
+
+private:
+	static void* run(void* self) noexcept;
+	static void handleSignal(int signal) noexcept;
+
+	int listen() noexcept;
+	void serve(int connection) noexcept;
+	std::string_view execute(std::string_view command) noexcept;
+	void dump() noexcept;
+
+	Control const& control;
+	Allocator& allocator;
+	InternalLoggerFactory& loggerFactory;
+	Logger& log;
+	int listenFd;
+	::pthread_t thread;
+};
+
+} // namespace ArenaAllocator
+
+#endif // ArenaAllocator_ControlChannel_h_INCLUDED
@@ -0,0 +1,67 @@
+//
+// Copyright (C) 2021 Dr. Michael Steffens
+//
+// SPDX-License-Identifier:     BSL-1.0
+//
+
+
+#include "ArenaAllocator/DelegateHistogram.h"
+
+namespace ArenaAllocator {
+
+DelegateHistogram::DelegateHistogram(Logger const& log) noexcept : log{log}, histograms{}
+{
+}
+
+void DelegateHistogram::record(OperationType operationType, std::size_t size, std::size_t alignment) noexcept
+{
+	Histogram& histogram{histograms[static_cast<std::size_t>(operationType)]};
+	histogram.sizes[getSizeBucket(size)].fetch_add(1, std::memory_order_relaxed);
+	if (alignment > 0) {
+		const std::size_t exponent{63U - static_cast<unsigned>(__builtin_clzll(alignment))};
+		histogram.alignments[exponent].fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+void DelegateHistogram::dump() const noexcept
+{
+	for (std::size_t typeIndex = 0; typeIndex < nOperationTypes; ++typeIndex) {
+		dump(OperationType{static_cast<unsigned>(typeIndex)});
+	}
+}
+
+std::size_t DelegateHistogram::getSizeBucket(std::size_t size) noexcept
+{
+	return SizeBuckets::getBucket(size);
+}
+
+SizeRange DelegateHistogram::getSizeBucketRange(std::size_t bucket) noexcept
+{
+	return SizeRange{SizeBuckets::getLowerBound(bucket), SizeBuckets::getUpperBound(bucket)};
+}
+
+void DelegateHistogram::dump(OperationType operationType) const noexcept
+{
+	Histogram const& histogram{histograms[static_cast<std::size_t>(operationType)]};
+	for (std::size_t bucket = 0; bucket < nSizeBuckets; ++bucket) {
+		const std::uint64_t count{histogram.sizes[bucket].load(std::memory_order_relaxed)};
+		if (count > 0) {
+			const SizeRange range{getSizeBucketRange(bucket)};
+			log([&] {
+				return Message(
+					"DelegateHistogram: {} [{}, {}]: {count: {}}", to_string(operationType), range.first, range.last, count);
+			});
+		}
+	}
+	for (std::size_t exponent = 0; exponent < nAlignmentBuckets; ++exponent) {
+		const std::uint64_t count{histogram.alignments[exponent].load(std::memory_order_relaxed)};
+		if (count > 0) {
+			log([&] {
+				return Message(
+					"DelegateHistogram: {} alignment {}: {count: {}}", to_string(operationType), std::size_t{1} << exponent, count);
+			});
+		}
+	}
+}
+
+} // namespace ArenaAllocator
@@ -0,0 +1,61 @@
+//
+// Copyright (C) 2021 Dr. Michael Steffens
+//
+// SPDX-License-Identifier:     BSL-1.0
+//
+
+
+#ifndef ArenaAllocator_DelegateHistogram_h_INCLUDED
+#define ArenaAllocator_DelegateHistogram_h_INCLUDED
+
+#include "ArenaAllocator/LogLinearBuckets.h"
+#include "ArenaAllocator/Logger.h"
+#include "ArenaAllocator/OperationType.h"
+#include "ArenaAllocator/SizeRange.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace ArenaAllocator {
+
+// Sizes and alignments of the requests served by the delegate, by operation type. Bucket bounds do not depend on the
+// pool configuration, so histograms of different configurations compare directly.
+class DelegateHistogram
+{
+public:
+	explicit DelegateHistogram(Logger const& log) noexcept;
+	DelegateHistogram(DelegateHistogram const&) = delete;
+	DelegateHistogram& operator=(DelegateHistogram const&) = delete;
+	~DelegateHistogram() noexcept = default;
+
+	// Alignment 0 stands for requests without explicit alignment.
+	void record(OperationType operationType, std::size_t size, std::size_t alignment) noexcept;
+	void dump() const noexcept;
+
+	using SizeBuckets = LogLinearBuckets<2>;
+	static constexpr std::size_t nSizeBuckets{SizeBuckets::nBuckets};
+	static constexpr std::size_t nAlignmentBuckets{64};
+
+	[[nodiscard]] static std::size_t getSizeBucket(std::size_t size) noexcept;
+	[[nodiscard]] static SizeRange getSizeBucketRange(std::size_t bucket) noexcept;
+
+private:
+	static constexpr std::size_t nOperationTypes{static_cast<std::size_t>(OperationType::UNKNOWN)};
+
+	// Counters are plain relaxed atomics, the delegate call they are recorded for outweighing any cache line contention.
+	struct Histogram
+	{
+		std::array<std::atomic<std::uint64_t>, nSizeBuckets> sizes;
+		std::array<std::atomic<std::uint64_t>, nAlignmentBuckets> alignments;
+	};
+
+	void dump(OperationType operationType) const noexcept;
+
+	Logger const& log;
+	std::array<Histogram, nOperationTypes> histograms;
+};
+
+} // namespace ArenaAllocator
+
+#endif // ArenaAllocator_DelegateHistogram_h_INCLUDED
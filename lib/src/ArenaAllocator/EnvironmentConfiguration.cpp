@@ -6,6 +6,7 @@
 
 
 #include "ArenaAllocator/EnvironmentConfiguration.h"
+#include "ArenaAllocator/BuiltinConfiguration.h"
 #include "ArenaAllocator/Console.h"
 #include "ArenaAllocator/ParseConfiguration.h"
 
@@ -19,10 +20,15 @@ EnvironmentConfiguration::EnvironmentConfiguration(
 	Logger*& logger) noexcept :
 	allocator{allocator}, logger{logger}
 {
-	if (configStr == nullptr) {
+	if (configStr != nullptr) {
+		ParseConfiguration{configStr, pools, groups}(className, logLevel, loggerName, sampling, control, profile, phase);
+	} else if (!BuiltinConfiguration::available) {
 		Console::exit([] { return Message("failed to read environment variable {}", configurationEnvVarName); });
 	}
-	ParseConfiguration{configStr, pools}(className, logLevel, loggerName);
+	if constexpr (BuiltinConfiguration::available) {
+		// Items given in the environment variable override the builtin ones.
+		BuiltinConfiguration{pools}(className, logLevel, loggerName, sampling, control, profile, phase);
+	}
 	if ((logger = loggerFactory.getLogger(EnvironmentConfiguration::getLogger())) == nullptr) {
 		Console::exit([] { return Message("unexpected logger class in environment variable {}", configurationEnvVarName); });
 	}
@@ -64,4 +70,33 @@ std::string_view const& EnvironmentConfiguration::getLogger() const noexcept
 	return loggerName.value();
 }
 
+Sampling const& EnvironmentConfiguration::getSampling() const noexcept
+{
+	static constexpr Sampling recordAll{Sampling::Mode::NONE, 0};
+	return sampling.has_value() ? sampling.value() : recordAll;
+}
+
+Control const& EnvironmentConfiguration::getControl() const noexcept
+{
+	static constexpr Control noControl{0, false, false};
+	return control.has_value() ? control.value() : noControl;
+}
+
+Profile const& EnvironmentConfiguration::getProfile() const noexcept
+{
+	static constexpr Profile noProfile{false, false};
+	return profile.has_value() ? profile.value() : noProfile;
+}
+
+Phase const& EnvironmentConfiguration::getPhase() const noexcept
+{
+	static constexpr Phase noPhase{0, 0};
+	return phase.has_value() ? phase.value() : noPhase;
+}
+
+Configuration::PoolGroupsType const& EnvironmentConfiguration::getGroups() const noexcept
+{
+	return groups;
+}
+
 } // namespace ArenaAllocator
@@ -34,6 +34,11 @@ public:
 	[[nodiscard]] Configuration::PoolMapType const& getPools() const noexcept override;
 	[[nodiscard]] LogLevel const& getLogLevel() const noexcept override;
 	[[nodiscard]] std::string_view const& getLogger() const noexcept override;
+	[[nodiscard]] Sampling const& getSampling() const noexcept override;
+	[[nodiscard]] Control const& getControl() const noexcept override;
+	[[nodiscard]] Profile const& getProfile() const noexcept override;
+	[[nodiscard]] Phase const& getPhase() const noexcept override;
+	[[nodiscard]] Configuration::PoolGroupsType const& getGroups() const noexcept override;
 
 	static constexpr char const* configurationEnvVarName{"ARENA_ALLOCATOR_CONFIGURATION"};
 
@@ -44,6 +49,11 @@ private:
 	std::optional<Configuration::PoolMapType> pools;
 	std::optional<LogLevel> logLevel;
 	std::optional<std::string_view> loggerName;
+	std::optional<Sampling> sampling;
+	std::optional<Control> control;
+	std::optional<Profile> profile;
+	std::optional<Phase> phase;
+	Configuration::PoolGroupsType groups;
 };
 
 } // namespace ArenaAllocator
@@ -9,14 +9,20 @@
 #include "ArenaAllocator/Chunk.h"
 #include "ArenaAllocator/Console.h"
 #include <cstring>
+#include <new>
 
 namespace ArenaAllocator {
 
 FreeList::FreeList(SizeRange const& range, std::size_t nChunks, Logger const& log) noexcept :
 	range{range},
-	chunkSize{((range.last + sizeof(std::max_align_t) - 1U) / sizeof(std::max_align_t)) * sizeof(std::max_align_t)},
+	chunkSize{getChunkSize(range.last)},
 	log{log},
-	hwm{0}
+	hwm{0},
+	liveBytes{0},
+	page{nullptr},
+	nRemoteFrees{0},
+	remoteFrees{nullptr},
+	id{0}
 {
 	log(LogLevel::DEBUG,
 		[&] { return Message("FreeList::FreeList([{}, {}], {}) -> this:{}", range.first, range.last, nChunks, this); });
@@ -36,15 +42,20 @@ FreeList::~FreeList() noexcept
 void* FreeList::allocate(std::size_t size) noexcept
 {
 	std::lock_guard<std::mutex> guard{mutex};
+	drainRemoteFrees();
 	void* result{nullptr};
 	if (free.empty()) {
 		result = nullptr;
+		counters.add(FAILURES);
 	} else {
 		allocated.splice(allocated.begin(), free, free.begin());
 		allocated.front().allocatedSize = size;
+		liveBytes += size;
+		counters.add(ALLOCATIONS);
 		hwm = std::max(hwm, allocated.size());
 		result = allocated.front().data;
 	}
+	updatePage();
 	return result;
 }
 
@@ -54,32 +65,177 @@ void* FreeList::reallocate(ListType::iterator it, std::size_t size) noexcept
 	if (it->allocatedSize == 0) {
 		Console::abort([&] { return Message("FreeList::reallocate({}, {}) not allocated", it->data, size); });
 	}
+	counters.add(IN_PLACE_REALLOCS);
+	liveBytes = liveBytes - it->allocatedSize + size;
 	it->allocatedSize = size;
 	return it->data;
 }
 
 void FreeList::deallocate(ListType::const_iterator it) noexcept
 {
-	std::lock_guard<std::mutex> guard{mutex};
+	counters.add(FREES);
+	std::unique_lock<std::mutex> guard{mutex, std::try_to_lock};
+	if (guard.owns_lock()) {
+		drainRemoteFrees();
+		deallocateLocked(it);
+		updatePage();
+	} else {
+		if (it->allocatedSize == 0) {
+			Console::abort([&] { return Message("FreeList::deallocate({}): not allocated", it->data); });
+		}
+		RemoteFree* remoteFree{new (it->data) RemoteFree{nullptr, it}};
+		remoteFree->next = remoteFrees.load(std::memory_order_relaxed);
+		while (!remoteFrees.compare_exchange_weak(
+			remoteFree->next, remoteFree, std::memory_order_release, std::memory_order_relaxed)) {
+		}
+	}
+}
+
+void FreeList::deallocateLocked(ListType::const_iterator it) noexcept
+{
 	if (it->allocatedSize == 0) {
 		Console::abort([&] { return Message("FreeList::deallocate({}): not allocated", it->data); });
 	}
+	liveBytes -= it->allocatedSize;
 	free.splice(free.begin(), allocated, it);
 	std::memset(free.front().data, 0, chunkSize);
+	counters.add(BYTES_ZEROED, chunkSize);
 	free.front().allocatedSize = 0;
 }
 
+// Chunks pending on the remote free stack are still in list allocated. Only drainRemoteFrees removes entries, so the
+// stack can be traversed while holding the mutex.
+FreeList::PendingFrees FreeList::getPendingFrees() const noexcept
+{
+	PendingFrees result{0, 0};
+	for (RemoteFree* remoteFree = remoteFrees.load(std::memory_order_acquire); remoteFree != nullptr;
+		 remoteFree = remoteFree->next) {
+		++result.chunks;
+		result.bytes += remoteFree->it->allocatedSize;
+	}
+	return result;
+}
+
+void FreeList::drainRemoteFrees() noexcept
+{
+	// Taking the entire stack at once is immune to ABA, pushes don't depend on the nodes following the head.
+	RemoteFree* remoteFree{remoteFrees.load(std::memory_order_relaxed) != nullptr
+							   ? remoteFrees.exchange(nullptr, std::memory_order_acquire)
+							   : nullptr};
+	while (remoteFree != nullptr) {
+		RemoteFree* next{remoteFree->next};
+		deallocateLocked(remoteFree->it);
+		++nRemoteFrees;
+		remoteFree = next;
+	}
+}
+
 std::size_t FreeList::nChunks() const noexcept
 {
 	std::lock_guard<std::mutex> guard{mutex};
 	return free.size() + allocated.size();
 }
 
+// Page counters are updated from now on, while holding the mutex.
+void FreeList::publish(StatisticsPagePool* page) noexcept
+{
+	std::lock_guard<std::mutex> guard{mutex};
+	this->page = page;
+	updatePage();
+}
+
+// Requested size in range, but alignment not provided by chunks
+void FreeList::countSpill() noexcept
+{
+	counters.add(SPILLS);
+	if (page != nullptr) {
+		std::lock_guard<std::mutex> guard{mutex};
+		updatePage();
+	}
+}
+
+// Chunk of this pool reallocated to another pool
+void FreeList::countMove(std::size_t bytesMoved) noexcept
+{
+	counters.add(MOVING_REALLOCS);
+	counters.add(BYTES_MOVED, bytesMoved);
+}
+
+void FreeList::setId(std::uint32_t poolId) noexcept
+{
+	id = poolId;
+}
+
+std::uint32_t FreeList::getId() const noexcept
+{
+	return id;
+}
+
+void FreeList::getCounters(PoolCounters& result) const noexcept
+{
+	std::lock_guard<std::mutex> guard{mutex};
+	const PendingFrees pending{getPendingFrees()};
+	result = PoolCounters{
+		range,
+		free.size() + allocated.size(),
+		free.size() + pending.chunks,
+		allocated.size() - pending.chunks,
+		hwm,
+		counters.get(ALLOCATIONS),
+		counters.get(FREES),
+		counters.get(FAILURES),
+		counters.get(SPILLS),
+		counters.get(IN_PLACE_REALLOCS),
+		counters.get(MOVING_REALLOCS),
+		counters.get(BYTES_MOVED),
+		counters.get(BYTES_ZEROED),
+		0};
+}
+
+void FreeList::updatePage() noexcept
+{
+	if (page != nullptr) {
+		const PendingFrees pending{getPendingFrees()};
+		const std::uint64_t sequence{page->sequence.load(std::memory_order_relaxed)};
+		page->sequence.store(sequence + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		page->free.store(free.size() + pending.chunks, std::memory_order_relaxed);
+		page->allocated.store(allocated.size() - pending.chunks, std::memory_order_relaxed);
+		page->hwm.store(hwm, std::memory_order_relaxed);
+		page->allocations.store(counters.get(ALLOCATIONS), std::memory_order_relaxed);
+		page->failures.store(counters.get(FAILURES), std::memory_order_relaxed);
+		page->spills.store(counters.get(SPILLS), std::memory_order_relaxed);
+		page->sequence.store(sequence + 2, std::memory_order_release);
+	}
+}
+
+// Storage a chunk occupies beyond the largest size of its range, due to alignment
+std::size_t FreeList::getPaddingBytes() const noexcept
+{
+	return chunkSize - range.last;
+}
+
 void FreeList::dump() const noexcept
 {
 	std::lock_guard<std::mutex> guard{mutex};
+	const PendingFrees pending{getPendingFrees()};
+	// Requested bytes of allocated chunks versus the bytes these chunks reserve
+	const std::size_t requestedBytes{liveBytes - pending.bytes};
+	const std::size_t reservedBytes{(allocated.size() - pending.chunks) * chunkSize};
 	log([&] {
-		return Message("[{}, {}]: {free: {}, allocated: {}, hwm: {}}", range.first, range.last, free.size(), allocated.size(), hwm);
+		return Message(
+			"[{}, {}]: {free: {}, allocated: {}, hwm: {}, remoteFrees: {}, requestedBytes: {}, reservedBytes: {}, "
+			"wastedBytes: {}, efficiencyPercent: {}}",
+			range.first,
+			range.last,
+			free.size() + pending.chunks,
+			allocated.size() - pending.chunks,
+			hwm,
+			nRemoteFrees + pending.chunks,
+			requestedBytes,
+			reservedBytes,
+			reservedBytes - requestedBytes,
+			reservedBytes > 0 ? requestedBytes * 100 / reservedBytes : 100);
 	});
 }
 
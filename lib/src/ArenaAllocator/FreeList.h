@@ -9,16 +9,24 @@
 #define ArenaAllocator_Pool_h_INCLUDED
 
 #include "ArenaAllocator/Chunk.h"
+#include "ArenaAllocator/Counters.h"
 #include "ArenaAllocator/Logger.h"
 #include "ArenaAllocator/PassThroughCXXAllocator.h"
+#include "ArenaAllocator/ShardedCounters.h"
 #include "ArenaAllocator/SizeRange.h"
+#include "ArenaAllocator/StatisticsPageFormat.h"
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
 #include <list>
 #include <mutex>
 #include <vector>
 
 namespace ArenaAllocator {
 
+// Chunks of a size range, allocated and deallocated under a mutex. Deallocations finding the mutex held by another thread,
+// typically consumers freeing chunks allocated by a producer, don't wait for it. They push the chunk onto a lock-free stack
+// of remote frees instead, which the thread holding the mutex next returns to the free list in a batch.
 class FreeList
 {
 public:
@@ -33,6 +41,14 @@ public:
 	void* reallocate(ListType::iterator it, std::size_t size) noexcept;
 	void deallocate(ListType::const_iterator it) noexcept;
 	std::size_t nChunks() const noexcept;
+	std::size_t getPaddingBytes() const noexcept;
+	void publish(StatisticsPagePool* page) noexcept;
+	void countSpill() noexcept;
+	void countMove(std::size_t bytesMoved) noexcept;
+	void getCounters(PoolCounters& counters) const noexcept;
+	// Pool identifier in trace records, assigned by the owner. 0 if none.
+	void setId(std::uint32_t poolId) noexcept;
+	std::uint32_t getId() const noexcept;
 
 	template<typename F>
 	void forEachChunk(F f) noexcept
@@ -49,6 +65,41 @@ public:
 
 private:
 	using StorageType = std::vector<std::max_align_t, PassThroughCXXAllocator<std::max_align_t>>;
+
+	// Indices of counters, kept outside the mutex
+	enum Counter : std::size_t
+	{
+		ALLOCATIONS,
+		FREES,
+		FAILURES,
+		SPILLS,
+		IN_PLACE_REALLOCS,
+		MOVING_REALLOCS,
+		BYTES_MOVED,
+		BYTES_ZEROED,
+		N_COUNTERS
+	};
+
+	// Stored in the data of a chunk pending on the remote free stack
+	struct RemoteFree
+	{
+		RemoteFree* next;
+		ListType::const_iterator it;
+	};
+
+	static_assert(sizeof(RemoteFree) <= sizeof(std::max_align_t), "remote free entry exceeds minimum chunk size");
+
+	struct PendingFrees
+	{
+		std::size_t chunks;
+		std::size_t bytes; // Requested
+	};
+
+	void deallocateLocked(ListType::const_iterator it) noexcept;
+	PendingFrees getPendingFrees() const noexcept;
+	void drainRemoteFrees() noexcept;
+	void updatePage() noexcept;
+
 	const SizeRange range;
 	const std::size_t chunkSize;
 	mutable std::mutex mutex;
@@ -57,6 +108,12 @@ private:
 	ListType allocated;
 	Logger const& log;
 	std::size_t hwm;
+	std::size_t liveBytes;
+	StatisticsPagePool* page;
+	ShardedCounters<Counter::N_COUNTERS> counters;
+	std::size_t nRemoteFrees;
+	std::atomic<RemoteFree*> remoteFrees;
+	std::uint32_t id;
 };
 
 } // namespace ArenaAllocator
@@ -14,24 +14,76 @@ InternalAllocatorFactory::InternalAllocatorFactory(Configuration const& configur
 {
 }
 
+namespace {
+
+std::string_view trim(std::string_view str) noexcept
+{
+	const std::size_t first{str.find_first_not_of(" \t\n")};
+	return first == std::string_view::npos ? std::string_view{} : str.substr(first, str.find_last_not_of(" \t\n") - first + 1);
+}
+
+// Whether the delegate chain frees and reallocates pointers of PassThrough, as PhaseSwitch requires for its startup
+// allocations: SegregatedFreeLists falls back to a PassThrough delegate for pointers it does not own. Wrappers like
+// SizeRangeStatistics or AllocationTrace would account them as unknown allocations.
+bool acceptsPassThroughPointers(std::string_view className) noexcept
+{
+	const std::string_view name{trim(className)};
+	const std::size_t delegateBegin{name.find('(')};
+	bool result{name == PassThrough::className};
+	if (trim(name.substr(0, delegateBegin)) == SegregatedFreeLists::className) {
+		result = delegateBegin == std::string_view::npos ||
+			(name.back() == ')' &&
+			 trim(name.substr(delegateBegin + 1, name.size() - delegateBegin - 2)) == PassThrough::className);
+	}
+	return result;
+}
+
+} // namespace
+
 Allocator* ArenaAllocator::InternalAllocatorFactory::getAllocator(std::string_view const& className) noexcept
 {
+	// className may name a delegate chain, e.g. SizeRangeStatistics(SegregatedFreeLists(PassThrough)). Allocators
+	// taking a delegate default to PassThrough.
 	Allocator* result{nullptr};
-	if (className == PassThrough::className) {
-		if (!passThrough.has_value()) {
-			passThrough.emplace(*logger);
-		}
-		result = &passThrough.value();
-	} else if (className == SegregatedFreeLists::className) {
-		if (!segregatedFreeLists.has_value()) {
-			segregatedFreeLists.emplace(configuration, getAllocator(PassThrough::className), *logger);
+	std::string_view name{trim(className)};
+	std::string_view delegateClassName{PassThrough::className};
+	const std::size_t delegateBegin{name.find('(')};
+	const bool hasDelegate{delegateBegin != std::string_view::npos};
+	if (hasDelegate) {
+		const std::size_t delegateEnd{name.size() - 1};
+		delegateClassName = name[delegateEnd] == ')' ? trim(name.substr(delegateBegin + 1, delegateEnd - delegateBegin - 1))
+													 : std::string_view{};
+		name = trim(name.substr(0, delegateBegin));
+	}
+	if (name == PassThrough::className) {
+		if (!hasDelegate) {
+			if (!passThrough.has_value()) {
+				passThrough.emplace(*logger);
+			}
+			result = &passThrough.value();
 		}
-		result = &segregatedFreeLists.value();
-	} else if (className == SizeRangeStatistics::className) {
-		if (!sizeRangeStatistics.has_value()) {
-			sizeRangeStatistics.emplace(configuration, *getAllocator(PassThrough::className), *logger);
+	} else if (name == SegregatedFreeLists::className) {
+		result = getDelegatingAllocator(segregatedFreeLists, delegateClassName, [&](Allocator& delegate) {
+			segregatedFreeLists.emplace(configuration, &delegate, *logger);
+		});
+	} else if (name == SizeRangeStatistics::className) {
+		result = getDelegatingAllocator(sizeRangeStatistics, delegateClassName, [&](Allocator& delegate) {
+			sizeRangeStatistics.emplace(configuration, delegate, *logger);
+		});
+	} else if (name == AllocationTrace::className) {
+		result = getDelegatingAllocator(
+			allocationTrace, delegateClassName, [&](Allocator& delegate) { allocationTrace.emplace(delegate, *logger); });
+	} else if (name == PhaseSwitch::className) {
+		// Startup allocations are passed through, such that delegates falling back to PassThrough free them.
+		if (acceptsPassThroughPointers(delegateClassName)) {
+			result = getDelegatingAllocator(phaseSwitch, delegateClassName, [&](Allocator& delegate) {
+				phaseSwitch.emplace(configuration, *getAllocator(PassThrough::className), delegate, *logger);
+			});
+		} else {
+			(*logger)(LogLevel::ERROR, [&] {
+				return Message("{} requires delegate {} or {}", name, SegregatedFreeLists::className, PassThrough::className);
+			});
 		}
-		result = &sizeRangeStatistics.value();
 	}
 	return result;
 }
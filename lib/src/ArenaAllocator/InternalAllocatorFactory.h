@@ -8,10 +8,12 @@
 #ifndef ArenaAllocator_InternalAllocatorFactory_h_INCLUDED
 #define ArenaAllocator_InternalAllocatorFactory_h_INCLUDED
 
+#include "ArenaAllocator/AllocationTrace.h"
 #include "ArenaAllocator/AllocatorFactory.h"
 #include "ArenaAllocator/Configuration.h"
 #include "ArenaAllocator/Logger.h"
 #include "ArenaAllocator/PassThrough.h"
+#include "ArenaAllocator/PhaseSwitch.h"
 #include "ArenaAllocator/SegregatedFreeLists.h"
 #include "ArenaAllocator/SizeRangeStatistics.h"
 #include <optional>
@@ -29,11 +31,30 @@ public:
 	Allocator* getAllocator(std::string_view const& className) noexcept override;
 
 private:
+	template<typename T, typename F>
+	Allocator* getDelegatingAllocator(std::optional<T>& instance, std::string_view const& delegateClassName, F emplace) noexcept
+	{
+		Allocator* result{nullptr};
+		if (!instance.has_value()) {
+			Allocator* delegate{getAllocator(delegateClassName)};
+			// A class already instantiated while resolving its own delegate would form a cycle.
+			if (delegate != nullptr && !instance.has_value()) {
+				emplace(*delegate);
+				result = &instance.value();
+			}
+		} else {
+			result = &instance.value();
+		}
+		return result;
+	}
+
 	Configuration const& configuration;
 	Logger* const& logger;
 	std::optional<PassThrough> passThrough;
 	std::optional<SegregatedFreeLists> segregatedFreeLists;
 	std::optional<SizeRangeStatistics> sizeRangeStatistics;
+	std::optional<AllocationTrace> allocationTrace;
+	std::optional<PhaseSwitch> phaseSwitch;
 };
 
 } // namespace ArenaAllocator
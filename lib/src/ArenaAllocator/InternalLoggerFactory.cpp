@@ -22,8 +22,35 @@ Logger* InternalLoggerFactory::getLogger(std::string_view const& className) noex
 			timerLogger.emplace();
 		}
 		result = &timerLogger.value();
+	} else if (className == BinaryTrace::className) {
+		if (!binaryTraceLogger.has_value()) {
+			binaryTraceLogger.emplace();
+		}
+		result = &binaryTraceLogger.value();
+	} else if (className == LatencyHistogram::className) {
+		if (!latencyHistogramLogger.has_value()) {
+			latencyHistogramLogger.emplace();
+		}
+		result = &latencyHistogramLogger.value();
 	}
 	return result;
 }
 
+void InternalLoggerFactory::start() noexcept
+{
+	if (binaryTraceLogger.has_value()) {
+		binaryTraceLogger->start();
+	}
+}
+
+void InternalLoggerFactory::dump() const noexcept
+{
+	if (binaryTraceLogger.has_value()) {
+		binaryTraceLogger->flush();
+	}
+	if (latencyHistogramLogger.has_value()) {
+		latencyHistogramLogger->dump();
+	}
+}
+
 } // namespace ArenaAllocator
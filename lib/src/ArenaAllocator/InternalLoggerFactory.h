@@ -8,7 +8,9 @@
 #ifndef ArenaAllocator_InternalLoggerFactory_h_INCLUDED
 #define ArenaAllocator_InternalLoggerFactory_h_INCLUDED
 
+#include "ArenaAllocator/BinaryTrace.h"
 #include "ArenaAllocator/Console.h"
+#include "ArenaAllocator/LatencyHistogram.h"
 #include "ArenaAllocator/LoggerFactory.h"
 #include "ArenaAllocator/TimeTrace.h"
 #include <optional>
@@ -24,10 +26,15 @@ public:
 	~InternalLoggerFactory() override = default;
 
 	Logger* getLogger(std::string_view const& className) noexcept override;
+	// Starts background threads of the loggers created, once the process is initialized.
+	void start() noexcept;
+	void dump() const noexcept;
 
 private:
 	std::optional<Console> consoleLogger;
 	std::optional<TimeTrace> timerLogger;
+	std::optional<BinaryTrace> binaryTraceLogger;
+	std::optional<LatencyHistogram> latencyHistogramLogger;
 };
 
 } // namespace ArenaAllocator
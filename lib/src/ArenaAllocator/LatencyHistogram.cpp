@@ -0,0 +1,199 @@
+//
+// Copyright (C) 2021 Dr. Michael Steffens
+//
+// SPDX-License-Identifier:     BSL-1.0
+//
+
+
+#include "ArenaAllocator/LatencyHistogram.h"
+#include "ArenaAllocator/ThreadShard.h"
+#include <algorithm>
+#include <limits>
+#include <new>
+#include <unistd.h>
+
+extern "C" void* __libc_malloc(std::size_t size);
+extern "C" void __libc_free(void* ptr);
+
+namespace ArenaAllocator {
+
+namespace {
+
+void writeToBuffer(Static::FormatResult message) noexcept
+{
+	Message out("[pid:{}]\t\t{}", ::getpid(), message);
+	Static::BasicLogger::writeLine(out.getResult());
+}
+
+} // namespace
+
+LatencyHistogram::LatencyHistogram() noexcept : logLevel{LogLevel::NONE}, shards{}
+{
+	LatencyHistogram::log(
+		LogLevel::DEBUG, FormattingCallback{[&] { return Message("LatencyHistogram::LatencyHistogram() -> this:{}", this); }});
+}
+
+LatencyHistogram::~LatencyHistogram() noexcept
+{
+	LatencyHistogram::log(
+		LogLevel::DEBUG, FormattingCallback{[&] { return Message("LatencyHistogram::~LatencyHistogram(this:{})", this); }});
+	for (std::atomic<Shard*>& shard : shards) {
+		if (Shard* allocated = shard.exchange(nullptr)) {
+			allocated->~Shard();
+			__libc_free(allocated);
+		}
+	}
+}
+
+bool LatencyHistogram::isLevel(LogLevel level) const noexcept
+{
+	return logLevel.load(std::memory_order_relaxed) >= level;
+}
+
+void LatencyHistogram::setLevel(LogLevel level) noexcept
+{
+	logLevel.store(level, std::memory_order_relaxed);
+}
+
+void LatencyHistogram::dump() const noexcept
+{
+	for (std::size_t typeIndex = 0; typeIndex < nOperationTypes; ++typeIndex) {
+		for (std::size_t sizeClass = 0; sizeClass < nSizeClasses; ++sizeClass) {
+			dump(OperationType{static_cast<unsigned>(typeIndex)}, sizeClass);
+		}
+	}
+}
+
+std::size_t LatencyHistogram::getBucket(std::uint64_t nanoseconds) noexcept
+{
+	return std::min(Buckets::getBucket(nanoseconds), nBuckets - 1);
+}
+
+std::uint64_t LatencyHistogram::getBucketUpperBound(std::size_t bucket) noexcept
+{
+	return bucket + 1 < nBuckets ? Buckets::getUpperBound(bucket) : std::numeric_limits<std::uint64_t>::max();
+}
+
+std::size_t LatencyHistogram::getSizeClass(std::size_t size) noexcept
+{
+	std::size_t result{0};
+	if (size > 0) {
+		// Number of bits required for size - 1, i.e. ceil(log2(size))
+		const unsigned bits{size > 1 ? 64U - static_cast<unsigned>(__builtin_clzll(size - 1)) : 0U};
+		result = std::min(static_cast<std::size_t>(1U + (bits <= 4U ? 0U : (bits - 3U) / 2U)), nSizeClasses - 1);
+	}
+	return result;
+}
+
+SizeRange LatencyHistogram::getSizeClassRange(std::size_t sizeClass) noexcept
+{
+	SizeRange result{0, 0};
+	if (sizeClass + 1 == nSizeClasses) {
+		result = SizeRange{(1ULL << (2 * sizeClass)) + 1, std::numeric_limits<std::size_t>::max()};
+	} else if (sizeClass > 1) {
+		result = SizeRange{(1ULL << (2 * sizeClass)) + 1, 1ULL << (2 * sizeClass + 2)};
+	} else if (sizeClass == 1) {
+		result = SizeRange{1, 16};
+	}
+	return result;
+}
+
+void LatencyHistogram::log(Formatter const& formatter) const noexcept
+{
+	Message message = formatter();
+	writeToBuffer(message.getResult());
+}
+
+void LatencyHistogram::log(
+	std::chrono::nanoseconds duration, OperationType operationType, Formatter const& formatter) const noexcept
+{
+	log(duration, operationType, 0, formatter);
+}
+
+void LatencyHistogram::log(LogLevel level, Formatter const& formatter) const noexcept
+{
+	if (isLevel(level)) {
+		Message message = formatter();
+		writeToBuffer(message.getResult());
+	}
+}
+
+void LatencyHistogram::log(
+	std::chrono::nanoseconds duration, OperationType operationType, std::size_t size, Formatter const&) const noexcept
+{
+	Shard* shard{getShard()};
+	// Durations of 0 are discarded timings.
+	if (shard != nullptr && duration.count() > 0 && operationType != OperationType::UNKNOWN) {
+		const auto nanoseconds{static_cast<std::uint64_t>(duration.count())};
+		Histogram& histogram{shard->histograms[static_cast<std::size_t>(operationType)][getSizeClass(size)]};
+		histogram.buckets[getBucket(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+		std::uint64_t max{histogram.max.load(std::memory_order_relaxed)};
+		while (nanoseconds > max && !histogram.max.compare_exchange_weak(max, nanoseconds, std::memory_order_relaxed)) {
+		}
+	}
+}
+
+LatencyHistogram::Shard* LatencyHistogram::getShard() const noexcept
+{
+	std::atomic<Shard*>& shard{shards[getThreadShard<nShards>()]};
+	Shard* result{shard.load(std::memory_order_acquire)};
+	if (result == nullptr) {
+		void* memory{__libc_malloc(sizeof(Shard))};
+		if (memory != nullptr) {
+			Shard* allocated{new (memory) Shard{}};
+			if (shard.compare_exchange_strong(result, allocated, std::memory_order_acq_rel)) {
+				result = allocated;
+			} else {
+				allocated->~Shard();
+				__libc_free(allocated);
+			}
+		}
+	}
+	return result;
+}
+
+void LatencyHistogram::dump(OperationType operationType, std::size_t sizeClass) const noexcept
+{
+	std::array<std::uint64_t, nBuckets> buckets{};
+	std::uint64_t count{0};
+	std::uint64_t max{0};
+	for (std::atomic<Shard*> const& shard : shards) {
+		if (Shard const* allocated = shard.load(std::memory_order_acquire)) {
+			Histogram const& histogram{allocated->histograms[static_cast<std::size_t>(operationType)][sizeClass]};
+			for (std::size_t bucket = 0; bucket < nBuckets; ++bucket) {
+				const std::uint64_t n{histogram.buckets[bucket].load(std::memory_order_relaxed)};
+				buckets[bucket] += n;
+				count += n;
+			}
+			max = std::max(max, histogram.max.load(std::memory_order_relaxed));
+		}
+	}
+	if (count > 0) {
+		// Percentiles in per mille, reported as the upper bound of the bucket holding them, bounded by the maximum.
+		std::array<std::uint64_t, 3> perMille{500, 990, 999};
+		std::array<std::uint64_t, 3> percentiles{};
+		std::uint64_t cumulated{0};
+		std::size_t next{0};
+		for (std::size_t bucket = 0; bucket < nBuckets && next < perMille.size(); ++bucket) {
+			cumulated += buckets[bucket];
+			while (next < perMille.size() && cumulated * 1000 >= count * perMille[next]) {
+				percentiles[next++] = std::min(getBucketUpperBound(bucket), max);
+			}
+		}
+		const SizeRange range{getSizeClassRange(sizeClass)};
+		log(FormattingCallback{[&] {
+			return Message(
+				"{} [{}, {}]: {count: {}, p50: {}, p99: {}, p999: {}, max: {}}",
+				to_string(operationType),
+				range.first,
+				range.last,
+				count,
+				std::chrono::nanoseconds{percentiles[0]},
+				std::chrono::nanoseconds{percentiles[1]},
+				std::chrono::nanoseconds{percentiles[2]},
+				std::chrono::nanoseconds{max});
+		}});
+	}
+}
+
+} // namespace ArenaAllocator
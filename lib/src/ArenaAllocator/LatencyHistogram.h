@@ -0,0 +1,83 @@
+//
+// Copyright (C) 2021 Dr. Michael Steffens
+//
+// SPDX-License-Identifier:     BSL-1.0
+//
+
+
+#ifndef ArenaAllocator_LatencyHistogram_h_INCLUDED
+#define ArenaAllocator_LatencyHistogram_h_INCLUDED
+
+#include "ArenaAllocator/LogLinearBuckets.h"
+#include "ArenaAllocator/Logger.h"
+#include "ArenaAllocator/SizeRange.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace ArenaAllocator {
+
+// Aggregates timed operations into log-linear histograms per operation type and size class, dumping latency
+// percentiles rather than logging individual operations. Other log messages are written to the console.
+class LatencyHistogram : public Logger
+{
+public:
+	LatencyHistogram() noexcept;
+	LatencyHistogram(LatencyHistogram const&) = delete;
+	LatencyHistogram& operator=(LatencyHistogram const&) = delete;
+	~LatencyHistogram() noexcept override;
+
+	[[nodiscard]] bool isLevel(LogLevel level) const noexcept override;
+	void setLevel(LogLevel level) noexcept override;
+
+	void dump() const noexcept;
+
+	static constexpr char const* className{"LatencyHistogram"};
+
+	using Buckets = LogLinearBuckets<3>;
+	// Latencies of 2^(maxExponent + 1) nanoseconds and more fall into the last bucket.
+	static constexpr unsigned maxExponent{40};
+	static constexpr std::size_t nBuckets{Buckets::getBucket((std::uint64_t{1} << (maxExponent + 1)) - 1) + 1};
+	// Size class 0 holds operations without size, size classes 1 to 8 sizes up to 16, 64, ..., 65536 and above.
+	static constexpr std::size_t nSizeClasses{9};
+	static constexpr std::size_t nShards{8};
+
+	[[nodiscard]] static std::size_t getBucket(std::uint64_t nanoseconds) noexcept;
+	[[nodiscard]] static std::uint64_t getBucketUpperBound(std::size_t bucket) noexcept;
+	[[nodiscard]] static std::size_t getSizeClass(std::size_t size) noexcept;
+	[[nodiscard]] static SizeRange getSizeClassRange(std::size_t sizeClass) noexcept;
+
+protected:
+	void log(Formatter const& formatter) const noexcept override;
+	void log(std::chrono::nanoseconds duration, OperationType operationType, Formatter const& formatter) const noexcept override;
+	void log(LogLevel level, Formatter const& formatter) const noexcept override;
+	void log(std::chrono::nanoseconds duration,
+			 OperationType operationType,
+			 std::size_t size,
+			 Formatter const& formatter) const noexcept override;
+
+private:
+	static constexpr std::size_t nOperationTypes{static_cast<std::size_t>(OperationType::UNKNOWN)};
+
+	struct Histogram
+	{
+		std::array<std::atomic<std::uint64_t>, nBuckets> buckets;
+		std::atomic<std::uint64_t> max;
+	};
+
+	// Threads update the counters of the shard getThreadShard() assigns them to.
+	struct Shard
+	{
+		std::array<std::array<Histogram, nSizeClasses>, nOperationTypes> histograms;
+	};
+
+	Shard* getShard() const noexcept;
+	void dump(OperationType operationType, std::size_t sizeClass) const noexcept;
+
+	std::atomic<LogLevel> logLevel; // Set by the control thread
+	mutable std::array<std::atomic<Shard*>, nShards> shards;
+};
+
+} // namespace ArenaAllocator
+
+#endif // ArenaAllocator_LatencyHistogram_h_INCLUDED
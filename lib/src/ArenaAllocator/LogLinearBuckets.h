@@ -0,0 +1,82 @@
+//
+// Copyright (C) 2021 Dr. Michael Steffens
+//
+// SPDX-License-Identifier:     BSL-1.0
+//
+
+
+#ifndef ArenaAllocator_LogLinearBuckets_h_INCLUDED
+#define ArenaAllocator_LogLinearBuckets_h_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ArenaAllocator {
+
+// Values below 2^linearBits have a bucket of their own. Larger values fall into 2^subBucketBits linear sub buckets per
+// power of two, limiting the relative error to 1/2^subBucketBits. Requires subBucketBits <= linearBits < 64.
+constexpr std::size_t getLogLinearBucket(std::uint64_t value, unsigned subBucketBits, unsigned linearBits) noexcept
+{
+	std::size_t result{value};
+	if ((value >> linearBits) != 0) {
+		const unsigned exponent{63U - static_cast<unsigned>(__builtin_clzll(value))};
+		const std::size_t subBucket{(value >> (exponent - subBucketBits)) & ((std::size_t{1} << subBucketBits) - 1)};
+		result = (std::size_t{1} << linearBits) + (std::size_t{exponent - linearBits} << subBucketBits) + subBucket;
+	}
+	return result;
+}
+
+// Smallest value in bucket
+constexpr std::uint64_t getLogLinearLowerBound(std::size_t bucket, unsigned subBucketBits, unsigned linearBits) noexcept
+{
+	std::uint64_t result{bucket};
+	if ((bucket >> linearBits) != 0) {
+		const std::size_t index{bucket - (std::size_t{1} << linearBits)};
+		const unsigned shift{static_cast<unsigned>(index >> subBucketBits) + linearBits - subBucketBits};
+		const std::uint64_t subBucket{index & ((std::size_t{1} << subBucketBits) - 1)};
+		result = ((std::uint64_t{1} << subBucketBits) + subBucket) << shift;
+	}
+	return result;
+}
+
+// Largest value in bucket
+constexpr std::uint64_t getLogLinearUpperBound(std::size_t bucket, unsigned subBucketBits, unsigned linearBits) noexcept
+{
+	std::uint64_t result{bucket};
+	if ((bucket >> linearBits) != 0) {
+		const unsigned shift{static_cast<unsigned>((bucket - (std::size_t{1} << linearBits)) >> subBucketBits) + linearBits -
+							 subBucketBits};
+		result = getLogLinearLowerBound(bucket, subBucketBits, linearBits) + ((std::uint64_t{1} << shift) - 1);
+	}
+	return result;
+}
+
+// Log-linear buckets of 64 bit values with compile time parameters, linearLimit a power of two.
+template<unsigned subBucketBits, std::uint64_t linearLimit = std::uint64_t{1} << subBucketBits>
+struct LogLinearBuckets
+{
+	static constexpr unsigned linearBits{static_cast<unsigned>(__builtin_ctzll(linearLimit))};
+	static constexpr std::size_t nBuckets{linearLimit + (std::size_t{64 - linearBits} << subBucketBits)};
+
+	static_assert((linearLimit & (linearLimit - 1)) == 0, "linearLimit must be a power of two");
+	static_assert(subBucketBits <= linearBits && linearBits < 64, "sub buckets must not be finer than linear buckets");
+
+	[[nodiscard]] static constexpr std::size_t getBucket(std::uint64_t value) noexcept
+	{
+		return getLogLinearBucket(value, subBucketBits, linearBits);
+	}
+
+	[[nodiscard]] static constexpr std::uint64_t getLowerBound(std::size_t bucket) noexcept
+	{
+		return getLogLinearLowerBound(bucket, subBucketBits, linearBits);
+	}
+
+	[[nodiscard]] static constexpr std::uint64_t getUpperBound(std::size_t bucket) noexcept
+	{
+		return getLogLinearUpperBound(bucket, subBucketBits, linearBits);
+	}
+};
+
+} // namespace ArenaAllocator
+
+#endif // ArenaAllocator_LogLinearBuckets_h_INCLUDED
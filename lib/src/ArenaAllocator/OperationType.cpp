@@ -19,7 +19,7 @@ std::string_view to_string(OperationType operationType)
 		"realloc",
 		"reallocarray",
 		"posix_memalign",
-		"align_alloc",
+		"aligned_alloc",
 		"valloc",
 		"memalign",
 		"pvalloc",
@@ -4,15 +4,22 @@
 
 namespace ArenaAllocator {
 
-ParseConfiguration::ParseConfiguration(std::string_view str, std::optional<Configuration::PoolMapType>& pools) noexcept :
-	ParsePrimitives{str}, pools{pools}
+ParseConfiguration::ParseConfiguration(
+	std::string_view str,
+	std::optional<Configuration::PoolMapType>& pools,
+	Configuration::PoolGroupsType& groups) noexcept :
+	ParsePrimitives{str}, str{str}, pools{pools}, groups{groups}
 {
 }
 
 void ParseConfiguration::operator()(
 	std::optional<std::string_view>& className,
 	std::optional<LogLevel>& logLevel,
-	std::optional<std::string_view>& loggerName) noexcept
+	std::optional<std::string_view>& loggerName,
+	std::optional<Sampling>& sampling,
+	std::optional<Control>& control,
+	std::optional<Profile>& profile,
+	std::optional<Phase>& phase) noexcept
 {
 	if (parseDelimiter("{") != '{') {
 		raiseError("expected '{' at configuration string begin");
@@ -27,7 +34,7 @@ void ParseConfiguration::operator()(
 			if (pools.has_value()) {
 				raiseError("duplicate pools item");
 			}
-			parsePoolMap();
+			parsePoolMap(pools.emplace());
 		} else if (configItem == "class") {
 			if (parseDelimiter(":") == 0) {
 				raiseError("expected ':' after class item identifier");
@@ -35,7 +42,7 @@ void ParseConfiguration::operator()(
 			if (className.has_value()) {
 				raiseError("duplicate allocator class item");
 			}
-			className.emplace(parseIdentifier());
+			className.emplace(parseAllocatorClass());
 		} else if (configItem == "logLevel") {
 			if (parseDelimiter(":") == 0) {
 				raiseError("expected ':' after logLevel item identifier");
@@ -52,6 +59,46 @@ void ParseConfiguration::operator()(
 				raiseError("duplicate logger class item");
 			}
 			loggerName.emplace(parseIdentifier());
+		} else if (configItem == "sampling") {
+			if (parseDelimiter(":") == 0) {
+				raiseError("expected ':' after sampling item identifier");
+			}
+			if (sampling.has_value()) {
+				raiseError("duplicate sampling item");
+			}
+			sampling.emplace(parseSampling());
+		} else if (configItem == "control") {
+			if (parseDelimiter(":") == 0) {
+				raiseError("expected ':' after control item identifier");
+			}
+			if (control.has_value()) {
+				raiseError("duplicate control item");
+			}
+			control.emplace(parseControl());
+		} else if (configItem == "profile") {
+			if (parseDelimiter(":") == 0) {
+				raiseError("expected ':' after profile item identifier");
+			}
+			if (profile.has_value()) {
+				raiseError("duplicate profile item");
+			}
+			profile.emplace(parseProfile());
+		} else if (configItem == "phase") {
+			if (parseDelimiter(":") == 0) {
+				raiseError("expected ':' after phase item identifier");
+			}
+			if (phase.has_value()) {
+				raiseError("duplicate phase item");
+			}
+			phase.emplace(parsePhase());
+		} else if (configItem == "groups") {
+			if (parseDelimiter(":") == 0) {
+				raiseError("expected ':' after groups item identifier");
+			}
+			if (!groups.empty()) {
+				raiseError("duplicate groups item");
+			}
+			parseGroups();
 		} else {
 			raiseError("unexpected configuration item");
 		}
@@ -65,6 +112,32 @@ void ParseConfiguration::operator()(
 	}
 }
 
+std::string_view ParseConfiguration::parseAllocatorClass() noexcept
+{
+	// Allocator class with optional, nested delegate, e.g. SizeRangeStatistics(SegregatedFreeLists(PassThrough)). The
+	// chain is validated here but returned verbatim, to be resolved by the AllocatorFactory.
+	std::string_view outermost{parseIdentifier()};
+	std::string_view innermost{outermost};
+	std::size_t depth{0};
+	while (parseDelimiter("(") == '(') {
+		innermost = parseIdentifier();
+		++depth;
+	}
+	for (std::size_t i = 0; i < depth; ++i) {
+		if (parseDelimiter(")") != ')') {
+			raiseError("expected ')' at allocator delegate end");
+		}
+	}
+	const std::size_t begin{static_cast<std::size_t>(outermost.data() - str.data())};
+	std::size_t end{static_cast<std::size_t>(innermost.data() + innermost.size() - str.data())};
+	for (std::size_t closed = 0; closed < depth; ++end) {
+		if (str[end] == ')') {
+			++closed;
+		}
+	}
+	return str.substr(begin, end - begin);
+}
+
 LogLevel ParseConfiguration::parseLogLevel() noexcept
 {
 	LogLevel result{};
@@ -85,6 +158,116 @@ LogLevel ParseConfiguration::parseLogLevel() noexcept
 	return result;
 }
 
+Sampling ParseConfiguration::parseSampling() noexcept
+{
+	Sampling result{};
+	if (parseDelimiter("{") != '{') {
+		raiseError("expected '{' at sampling configuration begin");
+	}
+	std::string_view mode{parseIdentifier()};
+	if (mode == "rate") {
+		result.mode = Sampling::Mode::RATE;
+	} else if (mode == "interval") {
+		result.mode = Sampling::Mode::INTERVAL;
+	} else {
+		raiseError("invalid sampling mode");
+	}
+	if (parseDelimiter(":") != ':') {
+		raiseError("expected ':' after sampling mode");
+	}
+	if ((result.period = parse<std::size_t>()) == 0) {
+		raiseError("sampling period must be positive");
+	}
+	if (parseDelimiter("}") != '}') {
+		raiseError("expected '}' at sampling configuration end");
+	}
+	return result;
+}
+
+Control ParseConfiguration::parseControl() noexcept
+{
+	Control result{0, false, false};
+	if (parseDelimiter("{") != '{') {
+		raiseError("expected '{' at control configuration begin");
+	}
+	char delimiter{parseDelimiter("}")};
+	while (delimiter != '}') {
+		std::string_view channel{parseIdentifier()};
+		if (parseDelimiter(":") != ':') {
+			raiseError("expected ':' after control channel");
+		}
+		if (channel == "signal") {
+			if ((result.signal = parse<int>()) <= 0) {
+				raiseError("control signal must be positive");
+			}
+		} else if (channel == "socket") {
+			result.socket = parse<int>() != 0;
+		} else if (channel == "page") {
+			result.page = parse<int>() != 0;
+		} else {
+			raiseError("invalid control channel");
+		}
+		if ((delimiter = parseDelimiter(",}")) == 0) {
+			raiseError("expected ',' control channel delimiter");
+		}
+	}
+	return result;
+}
+
+Profile ParseConfiguration::parseProfile() noexcept
+{
+	Profile result{false, false};
+	if (parseDelimiter("{") != '{') {
+		raiseError("expected '{' at profile configuration begin");
+	}
+	char delimiter{parseDelimiter("}")};
+	while (delimiter != '}') {
+		std::string_view aspect{parseIdentifier()};
+		if (parseDelimiter(":") != ':') {
+			raiseError("expected ':' after profile aspect");
+		}
+		if (aspect == "sizes") {
+			result.sizes = parse<int>() != 0;
+		} else if (aspect == "threads") {
+			result.threads = parse<int>() != 0;
+		} else {
+			raiseError("invalid profile aspect");
+		}
+		if ((delimiter = parseDelimiter(",}")) == 0) {
+			raiseError("expected ',' profile aspect delimiter");
+		}
+	}
+	return result;
+}
+
+Phase ParseConfiguration::parsePhase() noexcept
+{
+	Phase result{0, 0};
+	if (parseDelimiter("{") != '{') {
+		raiseError("expected '{' at phase configuration begin");
+	}
+	char delimiter{parseDelimiter("}")};
+	while (delimiter != '}') {
+		std::string_view trigger{parseIdentifier()};
+		if (parseDelimiter(":") != ':') {
+			raiseError("expected ':' after phase trigger");
+		}
+		if (trigger == "signal") {
+			if ((result.signal = parse<int>()) <= 0) {
+				raiseError("phase signal must be positive");
+			}
+		} else if (trigger == "seconds") {
+			result.seconds = parse<unsigned>();
+		} else {
+			raiseError("invalid phase trigger");
+		}
+		if ((delimiter = parseDelimiter(",}")) == 0) {
+			raiseError("expected ',' phase trigger delimiter");
+		}
+	}
+	return result;
+}
+
 SizeRange ParseConfiguration::parseSizeRange() noexcept
 {
 	SizeRange result{};
@@ -106,29 +289,89 @@ SizeRange ParseConfiguration::parseSizeRange() noexcept
 	return result;
 }
 
-void ParseConfiguration::parsePoolMap() noexcept
+void ParseConfiguration::parsePoolMap(Configuration::PoolMapType& poolMap) noexcept
 {
-	pools.emplace();
 	if (parseDelimiter("{") != '{') {
 		raiseError("expected '{' at pool configuration begin");
 	}
 	char delimiter{parseDelimiter("}")};
 	while (delimiter != '}') {
-		parsePool();
+		parsePool(poolMap);
 		if ((delimiter = parseDelimiter(",}")) == 0) {
 			raiseError("expected ',' pool map element delimiter");
 		}
 	}
 }
 
-void ParseConfiguration::parsePool() noexcept
+void ParseConfiguration::parseGroups() noexcept
+{
+	if (parseDelimiter("{") != '{') {
+		raiseError("expected '{' at groups configuration begin");
+	}
+	char delimiter{parseDelimiter("}")};
+	while (delimiter != '}') {
+		parseGroup();
+		if ((delimiter = parseDelimiter(",}")) == 0) {
+			raiseError("expected ',' group delimiter");
+		}
+	}
+}
+
+void ParseConfiguration::parseGroup() noexcept
+{
+	// Group name followed by its items, e.g. rt:{threads:rt,pools:{[1,64]:128}}
+	std::string_view name{parseIdentifier()};
+	if (name == "default") {
+		raiseError("group name default is reserved for the pools item");
+	}
+	for (Configuration::PoolGroup const& group : groups) {
+		if (group.name == name) {
+			raiseError("duplicate group name");
+		}
+	}
+	if (parseDelimiter(":") != ':') {
+		raiseError("expected ':' after group name");
+	}
+	if (parseDelimiter("{") != '{') {
+		raiseError("expected '{' at group configuration begin");
+	}
+	Configuration::PoolGroup& group{groups.emplace_back()};
+	group.name = name;
+	bool hasPools{false};
+	char delimiter{parseDelimiter("}")};
+	while (delimiter != '}') {
+		std::string_view groupItem{parseIdentifier()};
+		if (parseDelimiter(":") != ':') {
+			raiseError("expected ':' after group item identifier");
+		}
+		if (groupItem == "threads") {
+			group.threadPrefix = parseIdentifier();
+		} else if (groupItem == "pools") {
+			if (hasPools) {
+				raiseError("duplicate group pools item");
+			}
+			parsePoolMap(group.pools);
+			hasPools = true;
+		} else {
+			raiseError("invalid group item");
+		}
+		if ((delimiter = parseDelimiter(",}")) == 0) {
+			raiseError("expected ',' group item delimiter");
+		}
+	}
+	if (!hasPools) {
+		raiseError("missing group pools item");
+	}
+}
+
+void ParseConfiguration::parsePool(Configuration::PoolMapType& poolMap) noexcept
 {
 	const SizeRange range{parseSizeRange()};
 	if (parseDelimiter(":") != ':') {
 		raiseError("expected ':' at pool configuration begin");
 	}
 	std::size_t nChunks{parse<std::size_t>()};
-	if (!pools.value().emplace(range, nChunks)) {
+	if (!poolMap.emplace(range, nChunks)) {
 		raiseError("expected disjunct pool size ranges");
 	}
 }
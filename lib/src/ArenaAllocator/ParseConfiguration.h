@@ -9,7 +9,11 @@
 #define ArenaAllocator_ParseConfiguration_h_INCLUDED
 
 #include "ArenaAllocator/Configuration.h"
+#include "ArenaAllocator/Control.h"
 #include "ArenaAllocator/LogLevel.h"
+#include "ArenaAllocator/Phase.h"
+#include "ArenaAllocator/Profile.h"
+#include "ArenaAllocator/Sampling.h"
 #include "ArenaAllocator/SizeRange.h"
 #include <Static/ParsePrimitives.h>
 #include <optional>
@@ -19,23 +23,39 @@ namespace ArenaAllocator {
 class ParseConfiguration : public Static::ParsePrimitives
 {
 public:
-	ParseConfiguration(std::string_view str, std::optional<Configuration::PoolMapType>& pools) noexcept;
+	ParseConfiguration(
+		std::string_view str,
+		std::optional<Configuration::PoolMapType>& pools,
+		Configuration::PoolGroupsType& groups) noexcept;
 	~ParseConfiguration() noexcept override = default;
 
 	void operator()(
 		std::optional<std::string_view>& className,
 		std::optional<LogLevel>& logLevel,
-		std::optional<std::string_view>& loggerName) noexcept;
+		std::optional<std::string_view>& loggerName,
+		std::optional<Sampling>& sampling,
+		std::optional<Control>& control,
+		std::optional<Profile>& profile,
+		std::optional<Phase>& phase) noexcept;
 
 private:
+	std::string_view parseAllocatorClass() noexcept;
 	LogLevel parseLogLevel() noexcept;
+	Sampling parseSampling() noexcept;
+	Control parseControl() noexcept;
+	Profile parseProfile() noexcept;
+	Phase parsePhase() noexcept;
 	SizeRange parseSizeRange() noexcept;
-	void parsePool() noexcept;
-	void parsePoolMap() noexcept;
+	void parsePool(Configuration::PoolMapType& poolMap) noexcept;
+	void parsePoolMap(Configuration::PoolMapType& poolMap) noexcept;
+	void parseGroup() noexcept;
+	void parseGroups() noexcept;
 	void parseConfigStr() noexcept;
 	[[noreturn]] void raiseError(std::string_view message) override;
 
+	const std::string_view str;
 	std::optional<Configuration::PoolMapType>& pools;
+	Configuration::PoolGroupsType& groups;
 };
 
 } // namespace ArenaAllocator
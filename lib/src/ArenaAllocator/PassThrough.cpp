@@ -8,6 +8,7 @@
 #include "ArenaAllocator/PassThrough.h"
 #include "ArenaAllocator/Timer.h"
 #include <cerrno>
+#include <malloc.h>
 
 extern "C" void* __libc_malloc(std::size_t size);
 extern "C" void __libc_free(void* ptr);
@@ -38,7 +39,7 @@ void* PassThrough::malloc(std::size_t size) noexcept
 	if (log.isLevel(LogLevel::TRACE)) {
 		Timer timer;
 		result = __libc_malloc(size);
-		log(timer.getNanoseconds(), OperationType::MALLOC, [&] {
+		log(timer.getNanoseconds(), OperationType::MALLOC, size, [&] {
 			return Message("{}::malloc({}) -> {}", className, size, result);
 		});
 	} else {
@@ -51,9 +52,10 @@ void PassThrough::free(void* ptr) noexcept
 {
 	void* result{nullptr};
 	if (log.isLevel(LogLevel::TRACE)) {
+		const std::size_t size{::malloc_usable_size(ptr)};
 		Timer timer;
 		__libc_free(ptr);
-		log(timer.getNanoseconds(), OperationType::FREE, [&] { return Message("{}::free({})", className, ptr); });
+		log(timer.getNanoseconds(), OperationType::FREE, size, [&] { return Message("{}::free({})", className, ptr); });
 	} else {
 		__libc_free(ptr);
 	}
@@ -65,7 +67,7 @@ void* PassThrough::calloc(std::size_t nmemb, std::size_t size) noexcept
 	if (log.isLevel(LogLevel::TRACE)) {
 		Timer timer;
 		result = __libc_calloc(nmemb, size);
-		log(timer.getNanoseconds(), OperationType::CALLOC, [&] {
+		log(timer.getNanoseconds(), OperationType::CALLOC, nmemb * size, [&] {
 			return Message("{}::calloc({}, {}) -> {}", className, nmemb, size, result);
 		});
 	} else {
@@ -80,7 +82,7 @@ void* PassThrough::realloc(void* ptr, std::size_t size) noexcept
 	if (log.isLevel(LogLevel::TRACE)) {
 		Timer timer;
 		result = __libc_realloc(ptr, size);
-		log(timer.getNanoseconds(), OperationType::REALLOC, [&] {
+		log(timer.getNanoseconds(), OperationType::REALLOC, size, [&] {
 			return Message("{}::realloc({}, {}) -> {}", className, ptr, size, result);
 		});
 	} else {
@@ -113,7 +115,7 @@ void* PassThrough::reallocarray(void* ptr, std::size_t nmemb, std::size_t size)
 	if (log.isLevel(LogLevel::TRACE)) {
 		Timer timer;
 		result = reallocarrayUsingLibcRealloc(ptr, nmemb, size);
-		log(timer.getNanoseconds(), OperationType::REALLOCARRAY, [&] {
+		log(timer.getNanoseconds(), OperationType::REALLOCARRAY, nmemb * size, [&] {
 			return Message("{}::reallocarray({}, {}, {}) -> {}", className, ptr, nmemb, size, result);
 		});
 	} else {
@@ -151,8 +153,8 @@ int PassThrough::posix_memalign(void** memptr, std::size_t alignment, std::size_
 	if (log.isLevel(LogLevel::TRACE)) {
 		Timer timer;
 		result = posixMemalignUsingLibcMemalign(memptr, alignment, size);
-		log(timer.getNanoseconds(), OperationType::POSIX_MEMALIGN, [&] {
-			return Message("{}::posix_memalign(&{}, {} {}) -> %d", className, *memptr, alignment, size, result);
+		log(timer.getNanoseconds(), OperationType::POSIX_MEMALIGN, size, [&] {
+			return Message("{}::posix_memalign(&{}, {}, {}) -> {}", className, *memptr, alignment, size, result);
 		});
 	} else {
 		result = posixMemalignUsingLibcMemalign(memptr, alignment, size);
@@ -176,8 +178,8 @@ void* PassThrough::aligned_alloc(std::size_t alignment, std::size_t size) noexce
 	if (log.isLevel(LogLevel::TRACE)) {
 		Timer timer;
 		result = alignedAllocUsingLibcMemalign(alignment, size);
-		log(timer.getNanoseconds(), OperationType::ALIGNED_ALLOC, [&] {
-			return Message("{}::aligned_alloc({} {}) -> {}", className, alignment, size, result);
+		log(timer.getNanoseconds(), OperationType::ALIGNED_ALLOC, size, [&] {
+			return Message("{}::aligned_alloc({}, {}) -> {}", className, alignment, size, result);
 		});
 	} else {
 		result = alignedAllocUsingLibcMemalign(alignment, size);
@@ -191,7 +193,9 @@ void* PassThrough::valloc(std::size_t size) noexcept
 	if (log.isLevel(LogLevel::TRACE)) {
 		Timer timer;
 		result = __libc_valloc(size);
-		log(timer.getNanoseconds(), OperationType::VALLOC, [&] { return Message("PassThrough::valloc({}) -> {}", size, result); });
+		log(timer.getNanoseconds(), OperationType::VALLOC, size, [&] {
+			return Message("{}::valloc({}) -> {}", className, size, result);
+		});
 	} else {
 		result = __libc_valloc(size);
 	}
@@ -204,8 +208,8 @@ void* PassThrough::memalign(std::size_t alignment, std::size_t size) noexcept
 	if (log.isLevel(LogLevel::TRACE)) {
 		Timer timer;
 		result = __libc_memalign(alignment, size);
-		log(timer.getNanoseconds(), OperationType::MEMALIGN, [&] {
-			return Message("{}::memalign({} {}) -> {}", className, alignment, size, result);
+		log(timer.getNanoseconds(), OperationType::MEMALIGN, size, [&] {
+			return Message("{}::memalign({}, {}) -> {}", className, alignment, size, result);
 		});
 	} else {
 		result = __libc_memalign(alignment, size);
@@ -219,7 +223,7 @@ void* PassThrough::pvalloc(std::size_t size) noexcept
 	if (log.isLevel(LogLevel::TRACE)) {
 		Timer timer;
 		result = __libc_pvalloc(size);
-		log(timer.getNanoseconds(), OperationType::PVALLOC, [&] {
+		log(timer.getNanoseconds(), OperationType::PVALLOC, size, [&] {
 			return Message("{}::pvalloc({}) -> {}", className, size, result);
 		});
 	} else {
@@ -228,7 +232,7 @@ void* PassThrough::pvalloc(std::size_t size) noexcept
 	return result;
 }
 
-void PassThrough::dump() const noexcept
+void PassThrough::dump(bool) const noexcept
 {
 	// Nothing to do.
 }
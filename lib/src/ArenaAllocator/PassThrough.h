@@ -33,7 +33,7 @@ public:
 	void* valloc(std::size_t size) noexcept override;
 	void* memalign(std::size_t alignment, std::size_t size) noexcept override;
 	void* pvalloc(std::size_t size) noexcept override;
-	void dump() const noexcept override;
+	void dump(bool force) const noexcept override;
 
 	static constexpr char const* className{"PassThrough"};
 
@@ -0,0 +1,166 @@
+//
+// Copyright (C) 2021 Dr. Michael Steffens
+//
+// SPDX-License-Identifier:     BSL-1.0
+//
+
+
+#include "ArenaAllocator/PhaseSwitch.h"
+#include <chrono>
+#include <csignal>
+
+namespace ArenaAllocator {
+
+namespace {
+
+// Phase flag of the instance handling the phase signal, set by the signal handler
+std::atomic<std::atomic<bool>*> signalledArena{nullptr};
+
+void handlePhaseSignal(int) noexcept
+{
+	std::atomic<bool>* arena{signalledArena.load(std::memory_order_acquire)};
+	if (arena != nullptr) {
+		arena->store(true, std::memory_order_release);
+	}
+}
+
+} // namespace
+
+PhaseSwitch::PhaseSwitch(
+	Configuration const& configuration, Allocator& startup, Allocator& delegate, Logger const& log, Clock now) noexcept :
+	startup{startup},
+	delegate{delegate},
+	log{log},
+	now{now},
+	signal{configuration.getPhase().signal},
+	seconds{configuration.getPhase().seconds},
+	start{seconds > 0 ? now() : 0},
+	arena{false},
+	startupAllocations{0}
+{
+	log(LogLevel::DEBUG, [&] {
+		return Message(
+			"{}::{}(Configuration const&, Allocator&, Allocator&, Logger const&, Clock) -> {this:{}, signal:{}, seconds:{}}",
+			className,
+			className,
+			this,
+			signal,
+			seconds);
+	});
+	if (signal != 0) {
+		signalledArena.store(&arena, std::memory_order_release);
+		struct ::sigaction action{};
+		action.sa_handler = handlePhaseSignal;
+		action.sa_flags = SA_RESTART;
+		::sigemptyset(&action.sa_mask);
+		if (::sigaction(signal, &action, nullptr) != 0) {
+			log(LogLevel::ERROR, [&] { return Message("{} failed to handle signal {}", className, signal); });
+		}
+	}
+}
+
+PhaseSwitch::~PhaseSwitch() noexcept
+{
+	std::atomic<bool>* expected{&arena};
+	signalledArena.compare_exchange_strong(expected, nullptr, std::memory_order_acq_rel);
+	log(LogLevel::DEBUG, [&] { return Message("{}::~{}(this:{})", className, className, this); });
+}
+
+void* PhaseSwitch::malloc(std::size_t size) noexcept
+{
+	return getAllocator().malloc(size);
+}
+
+void PhaseSwitch::free(void* ptr) noexcept
+{
+	delegate.free(ptr);
+}
+
+void* PhaseSwitch::calloc(std::size_t nmemb, std::size_t size) noexcept
+{
+	return getAllocator().calloc(nmemb, size);
+}
+
+void* PhaseSwitch::realloc(void* ptr, std::size_t size) noexcept
+{
+	// Pointers of either phase stay with the allocator they came from, only new ones depend on the phase.
+	return ptr != nullptr ? delegate.realloc(ptr, size) : getAllocator().realloc(nullptr, size);
+}
+
+void* PhaseSwitch::reallocarray(void* ptr, std::size_t nmemb, std::size_t size) noexcept
+{
+	return ptr != nullptr ? delegate.reallocarray(ptr, nmemb, size) : getAllocator().reallocarray(nullptr, nmemb, size);
+}
+
+int PhaseSwitch::posix_memalign(void** memptr, std::size_t alignment, std::size_t size) noexcept
+{
+	return getAllocator().posix_memalign(memptr, alignment, size);
+}
+
+void* PhaseSwitch::aligned_alloc(std::size_t alignment, std::size_t size) noexcept
+{
+	return getAllocator().aligned_alloc(alignment, size);
+}
+
+void* PhaseSwitch::valloc(std::size_t size) noexcept
+{
+	return getAllocator().valloc(size);
+}
+
+void* PhaseSwitch::memalign(std::size_t alignment, std::size_t size) noexcept
+{
+	return getAllocator().memalign(alignment, size);
+}
+
+void* PhaseSwitch::pvalloc(std::size_t size) noexcept
+{
+	return getAllocator().pvalloc(size);
+}
+
+std::size_t PhaseSwitch::getCounters(
+	PoolCounters* poolCounters, std::size_t capacity, DelegateCounters* delegateCounters) const noexcept
+{
+	return delegate.getCounters(poolCounters, capacity, delegateCounters);
+}
+
+bool PhaseSwitch::joinGroup(std::string_view name) noexcept
+{
+	return delegate.joinGroup(name);
+}
+
+bool PhaseSwitch::switchPhase() noexcept
+{
+	const bool result{!arena.exchange(true, std::memory_order_acq_rel)};
+	log(LogLevel::DEBUG, [&] { return Message("{}::switchPhase() -> {}", className, static_cast<int>(result)); });
+	return result;
+}
+
+void PhaseSwitch::dump(bool force) const noexcept
+{
+	if (force || log.isLevel(LogLevel::INFO)) {
+		log([&] {
+			return Message(
+				"{}: {phase:{}, startupAllocations:{}}",
+				className,
+				arena.load(std::memory_order_acquire) ? "arena" : "startup",
+				startupAllocations.load(std::memory_order_relaxed));
+		});
+	}
+	delegate.dump(force);
+}
+
+Allocator& PhaseSwitch::getAllocator() noexcept
+{
+	Allocator* result{&delegate};
+	if (!arena.load(std::memory_order_acquire)) {
+		if (seconds > 0 && Timer::getElapsed(start, now()) >= std::chrono::seconds{seconds}) {
+			arena.store(true, std::memory_order_release);
+		} else {
+			startupAllocations.fetch_add(1, std::memory_order_relaxed);
+			result = &startup;
+		}
+	}
+	return *result;
+}
+
+} // namespace ArenaAllocator
@@ -0,0 +1,78 @@
+//
+// Copyright (C) 2021 Dr. Michael Steffens
+//
+// SPDX-License-Identifier:     BSL-1.0
+//
+
+
+#ifndef ArenaAllocator_PhaseSwitch_h_INCLUDED
+#define ArenaAllocator_PhaseSwitch_h_INCLUDED
+
+#include "ArenaAllocator/Allocator.h"
+#include "ArenaAllocator/Configuration.h"
+#include "ArenaAllocator/Logger.h"
+#include "ArenaAllocator/Timer.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace ArenaAllocator {
+
+// Passes allocations through to the startup allocator until a trigger of configuration item phase fires, or
+// arenaAllocatorSwitchPhase is called, and serves them from its delegate from then on. This keeps one-off startup
+// allocations out of the delegate's pools. Deallocations and reallocations always go to the delegate, which must fall back
+// to the startup allocator for pointers it does not own. InternalAllocatorFactory accepts SegregatedFreeLists(PassThrough)
+// and PassThrough only.
+class PhaseSwitch : public Allocator
+{
+public:
+	// Timestamps in Timer units, injectable for testing the seconds trigger.
+	using Clock = std::uint64_t (*)() noexcept;
+
+	PhaseSwitch(
+		Configuration const& configuration,
+		Allocator& startup,
+		Allocator& delegate,
+		Logger const& log,
+		Clock now = Timer::now) noexcept;
+	PhaseSwitch(PhaseSwitch const&) = delete;
+	void operator=(PhaseSwitch const&) = delete;
+	~PhaseSwitch() noexcept override;
+
+	void* malloc(std::size_t size) noexcept override;
+	void free(void* ptr) noexcept override;
+	void* calloc(std::size_t nmemb, std::size_t size) noexcept override;
+	void* realloc(void* ptr, std::size_t size) noexcept override;
+	void* reallocarray(void* ptr, std::size_t nmemb, std::size_t size) noexcept override;
+	int posix_memalign(void** memptr, std::size_t alignment, std::size_t size) noexcept override;
+	void* aligned_alloc(std::size_t alignment, std::size_t size) noexcept override;
+	void* valloc(std::size_t size) noexcept override;
+	void* memalign(std::size_t alignment, std::size_t size) noexcept override;
+	void* pvalloc(std::size_t size) noexcept override;
+	void dump(bool force) const noexcept override;
+	std::size_t getCounters(
+		PoolCounters* poolCounters, std::size_t capacity, DelegateCounters* delegateCounters) const noexcept override;
+	bool joinGroup(std::string_view name) noexcept override;
+	bool switchPhase() noexcept override;
+
+	static constexpr char const* className{"PhaseSwitch"};
+
+private:
+	// Allocator serving the next allocation, switching phase if the seconds trigger has expired meanwhile.
+	Allocator& getAllocator() noexcept;
+
+	Allocator& startup;
+	Allocator& delegate;
+	Logger const& log;
+	const Clock now;
+	const int signal;
+	const std::uint64_t seconds;
+	const std::uint64_t start; // Timestamp taken only with a seconds trigger, sparing clock calibration otherwise
+	std::atomic<bool> arena;
+	std::atomic<std::size_t> startupAllocations;
+};
+
+} // namespace ArenaAllocator
+
+#endif // ArenaAllocator_PhaseSwitch_h_INCLUDED
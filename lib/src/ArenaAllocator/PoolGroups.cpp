@@ -0,0 +1,97 @@
+//
+// Copyright (C) 2021 Dr. Michael Steffens
+//
+// SPDX-License-Identifier:     BSL-1.0
+//
+
+
+#include "ArenaAllocator/PoolGroups.h"
+#include <algorithm>
+#include <array>
+#include <pthread.h>
+
+namespace ArenaAllocator {
+
+namespace {
+
+// Group of the calling thread, valid for the instance it was assigned by only. Initial exec TLS model, see ThreadShard.h.
+struct ThreadGroup
+{
+	void const* owner;
+	PoolMap<FreeList>* pools;
+	bool joined; // By API, no longer matched by name
+	std::uint32_t untilNameCheck;
+	std::uint32_t nameCheckInterval;
+};
+
+thread_local ThreadGroup threadGroup __attribute__((tls_model("initial-exec")));
+
+} // namespace
+
+PoolGroups::Group::Group(Configuration::PoolGroup const& configuration, Logger const& log) noexcept :
+	name{configuration.name}, threadPrefix{configuration.threadPrefix}, pools{configuration.pools, log}
+{
+}
+
+PoolGroups::PoolGroups(Configuration const& configuration, PoolMap<FreeList>& defaultPools, Logger const& log) noexcept :
+	defaultPools{defaultPools}, log{log}
+{
+	for (Configuration::PoolGroup const& group : configuration.getGroups()) {
+		groups.emplace_back(group, log);
+	}
+}
+
+bool PoolGroups::join(std::string_view name) noexcept
+{
+	PoolMap<FreeList>* pools{name == defaultGroupName ? &defaultPools : nullptr};
+	for (Group& group : groups) {
+		if (group.name == name) {
+			pools = &group.pools;
+		}
+	}
+	if (pools != nullptr) {
+		threadGroup = ThreadGroup{this, pools, true, 0, 0};
+	}
+	log(LogLevel::DEBUG, [&] { return Message("PoolGroups::join({}) -> {}", name, static_cast<int>(pools != nullptr)); });
+	return pools != nullptr;
+}
+
+PoolMap<FreeList>& PoolGroups::getThreadPools() noexcept
+{
+	if (threadGroup.owner != this) {
+		threadGroup = ThreadGroup{this, &defaultPools, false, 1, 1};
+	}
+	// Threads are commonly named after their first allocation, so the default group keeps checking, backing off.
+	if (!threadGroup.joined && threadGroup.pools == &defaultPools && --threadGroup.untilNameCheck == 0) {
+		threadGroup.pools = &getPoolsByThreadName();
+		threadGroup.nameCheckInterval = std::min(threadGroup.nameCheckInterval * 2, maxNameCheckInterval);
+		threadGroup.untilNameCheck = threadGroup.nameCheckInterval;
+	}
+	return *threadGroup.pools;
+}
+
+PoolMap<FreeList>& PoolGroups::getPoolsByThreadName() noexcept
+{
+	PoolMap<FreeList>* result{&defaultPools};
+	std::array<char, 16> name{};
+	if (::pthread_getname_np(::pthread_self(), name.data(), name.size()) == 0) {
+		const std::string_view threadName{name.data()};
+		for (Group& group : groups) {
+			if (result == &defaultPools && !group.threadPrefix.empty() &&
+				threadName.substr(0, group.threadPrefix.size()) == group.threadPrefix) {
+				result = &group.pools;
+			}
+		}
+	}
+	return *result;
+}
+
+void PoolGroups::dump() const noexcept
+{
+	for (Group const& group : groups) {
+		log([&] { return Message("PoolGroup {}: {threads: {}}", group.name, group.threadPrefix); });
+		group.pools.dump();
+	}
+}
+
+} // namespace ArenaAllocator
@@ -0,0 +1,86 @@
+//
+// Copyright (C) 2021 Dr. Michael Steffens
+//
+// SPDX-License-Identifier:     BSL-1.0
+//
+
+
+#ifndef ArenaAllocator_PoolGroups_h_INCLUDED
+#define ArenaAllocator_PoolGroups_h_INCLUDED
+
+#include "ArenaAllocator/Configuration.h"
+#include "ArenaAllocator/FreeList.h"
+#include "ArenaAllocator/Logger.h"
+#include "ArenaAllocator/PassThroughCXXAllocator.h"
+#include "ArenaAllocator/PoolMap.h"
+#include <cstdint>
+#include <list>
+#include <string_view>
+
+namespace ArenaAllocator {
+
+// Pool maps of the configured thread groups, along with the default pools serving all other threads. Threads join a group
+// by name prefix, or explicitly by join(). Chunks return to the pool they were allocated from, whichever thread frees.
+class PoolGroups
+{
+public:
+	PoolGroups(Configuration const& configuration, PoolMap<FreeList>& defaultPools, Logger const& log) noexcept;
+	PoolGroups(PoolGroups const&) = delete;
+	PoolGroups& operator=(PoolGroups const&) = delete;
+	~PoolGroups() noexcept = default;
+
+	// Pools of the calling thread's group
+	PoolMap<FreeList>& getPools() noexcept
+	{
+		return groups.empty() ? defaultPools : getThreadPools();
+	}
+
+	// The calling thread leaves matching by name and joins the group given, or the default pools by defaultGroupName.
+	// Returns false if there is no such group.
+	bool join(std::string_view name) noexcept;
+
+	template<typename F>
+	void forEachPoolMap(F f) noexcept
+	{
+		f(defaultPools);
+		for (Group& group : groups) {
+			f(group.pools);
+		}
+	}
+
+	template<typename F>
+	void forEachPoolMap(F f) const noexcept
+	{
+		f(static_cast<PoolMap<FreeList> const&>(defaultPools));
+		for (Group const& group : groups) {
+			f(group.pools);
+		}
+	}
+
+	void dump() const noexcept;
+
+	static constexpr std::string_view defaultGroupName{"default"};
+	// Threads of the default group look up their name again after 1, 2, 4, ... allocations, at most this many.
+	static constexpr std::uint32_t maxNameCheckInterval{4096};
+
+private:
+	struct Group
+	{
+		Group(Configuration::PoolGroup const& configuration, Logger const& log) noexcept;
+
+		const std::string_view name;
+		const std::string_view threadPrefix;
+		PoolMap<FreeList> pools;
+	};
+
+	PoolMap<FreeList>& getThreadPools() noexcept;
+	PoolMap<FreeList>& getPoolsByThreadName() noexcept;
+
+	PoolMap<FreeList>& defaultPools;
+	Logger const& log;
+	std::list<Group, PassThroughCXXAllocator<Group>> groups;
+};
+
+} // namespace ArenaAllocator
+
+#endif // ArenaAllocator_PoolGroups_h_INCLUDED
@@ -13,11 +13,19 @@
 namespace ArenaAllocator {
 
 template<typename T>
-PoolMap<T>::PoolMap(Configuration const& configuration, Logger const& log) noexcept : log{log}
+PoolMap<T>::PoolMap(Configuration const& configuration, Logger const& log) noexcept :
+	PoolMap{configuration.getPools(), log}
 {
-	for (Configuration::PoolMapType::value_type const& poolConfiguration : configuration.getPools()) {
+}
+
+template<typename T>
+PoolMap<T>::PoolMap(Configuration::PoolMapType const& poolMap, Logger const& log) noexcept :
+	log{log}, builtinPools{}, builtin{false}
+{
+	for (Configuration::PoolMapType::value_type const& poolConfiguration : poolMap) {
 		insert(poolConfiguration.first, poolConfiguration.second);
 	}
+	indexBuiltinPools();
 }
 
 template<typename T>
@@ -31,10 +39,31 @@ void PoolMap<T>::insert(SizeRange const& range, std::size_t nChunks) noexcept
 	}
 }
 
+template<typename T>
+void PoolMap<T>::indexBuiltinPools() noexcept
+{
+	if (aggregate.size() == BuiltinPools::size && BuiltinPools::size > 0) {
+		builtin = true;
+		std::size_t index{0};
+		for (typename AggregateType::value_type& element : aggregate) {
+			SizeRange const& range{BuiltinConfigurationTables::pools[index].range};
+			builtin = builtin && element.first.first == range.first && element.first.last == range.last;
+			builtinPools[index++] = &element.second;
+		}
+	}
+}
+
 template<typename T>
 T* PoolMap<T>::at(std::size_t chunkSize) noexcept
 {
-	return aggregate.at(chunkSize);
+	T* result{nullptr};
+	if (BuiltinPools::size > 0 && builtin) {
+		const std::size_t index{BuiltinPools::getIndex(chunkSize)};
+		result = index < BuiltinPools::size ? builtinPools[index] : nullptr;
+	} else {
+		result = aggregate.at(chunkSize);
+	}
+	return result;
 }
 
 template<typename T>
@@ -8,11 +8,13 @@
 #ifndef ArenaAllocator_PoolMap_h_INCLUDED
 #define ArenaAllocator_PoolMap_h_INCLUDED
 
+#include "ArenaAllocator/BuiltinConfiguration.h"
 #include "ArenaAllocator/Configuration.h"
 #include "ArenaAllocator/FreeList.h"
 #include "ArenaAllocator/Logger.h"
 #include "ArenaAllocator/PassThroughCXXAllocator.h"
 #include "ArenaAllocator/SizeRangeMap.h"
+#include <array>
 
 namespace ArenaAllocator {
 
@@ -21,6 +23,7 @@ class PoolMap
 {
 public:
 	PoolMap(Configuration const& configuration, Logger const& log) noexcept;
+	PoolMap(Configuration::PoolMapType const& poolMap, Logger const& log) noexcept;
 
 	T* at(std::size_t chunkSize) noexcept;
 
@@ -42,15 +45,41 @@ public:
 		}
 	}
 
+	[[nodiscard]] std::size_t size() const noexcept
+	{
+		return aggregate.size();
+	}
+
+	template<typename F>
+	void forEachPool(F f) noexcept
+	{
+		for (typename AggregateType::value_type& element : aggregate) {
+			f(element.first, element.second);
+		}
+	}
+
+	template<typename F>
+	void forEachPool(F f) const noexcept
+	{
+		for (typename AggregateType::value_type const& element : aggregate) {
+			f(element.first, element.second);
+		}
+	}
+
 	void dump() const noexcept;
 
 private:
 	using AggregateType = SizeRangeMap<T>;
 
 	void insert(SizeRange const& range, std::size_t nChunks) noexcept;
+	void indexBuiltinPools() noexcept;
 
 	AggregateType aggregate;
 	Logger const& log;
+	// Pools in builtin configuration order, if the pools configured are exactly the builtin ones. Lookup then resolves
+	// by BuiltinPools::getIndex rather than by map search.
+	std::array<T*, BuiltinPools::size> builtinPools;
+	bool builtin;
 };
 
 } // namespace ArenaAllocator
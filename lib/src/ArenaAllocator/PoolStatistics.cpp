@@ -6,13 +6,29 @@
 
 
 #include "ArenaAllocator/PoolStatistics.h"
+#include "ArenaAllocator/AtomicExtreme.h"
 #include "ArenaAllocator/Chunk.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
 #include <limits>
 
 namespace ArenaAllocator {
 
 PoolStatistics::PoolStatistics(SizeRange const& range, std::size_t limit, Logger const& log) noexcept :
-	range{range}, limit{limit}, allocations{0}, minSize{std::numeric_limits<std::size_t>::max()}, maxSize{0}, hwm{0}, log{log}
+	range{range},
+	limit{limit},
+	log{log},
+	allocations{0},
+	hwm{0},
+	minSize{std::numeric_limits<std::size_t>::max()},
+	maxSize{0},
+	sampled{false},
+	samples{0},
+	variance{0},
+	hwmVariance{0},
+	lifetimes{}
 {
 	log(LogLevel::DEBUG,
 		[&] { return Message("PoolStatistics::PoolStatistics([{}, {}], {}) -> this:{}", range.first, range.last, limit, this); });
@@ -23,13 +39,24 @@ PoolStatistics::~PoolStatistics() noexcept
 	log(LogLevel::DEBUG, [&] { return Message("PoolStatistics::~PoolStatistics(this:{})", this); });
 }
 
-void PoolStatistics::registerAllocate(std::size_t size) noexcept
+void PoolStatistics::registerAllocate(std::size_t size, std::size_t weight) noexcept
 {
-	++allocations;
-	minSize = std::min(size, minSize);
-	maxSize = std::max(size, maxSize);
-	hwm = std::max(allocations, hwm);
-	if (limit > 0 && allocations > limit && hwm == limit + 1) {
+	const std::size_t current{allocations.fetch_add(weight, std::memory_order_relaxed) + weight};
+	samples.fetch_add(1, std::memory_order_relaxed);
+	std::size_t currentVariance{0};
+	if (weight != 1) {
+		if (!sampled.load(std::memory_order_relaxed)) {
+			sampled.store(true, std::memory_order_relaxed);
+		}
+		currentVariance = variance.fetch_add(weight * (weight - 1), std::memory_order_relaxed) + weight * (weight - 1);
+	}
+	updateExtreme(minSize, size, std::less<>{});
+	updateExtreme(maxSize, size, std::greater<>{});
+	const std::size_t previousHwm{updateExtreme(hwm, current, std::greater<>{})};
+	if (previousHwm < current && weight != 1) {
+		hwmVariance.store(currentVariance, std::memory_order_relaxed);
+	}
+	if (limit > 0 && current > limit && previousHwm <= limit) {
 		log(LogLevel::TRACE, [&] {
 			return Message(
 				"PoolStatistics::registerAllocate({}) {range: [{}, {}], ...} exceeded limit: {}",
@@ -41,9 +68,20 @@ void PoolStatistics::registerAllocate(std::size_t size) noexcept
 	}
 }
 
-void PoolStatistics::registerDeallocate() noexcept
+void PoolStatistics::registerDeallocate(std::size_t weight) noexcept
 {
-	--allocations;
+	allocations.fetch_sub(weight, std::memory_order_relaxed);
+	samples.fetch_sub(1, std::memory_order_relaxed);
+	if (weight != 1) {
+		variance.fetch_sub(weight * (weight - 1), std::memory_order_relaxed);
+	}
+}
+
+void PoolStatistics::registerLifetime(std::size_t weight, std::chrono::nanoseconds lifetime) noexcept
+{
+	const auto nanoseconds{static_cast<std::uint64_t>(std::max(lifetime.count(), std::chrono::nanoseconds::rep{0}))};
+	const std::size_t bucket{static_cast<std::size_t>(std::max(64 - __builtin_clzll(nanoseconds | 1U), 10) - 10)};
+	lifetimes[std::min(bucket, nLifetimeBuckets - 1)].fetch_add(weight, std::memory_order_relaxed);
 }
 
 SizeRange const& PoolStatistics::getRange() const noexcept
@@ -51,19 +89,80 @@ SizeRange const& PoolStatistics::getRange() const noexcept
 	return range;
 }
 
+namespace {
+
+// Normal approximation of the 95% confidence interval of an estimate with given variance.
+SizeRange confidenceInterval(std::size_t estimate, std::size_t variance, std::size_t lowest) noexcept
+{
+	const double halfWidth{1.96 * std::sqrt(static_cast<double>(variance))};
+	const double lower{std::max(static_cast<double>(lowest), std::round(static_cast<double>(estimate) - halfWidth))};
+	const double upper{std::round(static_cast<double>(estimate) + halfWidth)};
+	return SizeRange{static_cast<std::size_t>(lower), static_cast<std::size_t>(upper)};
+}
+
+} // namespace
+
 void PoolStatistics::dump() const noexcept
 {
-	log([&] {
-		return Message(
-			"[{}, {}]: {limit: {}, allocations: {}, minSize: {}, maxSize: {}, hwm: {}}",
-			range.first,
-			range.last,
-			limit,
-			allocations,
-			hwm > 0 ? minSize : 0,
-			maxSize,
-			hwm);
-	});
+	if (sampled.load(std::memory_order_relaxed)) {
+		const std::size_t currentAllocations{allocations.load(std::memory_order_relaxed)};
+		const std::size_t currentSamples{samples.load(std::memory_order_relaxed)};
+		const std::size_t currentHwm{hwm.load(std::memory_order_relaxed)};
+		const SizeRange allocationsInterval{
+			confidenceInterval(currentAllocations, variance.load(std::memory_order_relaxed), currentSamples)};
+		const SizeRange hwmInterval{confidenceInterval(currentHwm, hwmVariance.load(std::memory_order_relaxed), 0)};
+		log([&] {
+			return Message(
+				"[{}, {}]: {limit: {}, allocations: {}, minSize: {}, maxSize: {}, hwm: {}, sampled: {allocations: {}, "
+				"confidence95: {allocations: [{}, {}], hwm: [{}, {}]}}}",
+				range.first,
+				range.last,
+				limit,
+				currentAllocations,
+				currentHwm > 0 ? minSize.load(std::memory_order_relaxed) : 0,
+				maxSize.load(std::memory_order_relaxed),
+				currentHwm,
+				currentSamples,
+				allocationsInterval.first,
+				allocationsInterval.last,
+				hwmInterval.first,
+				hwmInterval.last);
+		});
+	} else {
+		log([&] {
+			return Message(
+				"[{}, {}]: {limit: {}, allocations: {}, minSize: {}, maxSize: {}, hwm: {}}",
+				range.first,
+				range.last,
+				limit,
+				allocations.load(std::memory_order_relaxed),
+				hwm.load(std::memory_order_relaxed) > 0 ? minSize.load(std::memory_order_relaxed) : 0,
+				maxSize.load(std::memory_order_relaxed),
+				hwm.load(std::memory_order_relaxed));
+		});
+	}
+	dumpLifetimes();
+}
+
+void PoolStatistics::dumpLifetimes() const noexcept
+{
+	// One line per pool, listing non empty buckets by their exclusive upper bound in nanoseconds.
+	Message line{"[{}, {}]: {lifetimes: {", range.first, range.last};
+	bool empty{true};
+	for (std::size_t bucket = 0; bucket < nLifetimeBuckets; ++bucket) {
+		const std::size_t count{lifetimes[bucket].load(std::memory_order_relaxed)};
+		if (count > 0) {
+			if (bucket + 1 < nLifetimeBuckets) {
+				line = Message{"{}{}<{}ns: {}", line.getResult(), empty ? "" : ", ", 1ULL << (bucket + 10), count};
+			} else {
+				line = Message{"{}{}>={}ns: {}", line.getResult(), empty ? "" : ", ", 1ULL << (bucket + 9), count};
+			}
+			empty = false;
+		}
+	}
+	if (!empty) {
+		log([&] { return Message{"{}}}", line.getResult()}; });
+	}
 }
 
 } // namespace ArenaAllocator
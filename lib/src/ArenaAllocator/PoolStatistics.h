@@ -13,6 +13,9 @@
 #include "ArenaAllocator/Logger.h"
 #include "ArenaAllocator/PassThroughCXXAllocator.h"
 #include "ArenaAllocator/SizeRange.h"
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <cstddef>
 #include <list>
 #include <vector>
@@ -27,19 +30,32 @@ public:
 	PoolStatistics& operator=(PoolStatistics const& other) = delete;
 	~PoolStatistics() noexcept;
 
-	void registerAllocate(std::size_t size) noexcept;
-	void registerDeallocate() noexcept;
+	// Lock free, may be invoked concurrently. Weight is the number of allocations a sampled allocation stands for.
+	void registerAllocate(std::size_t size, std::size_t weight) noexcept;
+	void registerDeallocate(std::size_t weight) noexcept;
+	void registerLifetime(std::size_t weight, std::chrono::nanoseconds lifetime) noexcept;
 	[[nodiscard]] SizeRange const& getRange() const noexcept;
 	void dump() const noexcept;
 
+	// Lifetime histogram bucket i > 0 counts lifetimes in [2^(i + 9), 2^(i + 10)) ns, bucket 0 below 1024 ns.
+	static constexpr std::size_t nLifetimeBuckets{32};
+
 private:
+	void dumpLifetimes() const noexcept;
+
 	const SizeRange range;
 	const std::size_t limit;
-	std::size_t allocations;
-	std::size_t minSize;
-	std::size_t maxSize;
-	std::size_t hwm;
 	Logger const& log;
+	std::atomic<std::size_t> allocations;
+	std::atomic<std::size_t> hwm;
+	std::atomic<std::size_t> minSize;
+	std::atomic<std::size_t> maxSize;
+	// Sampling only: allocations and hwm are estimates then, with variance sum of weight * (weight - 1).
+	std::atomic<bool> sampled;
+	std::atomic<std::size_t> samples;
+	std::atomic<std::size_t> variance;
+	std::atomic<std::size_t> hwmVariance;
+	std::array<std::atomic<std::size_t>, nLifetimeBuckets> lifetimes;
 };
 
 } // namespace ArenaAllocator
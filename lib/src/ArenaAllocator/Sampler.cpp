@@ -0,0 +1,93 @@
+//
+// Copyright (C) 2021 Dr. Michael Steffens
+//
+// SPDX-License-Identifier:     BSL-1.0
+//
+
+
+#include "ArenaAllocator/Sampler.h"
+#include <cmath>
+#include <cstdint>
+
+namespace ArenaAllocator {
+
+namespace {
+
+// Per thread generator state. Initial exec TLS model, see ThreadShard.h.
+thread_local std::uint64_t randomState __attribute__((tls_model("initial-exec")));
+thread_local double bytesUntilSample __attribute__((tls_model("initial-exec")));
+thread_local bool gapDrawn __attribute__((tls_model("initial-exec")));
+
+std::uint64_t nextRandom() noexcept
+{
+	if (randomState == 0) {
+		randomState = reinterpret_cast<std::uintptr_t>(&randomState) | 1U;
+	}
+	// xorshift64*
+	randomState ^= randomState >> 12U;
+	randomState ^= randomState << 25U;
+	randomState ^= randomState >> 27U;
+	return randomState * 0x2545F4914F6CDD1DULL;
+}
+
+double nextUniform() noexcept
+{
+	return static_cast<double>(nextRandom() >> 11U) * 0x1.0p-53;
+}
+
+double nextGap(std::size_t period) noexcept
+{
+	return -std::log(1.0 - nextUniform()) * static_cast<double>(period);
+}
+
+std::size_t roundUnbiased(double weight) noexcept
+{
+	const double floor{std::floor(weight)};
+	return static_cast<std::size_t>(floor) + (nextUniform() < weight - floor ? 1U : 0U);
+}
+
+} // namespace
+
+Sampler::Sampler(Sampling const& sampling) noexcept : sampling{sampling}
+{
+}
+
+std::size_t Sampler::operator()(std::size_t size) const noexcept
+{
+	std::size_t result{0};
+	switch (sampling.mode) {
+	case Sampling::Mode::NONE:
+		result = 1;
+		break;
+	case Sampling::Mode::RATE:
+		result = nextRandom() % sampling.period == 0 ? sampling.period : 0;
+		break;
+	case Sampling::Mode::INTERVAL:
+		// Poisson process over allocated bytes with exponentially distributed gaps, as heap profilers do: An
+		// allocation of size bytes is hit with probability 1 - exp(-size / period). A thread's first gap is drawn like
+		// any other, rather than sampling its first allocation for sure.
+		if (!gapDrawn) {
+			bytesUntilSample = nextGap(sampling.period);
+			gapDrawn = true;
+		}
+		bytesUntilSample -= static_cast<double>(size);
+		if (bytesUntilSample < 0) {
+			bytesUntilSample = nextGap(sampling.period);
+			result = roundUnbiased(1.0 / -std::expm1(-static_cast<double>(size) / static_cast<double>(sampling.period)));
+		}
+		break;
+	}
+	return result;
+}
+
+bool Sampler::isEnabled() const noexcept
+{
+	return sampling.mode != Sampling::Mode::NONE;
+}
+
+Sampling const& Sampler::getSampling() const noexcept
+{
+	return sampling;
+}
+
+} // namespace ArenaAllocator
@@ -0,0 +1,37 @@
+//
+// Copyright (C) 2021 Dr. Michael Steffens
+//
+// SPDX-License-Identifier:     BSL-1.0
+//
+
+
+#ifndef ArenaAllocator_Sampler_h_INCLUDED
+#define ArenaAllocator_Sampler_h_INCLUDED
+
+#include "ArenaAllocator/Sampling.h"
+#include <cstddef>
+
+namespace ArenaAllocator {
+
+class Sampler
+{
+public:
+	explicit Sampler(Sampling const& sampling) noexcept;
+	Sampler(Sampler const&) = delete;
+	Sampler& operator=(Sampler const&) = delete;
+	~Sampler() noexcept = default;
+
+	// Decides whether an allocation of size bytes is recorded. Returns the number of allocations it stands for, which
+	// is the inverse of its sampling probability rounded without bias, or 0 if it is not recorded.
+	[[nodiscard]] std::size_t operator()(std::size_t size) const noexcept;
+
+	[[nodiscard]] bool isEnabled() const noexcept;
+	[[nodiscard]] Sampling const& getSampling() const noexcept;
+
+private:
+	const Sampling sampling;
+};
+
+} // namespace ArenaAllocator
+
+#endif // ArenaAllocator_Sampler_h_INCLUDED
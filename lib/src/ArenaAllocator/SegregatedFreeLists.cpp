@@ -8,6 +8,7 @@
 #include "ArenaAllocator/SegregatedFreeLists.h"
 #include "ArenaAllocator/Timer.h"
 #include <cerrno>
+#include <limits>
 
 namespace ArenaAllocator {
 
@@ -15,13 +16,39 @@ namespace {
 
 const auto alignPageSize{[]() { return ::sysconf(_SC_PAGESIZE) <= sizeof(std::max_align_t); }};
 
+std::size_t getPageSize() noexcept
+{
+	return static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+}
+
+// Total size of nmemb elements, saturated on overflow
+std::size_t getTotalSize(std::size_t nmemb, std::size_t size) noexcept
+{
+	std::size_t result{0};
+	if (__builtin_mul_overflow(nmemb, size, &result)) {
+		result = std::numeric_limits<std::size_t>::max();
+	}
+	return result;
+}
+
 } // namespace
 
 SegregatedFreeLists::SegregatedFreeLists(Configuration const& configuration, Allocator* delegate, Logger const& log) noexcept :
-	delegate{delegate}, log{log}, pools{configuration, log}, chunks{pools, delegate, log}
+	delegate{delegate},
+	log{log},
+	pools{configuration, log},
+	groups{configuration, pools, log},
+	page{configuration.getControl().page, groups, log},
+	chunks{groups, delegate, log},
+	delegateSizes{log}
 {
 	log(LogLevel::DEBUG,
 		[&] { return Message("{}::{}(Configuration const&, Allocator*, Logger const&) -> this:{}", className, className, this); });
+	// Trace records identify pools by their position in getCounters, counting from 1.
+	std::uint32_t poolId{0};
+	groups.forEachPoolMap([&](PoolMap<FreeList>& poolMap) {
+		poolMap.forEachPool([&](SizeRange const&, FreeList& pool) { pool.setId(++poolId); });
+	});
 }
 
 SegregatedFreeLists::~SegregatedFreeLists() noexcept
@@ -41,13 +68,14 @@ void* SegregatedFreeLists::malloc(std::size_t size) noexcept
 		Timer timer;
 		result = chunks.allocate(size, delegateMallocFunc, ChunkMap::alignAlways);
 		if (!result.fromDelegate) {
-			log(timer.getNanoseconds(), OperationType::MALLOC, [&] {
+			log(timer.getNanoseconds(), OperationType::MALLOC, size, result.pool, [&] {
 				return Message("{}::malloc({}) -> {}", className, size, result.ptr);
 			});
 		}
 	} else {
 		result = chunks.allocate(size, delegateMallocFunc, ChunkMap::alignAlways);
 	}
+	countDelegateCall(OperationType::MALLOC, result.fromDelegate, size, 0);
 	errno = result.propagateErrno;
 	return result.ptr;
 }
@@ -59,11 +87,14 @@ void SegregatedFreeLists::free(void* ptr) noexcept
 		Timer timer;
 		result = chunks.deallocate(ptr);
 		if (!result.fromDelegate) {
-			log(timer.getNanoseconds(), OperationType::FREE, [&] { return Message("{}::free({})", className, ptr); });
+			log(timer.getNanoseconds(), OperationType::FREE, result.size, result.pool, [&] {
+				return Message("{}::free({})", className, ptr);
+			});
 		}
 	} else {
 		result = chunks.deallocate(ptr);
 	}
+	countDelegateCall(OperationType::FREE, result.fromDelegate, 0, 0);
 	errno = result.propagateErrno;
 }
 
@@ -79,13 +110,14 @@ void* SegregatedFreeLists::calloc(std::size_t nmemb, std::size_t size) noexcept
 		Timer timer;
 		result = chunks.allocate(nmemb, size, delegateCallocFunc);
 		if (!result.fromDelegate) {
-			log(timer.getNanoseconds(), OperationType::CALLOC, [&] {
+			log(timer.getNanoseconds(), OperationType::CALLOC, nmemb * size, result.pool, [&] {
 				return Message("{}::calloc({}, {}) -> {}", className, nmemb, size, result.ptr);
 			});
 		}
 	} else {
 		result = chunks.allocate(nmemb, size, delegateCallocFunc);
 	}
+	countDelegateCall(OperationType::CALLOC, result.fromDelegate, getTotalSize(nmemb, size), 0);
 	errno = result.propagateErrno;
 	return result.ptr;
 }
@@ -97,13 +129,14 @@ void* SegregatedFreeLists::realloc(void* ptr, std::size_t size) noexcept
 		Timer timer;
 		result = chunks.reallocate(ptr, size);
 		if (!result.fromDelegate) {
-			log(timer.getNanoseconds(), OperationType::REALLOC, [&] {
+			log(timer.getNanoseconds(), OperationType::REALLOC, size, result.pool, [&] {
 				return Message("{}::realloc({}, {}) -> {}", className, ptr, size, result.ptr);
 			});
 		}
 	} else {
 		result = chunks.reallocate(ptr, size);
 	}
+	countDelegateCall(OperationType::REALLOC, result.fromDelegate, size, 0);
 	errno = result.propagateErrno;
 	return result.ptr;
 }
@@ -115,13 +148,14 @@ void* SegregatedFreeLists::reallocarray(void* ptr, std::size_t nmemb, std::size_
 		Timer timer;
 		result = chunks.reallocate(ptr, nmemb, size);
 		if (!result.fromDelegate) {
-			log(timer.getNanoseconds(), OperationType::REALLOCARRAY, [&] {
+			log(timer.getNanoseconds(), OperationType::REALLOCARRAY, nmemb * size, result.pool, [&] {
 				return Message("{}::reallocarray({}, {}, {}) -> {}", className, ptr, nmemb, size, result.ptr);
 			});
 		}
 	} else {
 		result = chunks.reallocate(ptr, nmemb, size);
 	}
+	countDelegateCall(OperationType::REALLOCARRAY, result.fromDelegate, getTotalSize(nmemb, size), 0);
 	errno = result.propagateErrno;
 	return result.ptr;
 }
@@ -139,13 +173,14 @@ int SegregatedFreeLists::posix_memalign(void** memptr, std::size_t alignment, st
 		Timer timer;
 		result = chunks.allocate(size, delegateMemAlignFunc, alignWordTypeSize);
 		if (!result.fromDelegate) {
-			log(timer.getNanoseconds(), OperationType::POSIX_MEMALIGN, [&] {
+			log(timer.getNanoseconds(), OperationType::POSIX_MEMALIGN, size, result.pool, [&] {
 				return Message("{}::posix_memalign(&{}, {}, {}) -> {}", className, *memptr, alignment, size, result.ptr);
 			});
 		}
 	} else {
 		result = chunks.allocate(size, delegateMemAlignFunc, alignWordTypeSize);
 	}
+	countDelegateCall(OperationType::POSIX_MEMALIGN, result.fromDelegate, size, alignment);
 	*memptr = result.ptr;
 	return result.propagateErrno;
 }
@@ -163,13 +198,14 @@ void* SegregatedFreeLists::aligned_alloc(std::size_t alignment, std::size_t size
 		Timer timer;
 		result = chunks.allocate(size, delegateAlignedAllocFunc, alignWordTypeSize);
 		if (!result.fromDelegate) {
-			log(timer.getNanoseconds(), OperationType::ALIGNED_ALLOC, [&] {
+			log(timer.getNanoseconds(), OperationType::ALIGNED_ALLOC, size, result.pool, [&] {
 				return Message("{}::aligned_alloc({}, {}) -> {}", className, alignment, size, result.ptr);
 			});
 		}
 	} else {
 		result = chunks.allocate(size, delegateAlignedAllocFunc, alignWordTypeSize);
 	}
+	countDelegateCall(OperationType::ALIGNED_ALLOC, result.fromDelegate, size, alignment);
 	errno = result.propagateErrno;
 	return result.ptr;
 }
@@ -186,13 +222,14 @@ void* SegregatedFreeLists::valloc(std::size_t size) noexcept
 		Timer timer;
 		result = chunks.allocate(size, delegateVallocFunc, alignPageSize);
 		if (!result.fromDelegate) {
-			log(timer.getNanoseconds(), OperationType::VALLOC, [&] {
+			log(timer.getNanoseconds(), OperationType::VALLOC, size, result.pool, [&] {
 				return Message("{}::valloc({}) -> {}", className, size, result.ptr);
 			});
 		}
 	} else {
 		result = chunks.allocate(size, delegateVallocFunc, alignPageSize);
 	}
+	countDelegateCall(OperationType::VALLOC, result.fromDelegate, size, getPageSize());
 	errno = result.propagateErrno;
 	return result.ptr;
 }
@@ -210,13 +247,14 @@ void* SegregatedFreeLists::memalign(std::size_t alignment, std::size_t size) noe
 		Timer timer;
 		result = chunks.allocate(size, delegateMemalignFunc, alignWordTypeSize);
 		if (!result.fromDelegate) {
-			log(timer.getNanoseconds(), OperationType::MEMALIGN, [&] {
+			log(timer.getNanoseconds(), OperationType::MEMALIGN, size, result.pool, [&] {
 				return Message("{}::memalign({}, {}) -> {}", className, alignment, size, result.ptr);
 			});
 		}
 	} else {
 		result = chunks.allocate(size, delegateMemalignFunc, alignWordTypeSize);
 	}
+	countDelegateCall(OperationType::MEMALIGN, result.fromDelegate, size, alignment);
 	errno = result.propagateErrno;
 	return result.ptr;
 }
@@ -233,21 +271,68 @@ void* SegregatedFreeLists::pvalloc(std::size_t size) noexcept
 		Timer timer;
 		result = chunks.allocate(size, delegatePvallocFunc, alignPageSize);
 		if (!result.fromDelegate) {
-			log(timer.getNanoseconds(), OperationType::PVALLOC, [&] {
+			log(timer.getNanoseconds(), OperationType::PVALLOC, size, result.pool, [&] {
 				return Message("{}::pvalloc({}) -> {}", className, size, result.ptr);
 			});
 		}
 	} else {
 		result = chunks.allocate(size, delegatePvallocFunc, alignPageSize);
 	}
+	countDelegateCall(OperationType::PVALLOC, result.fromDelegate, size, getPageSize());
 	errno = result.propagateErrno;
 	return result.ptr;
 }
 
-void SegregatedFreeLists::dump() const noexcept
+std::size_t SegregatedFreeLists::getCounters(
+	PoolCounters* poolCounters, std::size_t capacity, DelegateCounters* delegateCounters) const noexcept
+{
+	std::size_t result{0};
+	std::uint32_t group{0};
+	groups.forEachPoolMap([&](PoolMap<FreeList> const& poolMap) {
+		poolMap.forEachPool([&](SizeRange const&, FreeList const& pool) {
+			if (result < capacity) {
+				pool.getCounters(poolCounters[result]);
+				poolCounters[result].group = group;
+			}
+			++result;
+		});
+		++group;
+	});
+	if (delegateCounters != nullptr) {
+		for (std::size_t i = 0; i < delegateCounters->operations.size(); ++i) {
+			delegateCounters->operations[i] = delegateCalls.get(i);
+		}
+	}
+	return result;
+}
+
+bool SegregatedFreeLists::joinGroup(std::string_view name) noexcept
+{
+	return groups.join(name);
+}
+
+void SegregatedFreeLists::countDelegateCall(
+	OperationType operationType, bool fromDelegate, std::size_t size, std::size_t alignment) noexcept
 {
-	if (log.isLevel(LogLevel::INFO)) {
+	if (fromDelegate) {
+		delegateCalls.add(static_cast<std::size_t>(operationType));
+		page.countDelegateCall();
+		if (operationType != OperationType::FREE) {
+			delegateSizes.record(operationType, size, alignment);
+		}
+	}
+}
+
+void SegregatedFreeLists::dump(bool force) const noexcept
+{
+	if (force || log.isLevel(LogLevel::INFO)) {
 		pools.dump();
+		groups.dump();
+		chunks.dump();
+		delegateSizes.dump();
+	}
+	if (delegate != nullptr) {
+		delegate->dump(force);
 	}
 }
 
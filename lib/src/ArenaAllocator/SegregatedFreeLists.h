@@ -11,9 +11,13 @@
 #include "ArenaAllocator/Allocator.h"
 #include "ArenaAllocator/ChunkMap.h"
 #include "ArenaAllocator/Configuration.h"
+#include "ArenaAllocator/DelegateHistogram.h"
 #include "ArenaAllocator/FreeList.h"
 #include "ArenaAllocator/Logger.h"
+#include "ArenaAllocator/PoolGroups.h"
 #include "ArenaAllocator/PoolMap.h"
+#include "ArenaAllocator/ShardedCounters.h"
+#include "ArenaAllocator/StatisticsPage.h"
 #include <cstddef>
 #include <string_view>
 
@@ -37,15 +41,25 @@ public:
 	void* valloc(std::size_t size) noexcept override;
 	void* memalign(std::size_t alignment, std::size_t size) noexcept override;
 	void* pvalloc(std::size_t size) noexcept override;
-	void dump() const noexcept override;
+	void dump(bool force) const noexcept override;
+	std::size_t getCounters(
+		PoolCounters* poolCounters, std::size_t capacity, DelegateCounters* delegateCounters) const noexcept override;
+	bool joinGroup(std::string_view name) noexcept override;
 
 	static constexpr char const* className{"SegregatedFreeLists"};
 
 private:
+	// Size and alignment of requests served by the delegate feed the delegate histogram, alignment 0 if not explicit.
+	void countDelegateCall(OperationType operationType, bool fromDelegate, std::size_t size, std::size_t alignment) noexcept;
+
 	Allocator* delegate;
 	Logger const& log;
 	PoolMap<FreeList> pools;
+	PoolGroups groups;
+	const StatisticsPage page;
 	const ChunkMap chunks;
+	ShardedCounters<static_cast<std::size_t>(OperationType::UNKNOWN)> delegateCalls;
+	DelegateHistogram delegateSizes;
 };
 
 } // namespace ArenaAllocator
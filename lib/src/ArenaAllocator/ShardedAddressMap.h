@@ -0,0 +1,102 @@
+//
+// Copyright (C) 2021 Dr. Michael Steffens
+//
+// SPDX-License-Identifier:     BSL-1.0
+//
+
+
+#ifndef ArenaAllocator_ShardedAddressMap_h_INCLUDED
+#define ArenaAllocator_ShardedAddressMap_h_INCLUDED
+
+#include "ArenaAllocator/PassThroughCXXAllocator.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace ArenaAllocator {
+
+struct NoShardData
+{
+};
+
+// Values by allocation address, spread over shards locked individually. Shards derive from ShardDataT, for data kept
+// under the shard lock along with the values.
+template<typename ValueT, typename ShardDataT = NoShardData>
+class ShardedAddressMap
+{
+public:
+	using MapType = std::unordered_map<
+		void*,
+		ValueT,
+		std::hash<void*>,
+		std::equal_to<void*>,
+		PassThroughCXXAllocator<std::pair<void* const, ValueT>>>;
+
+	struct Shard : ShardDataT
+	{
+		mutable std::mutex mutex;
+		MapType values;
+	};
+
+	static constexpr std::size_t nShards{64};
+
+	Shard& getShard(void* ptr) noexcept
+	{
+		// Fibonacci hashing of the address without its alignment bits.
+		return shards[((reinterpret_cast<std::uintptr_t>(ptr) >> 4U) * 0x9E3779B97F4A7C15ULL) >> 58U];
+	}
+
+	// Deallocation and reallocation invoke the delegate while holding the lock of the shard containing ptr, then
+	// unregister ptr from that shard. Another thread receiving the same address from the delegate therefore cannot
+	// register it before it got unregistered here.
+	template<typename DelegateF, typename UnregisterF>
+	void deallocate(void* ptr, DelegateF delegateF, UnregisterF unregisterF) noexcept
+	{
+		if (ptr != nullptr) {
+			Shard& shard{getShard(ptr)};
+			std::lock_guard<std::mutex> guard{shard.mutex};
+			delegateF();
+			unregisterF(shard);
+		} else {
+			delegateF();
+		}
+	}
+
+	// unregisterF(shard, guard, result) may release guard, e.g. before registering result in another shard.
+	template<typename DelegateF, typename UnregisterF>
+	void* reallocate(void* ptr, DelegateF delegateF, UnregisterF unregisterF) noexcept
+	{
+		void* result{nullptr};
+		if (ptr != nullptr) {
+			Shard& shard{getShard(ptr)};
+			std::unique_lock<std::mutex> guard{shard.mutex};
+			result = delegateF();
+			unregisterF(shard, guard, result);
+		} else {
+			result = delegateF();
+		}
+		return result;
+	}
+
+	typename std::array<Shard, nShards>::const_iterator begin() const noexcept
+	{
+		return shards.begin();
+	}
+
+	typename std::array<Shard, nShards>::const_iterator end() const noexcept
+	{
+		return shards.end();
+	}
+
+private:
+	static_assert(nShards == 64, "getShard() selects the shard by the upper 6 bits of the address hash");
+
+	std::array<Shard, nShards> shards;
+};
+
+} // namespace ArenaAllocator
+
+#endif // ArenaAllocator_ShardedAddressMap_h_INCLUDED
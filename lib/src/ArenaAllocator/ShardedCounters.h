@@ -0,0 +1,52 @@
+//
+// Copyright (C) 2021 Dr. Michael Steffens
+//
+// SPDX-License-Identifier:     BSL-1.0
+//
+
+
+#ifndef ArenaAllocator_ShardedCounters_h_INCLUDED
+#define ArenaAllocator_ShardedCounters_h_INCLUDED
+
+#include "ArenaAllocator/ThreadShard.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace ArenaAllocator {
+
+// Relaxed atomic counters, spread over cache line aligned shards by thread, such that threads counting concurrently
+// rarely share a cache line. Sums are consistent per counter only.
+template<std::size_t nCounters>
+class ShardedCounters
+{
+public:
+	void add(std::size_t counter, std::uint64_t value = 1) noexcept
+	{
+		shards[getThreadShard<nShards>()].values[counter].fetch_add(value, std::memory_order_relaxed);
+	}
+
+	[[nodiscard]] std::uint64_t get(std::size_t counter) const noexcept
+	{
+		std::uint64_t result{0};
+		for (Shard const& shard : shards) {
+			result += shard.values[counter].load(std::memory_order_relaxed);
+		}
+		return result;
+	}
+
+private:
+	static constexpr std::size_t nShards{16};
+
+	struct alignas(64) Shard
+	{
+		std::array<std::atomic<std::uint64_t>, nCounters> values{};
+	};
+
+	std::array<Shard, nShards> shards;
+};
+
+} // namespace ArenaAllocator
+
+#endif // ArenaAllocator_ShardedCounters_h_INCLUDED
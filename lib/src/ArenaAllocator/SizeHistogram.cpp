@@ -0,0 +1,76 @@
+//
+// Copyright (C) 2021 Dr. Michael Steffens
+//
+// SPDX-License-Identifier:     BSL-1.0
+//
+
+
+#include "ArenaAllocator/SizeHistogram.h"
+#include "ArenaAllocator/AtomicExtreme.h"
+#include <limits>
+
+namespace ArenaAllocator {
+
+SizeHistogram::SizeHistogram(bool enabled, Logger const& log) noexcept :
+	enabled{enabled}, log{log}, buckets{}, liveBytes{0}, peakLiveBytes{0}
+{
+}
+
+void SizeHistogram::registerAllocate(std::size_t size, std::size_t weight) noexcept
+{
+	if (enabled) {
+		Bucket& bucket{buckets[getBucket(size)]};
+		updateMaximum(bucket.hwm, bucket.allocations.fetch_add(weight, std::memory_order_relaxed) + weight);
+		updateMaximum(peakLiveBytes, liveBytes.fetch_add(size * weight, std::memory_order_relaxed) + size * weight);
+	}
+}
+
+void SizeHistogram::registerDeallocate(std::size_t size, std::size_t weight) noexcept
+{
+	if (enabled) {
+		buckets[getBucket(size)].allocations.fetch_sub(weight, std::memory_order_relaxed);
+		liveBytes.fetch_sub(size * weight, std::memory_order_relaxed);
+	}
+}
+
+void SizeHistogram::dump() const noexcept
+{
+	if (enabled) {
+		for (std::size_t bucket = 0; bucket < nBuckets; ++bucket) {
+			const std::size_t hwm{buckets[bucket].hwm.load(std::memory_order_relaxed)};
+			if (hwm > 0) {
+				const SizeRange range{getBucketRange(bucket)};
+				log([&] {
+					return Message(
+						"SizeHistogram [{}, {}]: {allocations: {}, hwm: {}}",
+						range.first,
+						range.last,
+						buckets[bucket].allocations.load(std::memory_order_relaxed),
+						hwm);
+				});
+			}
+		}
+		log([&] {
+			return Message(
+				"SizeHistogram: {liveBytes: {}, peakLiveBytes: {}}",
+				liveBytes.load(std::memory_order_relaxed),
+				peakLiveBytes.load(std::memory_order_relaxed));
+		});
+	}
+}
+
+// Buckets of size - 1 make upper bounds inclusive. Dividing by linearStep before maps the sub buckets of linearLimit and
+// beyond to the same bounds as bucketing size - 1 directly.
+std::size_t SizeHistogram::getBucket(std::size_t size) noexcept
+{
+	return Buckets::getBucket((size > 0 ? size - 1 : 0) / linearStep);
+}
+
+SizeRange SizeHistogram::getBucketRange(std::size_t bucket) noexcept
+{
+	const std::size_t last{Buckets::getUpperBound(bucket) * linearStep + (linearStep - 1)};
+	return SizeRange{
+		Buckets::getLowerBound(bucket) * linearStep + 1, last < std::numeric_limits<std::size_t>::max() ? last + 1 : last};
+}
+
+} // namespace ArenaAllocator
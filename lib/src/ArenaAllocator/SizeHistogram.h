@@ -0,0 +1,62 @@
+//
+// Copyright (C) 2021 Dr. Michael Steffens
+//
+// SPDX-License-Identifier:     BSL-1.0
+//
+
+
+#ifndef ArenaAllocator_SizeHistogram_h_INCLUDED
+#define ArenaAllocator_SizeHistogram_h_INCLUDED
+
+#include "ArenaAllocator/LogLinearBuckets.h"
+#include "ArenaAllocator/Logger.h"
+#include "ArenaAllocator/SizeRange.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <limits>
+
+namespace ArenaAllocator {
+
+// Live allocations by size in fixed buckets, independent of the configured pools, with their peak concurrency. Unlike
+// the pools' statistics, its dump is suitable for designing a pool layout from scratch.
+class SizeHistogram
+{
+public:
+	SizeHistogram(bool enabled, Logger const& log) noexcept;
+	SizeHistogram(SizeHistogram const&) = delete;
+	SizeHistogram& operator=(SizeHistogram const&) = delete;
+	~SizeHistogram() noexcept = default;
+
+	// Lock free, may be invoked concurrently. Weight is the number of allocations a sampled allocation stands for.
+	void registerAllocate(std::size_t size, std::size_t weight) noexcept;
+	void registerDeallocate(std::size_t size, std::size_t weight) noexcept;
+	void dump() const noexcept;
+
+	// Buckets of linearStep bytes up to linearLimit, beyond 8 linear sub buckets per power of two. Bucket bounds are
+	// inclusive, such that each bucket ending on a power of two matches a pool size range [2^n + 1, 2^(n + 1)].
+	static constexpr std::size_t linearStep{16};
+	static constexpr std::size_t linearLimit{1024};
+	using Buckets = LogLinearBuckets<3, linearLimit / linearStep>;
+	static constexpr std::size_t nBuckets{Buckets::getBucket(std::numeric_limits<std::size_t>::max() / linearStep) + 1};
+
+	[[nodiscard]] static std::size_t getBucket(std::size_t size) noexcept;
+	[[nodiscard]] static SizeRange getBucketRange(std::size_t bucket) noexcept;
+
+private:
+	struct Bucket
+	{
+		std::atomic<std::size_t> allocations;
+		std::atomic<std::size_t> hwm;
+	};
+
+	const bool enabled;
+	Logger const& log;
+	std::array<Bucket, nBuckets> buckets;
+	std::atomic<std::size_t> liveBytes;
+	std::atomic<std::size_t> peakLiveBytes;
+};
+
+} // namespace ArenaAllocator
+
+#endif // ArenaAllocator_SizeHistogram_h_INCLUDED
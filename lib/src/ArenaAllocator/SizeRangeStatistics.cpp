@@ -33,7 +33,10 @@ SizeRangeStatistics::SizeRangeStatistics(Configuration const& configuration, All
 	log{log},
 	pools{configuration, log},
 	delegatePool{SizeRange{1, std::numeric_limits<std::size_t>::max()}, 0, log},
-	allocations{pools, delegatePool, log}
+	sampler{configuration.getSampling()},
+	sizes{configuration.getProfile().sizes, log},
+	threads{configuration.getProfile().threads, pools, delegatePool, log},
+	allocations{pools, delegatePool, sampler, sizes, threads, log}
 {
 	log(LogLevel::DEBUG, [&] {
 		return Message(
@@ -52,7 +55,6 @@ SizeRangeStatistics::~SizeRangeStatistics() noexcept
 
 void* SizeRangeStatistics::malloc(std::size_t size) noexcept
 {
-	std::lock_guard<std::mutex> guard{mutex};
 	void* result{nullptr};
 	if (size > 0) {
 		result = delegate.malloc(size);
@@ -67,16 +69,13 @@ void* SizeRangeStatistics::malloc(std::size_t size) noexcept
 
 void SizeRangeStatistics::free(void* ptr) noexcept
 {
-	std::lock_guard<std::mutex> guard{mutex};
 	if (ptr != nullptr && ptr != ptrToEmpty) {
-		delegate.free(ptr);
-		allocations.registerDeallocate(ptr);
+		allocations.deallocate(ptr, [&] { delegate.free(ptr); });
 	}
 }
 
 void* SizeRangeStatistics::calloc(std::size_t nmemb, std::size_t size) noexcept
 {
-	std::lock_guard<std::mutex> guard{mutex};
 	void* result{nullptr};
 	if (nmemb > 0 && size > 0) {
 		result = delegate.calloc(nmemb, size);
@@ -91,35 +90,24 @@ void* SizeRangeStatistics::calloc(std::size_t nmemb, std::size_t size) noexcept
 
 void* SizeRangeStatistics::realloc(void* ptr, std::size_t size) noexcept
 {
-	std::lock_guard<std::mutex> guard{mutex};
 	void* ptrOrNull{ptr == ptrToEmpty ? nullptr : ptr};
-	void* result{delegate.realloc(ptrOrNull, size)};
-	if (size == 0) {
-		allocations.registerDeallocate(ptrOrNull);
-		result = ptrToEmpty;
-	} else if (result != nullptr) {
-		allocations.registerReallocate(ptrOrNull, size, result);
-	}
-	return result;
+	void* result{allocations.reallocate(ptrOrNull, size, [&] { return delegate.realloc(ptrOrNull, size); })};
+	return size > 0 ? result : ptrToEmpty;
 }
 
 void* SizeRangeStatistics::reallocarray(void* ptr, std::size_t nmemb, std::size_t size) noexcept
 {
-	std::lock_guard<std::mutex> guard{mutex};
 	void* ptrOrNull{ptr == ptrToEmpty ? nullptr : ptr};
-	void* result{delegate.reallocarray(ptrOrNull, nmemb, size)};
-	if (nmemb == 0 || size == 0) {
-		allocations.registerDeallocate(ptrOrNull);
-		result = ptrToEmpty;
-	} else if (result != nullptr) {
-		allocations.registerReallocate(ptrOrNull, nmemb * size, result);
-	}
-	return result;
+	// Saturate an overflowing nmemb * size, which the delegate fails, instead of wrapping it to a deallocation.
+	const std::size_t totalSize{
+		size > 0 && nmemb > std::numeric_limits<std::size_t>::max() / size ? std::numeric_limits<std::size_t>::max()
+																		   : nmemb * size};
+	void* result{allocations.reallocate(ptrOrNull, totalSize, [&] { return delegate.reallocarray(ptrOrNull, nmemb, size); })};
+	return nmemb > 0 && size > 0 ? result : ptrToEmpty;
 }
 
 int SizeRangeStatistics::posix_memalign(void** memptr, std::size_t alignment, std::size_t size) noexcept
 {
-	std::lock_guard<std::mutex> guard{mutex};
 	int result{0};
 	if (size > 0) {
 		result = delegate.posix_memalign(memptr, alignment, size);
@@ -135,7 +123,6 @@ int SizeRangeStatistics::posix_memalign(void** memptr, std::size_t alignment, st
 
 void* SizeRangeStatistics::aligned_alloc(std::size_t alignment, std::size_t size) noexcept
 {
-	std::lock_guard<std::mutex> guard{mutex};
 	void* result{nullptr};
 	if (size > 0) {
 		result = delegate.aligned_alloc(alignment, size);
@@ -150,7 +137,6 @@ void* SizeRangeStatistics::aligned_alloc(std::size_t alignment, std::size_t size
 
 void* SizeRangeStatistics::valloc(std::size_t size) noexcept
 {
-	std::lock_guard<std::mutex> guard{mutex};
 	void* result{nullptr};
 	if (size > 0) {
 		result = delegate.valloc(size);
@@ -165,10 +151,9 @@ void* SizeRangeStatistics::valloc(std::size_t size) noexcept
 
 void* SizeRangeStatistics::memalign(std::size_t alignment, std::size_t size) noexcept
 {
-	std::lock_guard<std::mutex> guard{mutex};
 	void* result{nullptr};
 	if (size > 0) {
-		result = delegate.pvalloc(size);
+		result = delegate.memalign(alignment, size);
 		if (result != nullptr) {
 			allocations.registerAllocate(size, result, alignment);
 		}
@@ -180,7 +165,6 @@ void* SizeRangeStatistics::memalign(std::size_t alignment, std::size_t size) noe
 
 void* SizeRangeStatistics::pvalloc(std::size_t size) noexcept
 {
-	std::lock_guard<std::mutex> guard{mutex};
 	void* result{nullptr};
 	if (size > 0) {
 		result = delegate.pvalloc(size);
@@ -193,15 +177,35 @@ void* SizeRangeStatistics::pvalloc(std::size_t size) noexcept
 	return result;
 }
 
-void SizeRangeStatistics::dump() const noexcept
+std::size_t SizeRangeStatistics::getCounters(
+	PoolCounters* poolCounters, std::size_t capacity, DelegateCounters* delegateCounters) const noexcept
+{
+	return delegate.getCounters(poolCounters, capacity, delegateCounters);
+}
+
+bool SizeRangeStatistics::joinGroup(std::string_view name) noexcept
+{
+	return delegate.joinGroup(name);
+}
+
+bool SizeRangeStatistics::switchPhase() noexcept
+{
+	return delegate.switchPhase();
+}
+
+void SizeRangeStatistics::dump(bool force) const noexcept
 {
-	if (log.isLevel(LogLevel::INFO)) {
+	if (force || log.isLevel(LogLevel::INFO)) {
 		pools.dump();
 		delegatePool.dump();
+		sizes.dump();
+		allocations.dumpGrowthChains();
+		threads.dump();
 		if (log.isLevel(LogLevel::DEBUG)) {
 			allocations.dump();
 		}
 	}
+	delegate.dump(force);
 }
 
 } // namespace ArenaAllocator
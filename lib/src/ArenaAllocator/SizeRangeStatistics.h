@@ -12,8 +12,10 @@
 #include "ArenaAllocator/Allocator.h"
 #include "ArenaAllocator/Configuration.h"
 #include "ArenaAllocator/Logger.h"
+#include "ArenaAllocator/Sampler.h"
+#include "ArenaAllocator/SizeHistogram.h"
+#include "ArenaAllocator/ThreadProfile.h"
 #include <cstddef>
-#include <mutex>
 #include <string_view>
 
 namespace ArenaAllocator {
@@ -36,17 +38,23 @@ public:
 	void* valloc(std::size_t size) noexcept override;
 	void* memalign(std::size_t alignment, std::size_t size) noexcept override;
 	void* pvalloc(std::size_t size) noexcept override;
-	void dump() const noexcept override;
+	void dump(bool force) const noexcept override;
+	std::size_t getCounters(
+		PoolCounters* poolCounters, std::size_t capacity, DelegateCounters* delegateCounters) const noexcept override;
+	bool joinGroup(std::string_view name) noexcept override;
+	bool switchPhase() noexcept override;
 
 	static constexpr char const* className{"SizeRangeStatistics"};
 
 private:
 	void* const ptrToEmpty;
-	std::mutex mutex;
 	Allocator& delegate;
 	Logger const& log;
 	PoolMap<PoolStatistics> pools;
 	PoolStatistics delegatePool;
+	const Sampler sampler;
+	SizeHistogram sizes;
+	ThreadProfile threads;
 	AllocationMap allocations;
 };
 
@@ -0,0 +1,124 @@
+//
+// Copyright (C) 2021 Dr. Michael Steffens
+//
+// SPDX-License-Identifier:     BSL-1.0
+//
+
+
+#include "ArenaAllocator/StatisticsPage.h"
+#include "ArenaAllocator/BuildConfiguration.h"
+#include <cerrno>
+#include <cstdio>
+#include <fcntl.h>
+#include <new>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace ArenaAllocator {
+
+namespace {
+
+// The page of this process, for finish and fork handlers
+std::atomic<StatisticsPage*> published{nullptr};
+
+std::size_t countPools(PoolGroups& groups) noexcept
+{
+	std::size_t result{0};
+	groups.forEachPoolMap([&](PoolMap<FreeList>& pools) { result += pools.size(); });
+	return result;
+}
+
+} // namespace
+
+StatisticsPage::StatisticsPage(bool enabled, PoolGroups& groups, Logger const& log) noexcept :
+	log{log}, size{sizeof(StatisticsPageHeader) + countPools(groups) * sizeof(StatisticsPagePool)}, header{nullptr}, path{}
+{
+	if (enabled) {
+		std::snprintf(path, sizeof(path), "%s/ArenaAllocator-%d", BuildConfiguration::statisticsPageDirectory, ::getpid());
+		int fd{::open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600)};
+		void* mapped{MAP_FAILED};
+		if (fd != -1 && ::ftruncate(fd, static_cast<::off_t>(size)) == 0) {
+			mapped = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		}
+		if (mapped != MAP_FAILED) {
+			header = new (mapped) StatisticsPageHeader{
+				{0}, static_cast<std::uint32_t>(countPools(groups)), static_cast<std::uint32_t>(::getpid()), {0}};
+			StatisticsPagePool* counters{reinterpret_cast<StatisticsPagePool*>(header + 1)};
+			std::uint64_t group{0};
+			groups.forEachPoolMap([&](PoolMap<FreeList>& pools) {
+				pools.forEachPool([&](SizeRange const& range, FreeList& pool) {
+					pool.publish(new (counters++) StatisticsPagePool{
+						range.first, range.last, pool.nChunks(), group, {0}, {0}, {0}, {0}, {0}, {0}, {0}});
+				});
+				++group;
+			});
+			header->pageMagic.store(StatisticsPageHeader::magic, std::memory_order_release);
+			if (published.exchange(this, std::memory_order_acq_rel) == nullptr) {
+				::pthread_atfork(nullptr, nullptr, &StatisticsPage::handleForkChild);
+			}
+		} else {
+			log(LogLevel::ERROR, [&] { return Message("StatisticsPage failed to map {}, errno {}", path, errno); });
+		}
+		if (fd != -1) {
+			::close(fd);
+		}
+	}
+	log(LogLevel::DEBUG, [&] { return Message("StatisticsPage::StatisticsPage({}) -> this:{}", path, this); });
+}
+
+StatisticsPage::~StatisticsPage() noexcept
+{
+	log(LogLevel::DEBUG, [&] { return Message("StatisticsPage::~StatisticsPage(this:{})", this); });
+	if (header != nullptr) {
+		StatisticsPage* expected{this};
+		published.compare_exchange_strong(expected, nullptr, std::memory_order_acq_rel);
+		::munmap(header, size);
+		if (path[0] != '\0') {
+			::unlink(path);
+		}
+	}
+}
+
+void StatisticsPage::finish() noexcept
+{
+	StatisticsPage* page{published.load(std::memory_order_acquire)};
+	if (page != nullptr && page->path[0] != '\0') {
+		::unlink(page->path);
+		page->path[0] = '\0';
+	}
+}
+
+void StatisticsPage::handleForkChild() noexcept
+{
+	StatisticsPage* page{published.load(std::memory_order_acquire)};
+	if (page != nullptr) {
+		page->remap();
+	}
+}
+
+void StatisticsPage::remap() noexcept
+{
+	// Only the forking thread runs in the child, no counter changes while copying.
+	std::snprintf(path, sizeof(path), "%s/ArenaAllocator-%d", BuildConfiguration::statisticsPageDirectory, ::getpid());
+	int fd{::open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600)};
+	void* mapped{MAP_FAILED};
+	if (fd != -1 && ::pwrite(fd, header, size, 0) == static_cast<::ssize_t>(size)) {
+		mapped = ::mmap(header, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0);
+	}
+	if (mapped == MAP_FAILED) {
+		if (fd != -1) {
+			::unlink(path);
+		}
+		path[0] = '\0';
+		// Counting into memory no reader sees, rather than into the parent's page
+		mapped = ::mmap(header, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0);
+		log(LogLevel::ERROR, [&] { return Message("StatisticsPage failed to remap in child, errno {}", errno); });
+	}
+	header->pid = static_cast<std::uint32_t>(::getpid());
+	if (fd != -1) {
+		::close(fd);
+	}
+}
+
+} // namespace ArenaAllocator
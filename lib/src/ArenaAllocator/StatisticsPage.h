@@ -0,0 +1,55 @@
+//
+// Copyright (C) 2021 Dr. Michael Steffens
+//
+// SPDX-License-Identifier:     BSL-1.0
+//
+
+
+#ifndef ArenaAllocator_StatisticsPage_h_INCLUDED
+#define ArenaAllocator_StatisticsPage_h_INCLUDED
+
+#include "ArenaAllocator/FreeList.h"
+#include "ArenaAllocator/Logger.h"
+#include "ArenaAllocator/PoolGroups.h"
+#include "ArenaAllocator/StatisticsPageFormat.h"
+#include <cstddef>
+
+namespace ArenaAllocator {
+
+// Shared memory counters of SegregatedFreeLists pools of all groups, for external tools like arenaTop. Disabled pages map
+// nothing and count nothing. The file is removed at exit by finish(). Forked children continue counting in a copy of their
+// own.
+class StatisticsPage
+{
+public:
+	StatisticsPage(bool enabled, PoolGroups& groups, Logger const& log) noexcept;
+	StatisticsPage(StatisticsPage const&) = delete;
+	StatisticsPage& operator=(StatisticsPage const&) = delete;
+	~StatisticsPage() noexcept;
+
+	// Removes the file of the page mapped by this process, if any. Counting continues in the unlinked mapping.
+	static void finish() noexcept;
+
+	void countDelegateCall() const noexcept
+	{
+		if (header != nullptr) {
+			header->delegateCalls.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+private:
+	static void handleForkChild() noexcept;
+
+	// Replaces the mapping inherited from the parent process by a copy mapped from a file of the calling process, at the
+	// same address, such that pools keep publishing to it. Falls back to anonymous memory, hidden from readers.
+	void remap() noexcept;
+
+	Logger const& log;
+	std::size_t size;
+	StatisticsPageHeader* header;
+	char path[64];
+};
+
+} // namespace ArenaAllocator
+
+#endif // ArenaAllocator_StatisticsPage_h_INCLUDED
@@ -0,0 +1,203 @@
+//
+// Copyright (C) 2021 Dr. Michael Steffens
+//
+// SPDX-License-Identifier:     BSL-1.0
+//
+
+
+#include "ArenaAllocator/ThreadProfile.h"
+#include "ArenaAllocator/AtomicExtreme.h"
+#include "ArenaAllocator/Chunk.h"
+#include <algorithm>
+#include <cstdio>
+#include <fcntl.h>
+#include <limits>
+#include <new>
+#include <pthread.h>
+#include <string_view>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <utility>
+
+namespace ArenaAllocator {
+
+namespace {
+
+bool isLess(PoolStatistics const* lhs, PoolStatistics const* rhs) noexcept
+{
+	return std::make_pair(lhs->getRange().first, lhs->getRange().last) <
+		std::make_pair(rhs->getRange().first, rhs->getRange().last);
+}
+
+// Thread index of the calling thread, valid for the instance it was registered with only. Initial exec TLS model, see
+// ThreadShard.h.
+thread_local void const* threadOwner __attribute__((tls_model("initial-exec")));
+thread_local std::uint32_t threadIndex __attribute__((tls_model("initial-exec")));
+
+} // namespace
+
+ThreadProfile::ThreadProfile(
+	bool enabled, PoolMap<PoolStatistics>& pools, PoolStatistics& delegatePool, Logger const& log) noexcept :
+	enabled{enabled}, log{log}, nThreads{0}, threads{}
+{
+	if (enabled) {
+		poolIndex.reserve(pools.size() + 1);
+		pools.forEachPool([&](SizeRange const&, PoolStatistics& pool) { poolIndex.push_back(&pool); });
+		poolIndex.push_back(&delegatePool);
+		std::sort(poolIndex.begin(), poolIndex.end(), isLess);
+	}
+}
+
+ThreadProfile::~ThreadProfile() noexcept
+{
+	for (std::size_t i = 0; i < std::min(nThreads.load(std::memory_order_acquire), maxThreads); ++i) {
+		if (threads[i].ready.load(std::memory_order_acquire)) {
+			__libc_free(threads[i].usage);
+		}
+	}
+}
+
+std::uint32_t ThreadProfile::getThread() noexcept
+{
+	std::uint32_t result{0};
+	if (enabled) {
+		if (threadOwner != this) {
+			threadIndex = registerThread();
+			threadOwner = this;
+		}
+		result = threadIndex;
+	}
+	return result;
+}
+
+std::uint32_t ThreadProfile::registerThread() noexcept
+{
+	std::uint32_t result{0};
+	const auto tid{static_cast<::pid_t>(::syscall(SYS_gettid))};
+	// A thread alternating between instances, or reusing the tid of a terminated one, continues the existing record.
+	const std::size_t n{std::min(nThreads.load(std::memory_order_acquire), maxThreads)};
+	for (std::size_t i = 0; i < n && result == 0; ++i) {
+		if (threads[i].ready.load(std::memory_order_acquire) && threads[i].tid == tid) {
+			result = static_cast<std::uint32_t>(i + 1);
+		}
+	}
+	if (result == 0) {
+		const std::size_t index{nThreads.fetch_add(1, std::memory_order_acq_rel)};
+		if (index < maxThreads) {
+			Thread& thread{threads[index]};
+			thread.tid = tid;
+			if (::pthread_getname_np(::pthread_self(), thread.name.data(), thread.name.size()) != 0) {
+				thread.name[0] = '\0';
+			}
+			thread.usage = static_cast<Usage*>(__libc_malloc(poolIndex.size() * sizeof(Usage)));
+			if (thread.usage != nullptr) {
+				for (std::size_t i = 0; i < poolIndex.size(); ++i) {
+					new (&thread.usage[i]) Usage{{0}, {0}};
+				}
+				thread.ready.store(true, std::memory_order_release);
+				result = static_cast<std::uint32_t>(index + 1);
+			}
+		}
+	}
+	return result;
+}
+
+void ThreadProfile::registerAllocate(
+	std::uint32_t thread, PoolStatistics const* pool, std::size_t size, std::size_t weight) noexcept
+{
+	if (thread > 0) {
+		Thread& allocating{threads[thread - 1]};
+		Usage& usage{allocating.usage[getPoolIndex(pool)]};
+		updateMaximum(usage.hwm, usage.allocations.fetch_add(weight, std::memory_order_relaxed) + weight);
+		updateMaximum(
+			allocating.peakLiveBytes, allocating.liveBytes.fetch_add(size * weight, std::memory_order_relaxed) + size * weight);
+	}
+}
+
+void ThreadProfile::registerDeallocate(
+	std::uint32_t thread, PoolStatistics const* pool, std::size_t size, std::size_t weight) noexcept
+{
+	if (thread > 0) {
+		Thread& allocating{threads[thread - 1]};
+		allocating.usage[getPoolIndex(pool)].allocations.fetch_sub(weight, std::memory_order_relaxed);
+		allocating.liveBytes.fetch_sub(size * weight, std::memory_order_relaxed);
+	}
+}
+
+std::size_t ThreadProfile::getPoolIndex(PoolStatistics const* pool) const noexcept
+{
+	return static_cast<std::size_t>(std::lower_bound(poolIndex.begin(), poolIndex.end(), pool, isLess) - poolIndex.begin());
+}
+
+void ThreadProfile::dump() const noexcept
+{
+	if (enabled) {
+		const std::size_t n{nThreads.load(std::memory_order_acquire)};
+		for (std::size_t i = 0; i < std::min(n, maxThreads); ++i) {
+			if (threads[i].ready.load(std::memory_order_acquire)) {
+				dump(threads[i]);
+			}
+		}
+		if (n > maxThreads) {
+			log([&] { return Message("ThreadProfile: {unattributedThreads: {}}", n - maxThreads); });
+		}
+	}
+}
+
+void ThreadProfile::dump(Thread const& thread) const noexcept
+{
+	// The current name of a running thread, as pthread_getname_np reads it for threads other than the caller.
+	std::array<char, 16> name{thread.name};
+	char path[64];
+	std::snprintf(path, sizeof(path), "/proc/self/task/%d/comm", thread.tid);
+	const int fd{::open(path, O_RDONLY | O_CLOEXEC)};
+	const bool exited{fd == -1};
+	if (!exited) {
+		const ::ssize_t nRead{::read(fd, name.data(), name.size() - 1)};
+		if (nRead > 0) {
+			name[static_cast<std::size_t>(nRead)] = '\0';
+			if (name[static_cast<std::size_t>(nRead) - 1] == '\n') {
+				name[static_cast<std::size_t>(nRead) - 1] = '\0';
+			}
+		}
+		::close(fd);
+	}
+	// Chunk bytes covering the thread's hwm per pool, the delegate's allocations not included
+	std::size_t poolBytes{0};
+	for (std::size_t i = 0; i < poolIndex.size(); ++i) {
+		const std::size_t hwm{thread.usage[i].hwm.load(std::memory_order_relaxed)};
+		if (hwm > 0) {
+			SizeRange const& range{poolIndex[i]->getRange()};
+			if (range.first > 1 || range.last < std::numeric_limits<std::size_t>::max()) {
+				poolBytes += hwm * getChunkSize(range.last);
+			}
+		}
+	}
+	log([&] {
+		return Message(
+			"ThreadProfile {}: {name: {}, exited: {}, liveBytes: {}, peakLiveBytes: {}, poolBytes: {}}",
+			thread.tid,
+			std::string_view{name.data()},
+			static_cast<int>(exited),
+			thread.liveBytes.load(std::memory_order_relaxed),
+			thread.peakLiveBytes.load(std::memory_order_relaxed),
+			poolBytes);
+	});
+	for (std::size_t i = 0; i < poolIndex.size(); ++i) {
+		const std::size_t hwm{thread.usage[i].hwm.load(std::memory_order_relaxed)};
+		if (hwm > 0) {
+			SizeRange const& range{poolIndex[i]->getRange()};
+			log([&] {
+				return Message(
+					"ThreadProfile {} [{}, {}]: {allocations: {}, hwm: {}}",
+					thread.tid,
+					range.first,
+					range.last,
+					thread.usage[i].allocations.load(std::memory_order_relaxed),
+					hwm);
+			});
+		}
+	}
+}
+
+} // namespace ArenaAllocator
@@ -0,0 +1,76 @@
+//
+// Copyright (C) 2021 Dr. Michael Steffens
+//
+// SPDX-License-Identifier:     BSL-1.0
+//
+
+
+#ifndef ArenaAllocator_ThreadProfile_h_INCLUDED
+#define ArenaAllocator_ThreadProfile_h_INCLUDED
+
+#include "ArenaAllocator/Logger.h"
+#include "ArenaAllocator/PassThroughCXXAllocator.h"
+#include "ArenaAllocator/PoolMap.h"
+#include "ArenaAllocator/PoolStatistics.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <sys/types.h>
+#include <vector>
+
+namespace ArenaAllocator {
+
+// Pool usage by allocating thread, identified by tid and name. Deallocations are attributed to the thread having
+// allocated, whichever thread frees.
+class ThreadProfile
+{
+public:
+	ThreadProfile(bool enabled, PoolMap<PoolStatistics>& pools, PoolStatistics& delegatePool, Logger const& log) noexcept;
+	ThreadProfile(ThreadProfile const&) = delete;
+	ThreadProfile& operator=(ThreadProfile const&) = delete;
+	~ThreadProfile() noexcept;
+
+	// Thread index of the calling thread, registering it on first invocation. 0 if disabled or out of thread slots.
+	[[nodiscard]] std::uint32_t getThread() noexcept;
+
+	// Lock free, may be invoked concurrently. Weight is the number of allocations a sampled allocation stands for.
+	void registerAllocate(std::uint32_t thread, PoolStatistics const* pool, std::size_t size, std::size_t weight) noexcept;
+	void registerDeallocate(std::uint32_t thread, PoolStatistics const* pool, std::size_t size, std::size_t weight) noexcept;
+	void dump() const noexcept;
+
+	static constexpr std::size_t maxThreads{256};
+
+private:
+	struct Usage
+	{
+		std::atomic<std::size_t> allocations;
+		std::atomic<std::size_t> hwm;
+	};
+
+	struct Thread
+	{
+		std::atomic<bool> ready;
+		::pid_t tid;
+		std::array<char, 16> name; // As of registration, see pthread_getname_np
+		Usage* usage; // Per pool, in order of poolIndex
+		std::atomic<std::size_t> liveBytes;
+		std::atomic<std::size_t> peakLiveBytes;
+	};
+
+	using PoolIndexType = std::vector<PoolStatistics const*, PassThroughCXXAllocator<PoolStatistics const*>>;
+
+	std::uint32_t registerThread() noexcept;
+	[[nodiscard]] std::size_t getPoolIndex(PoolStatistics const* pool) const noexcept;
+	void dump(Thread const& thread) const noexcept;
+
+	const bool enabled;
+	Logger const& log;
+	PoolIndexType poolIndex; // Sorted by size range first and last
+	std::atomic<std::size_t> nThreads;
+	std::array<Thread, maxThreads> threads;
+};
+
+} // namespace ArenaAllocator
+
+#endif // ArenaAllocator_ThreadProfile_h_INCLUDED
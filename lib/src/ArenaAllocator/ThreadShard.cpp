@@ -0,0 +1,15 @@
+//
+// Copyright (C) 2021 Dr. Michael Steffens
+//
+// SPDX-License-Identifier:     BSL-1.0
+//
+
+
+#include "ArenaAllocator/ThreadShard.h"
+
+namespace ArenaAllocator {
+
+thread_local std::size_t threadNumber __attribute__((tls_model("initial-exec")));
+std::atomic<std::size_t> nextThreadNumber{0};
+
+} // namespace ArenaAllocator
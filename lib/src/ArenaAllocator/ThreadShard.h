@@ -0,0 +1,37 @@
+//
+// Copyright (C) 2021 Dr. Michael Steffens
+//
+// SPDX-License-Identifier:     BSL-1.0
+//
+
+
+#ifndef ArenaAllocator_ThreadShard_h_INCLUDED
+#define ArenaAllocator_ThreadShard_h_INCLUDED
+
+#include <atomic>
+#include <cstddef>
+
+namespace ArenaAllocator {
+
+// Thread local state of the library uses the initial exec TLS model. With the default model, a dlopen'ed library
+// resolves thread locals by __tls_get_addr, which may call malloc and thus recurse into the allocator. Thread locals are
+// trivially initialized as well, avoiding TLS constructors and destructors.
+
+// Number of the calling thread plus one, 0 if not yet assigned
+extern thread_local std::size_t threadNumber __attribute__((tls_model("initial-exec")));
+extern std::atomic<std::size_t> nextThreadNumber;
+
+// Shard of the calling thread among nShards. Threads are numbered on their first call, so they are assigned to shards
+// round robin, and don't share one as long as there are no more threads than shards.
+template<std::size_t nShards>
+std::size_t getThreadShard() noexcept
+{
+	if (threadNumber == 0) {
+		threadNumber = nextThreadNumber.fetch_add(1, std::memory_order_relaxed) + 1;
+	}
+	return (threadNumber - 1) % nShards;
+}
+
+} // namespace ArenaAllocator
+
+#endif // ArenaAllocator_ThreadShard_h_INCLUDED
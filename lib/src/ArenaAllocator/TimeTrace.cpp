@@ -37,12 +37,12 @@ TimeTrace::~TimeTrace() noexcept
 
 bool TimeTrace::isLevel(LogLevel level) const noexcept
 {
-	return logLevel >= level;
+	return logLevel.load(std::memory_order_relaxed) >= level;
 }
 
 void TimeTrace::setLevel(LogLevel level) noexcept
 {
-	logLevel = level;
+	logLevel.store(level, std::memory_order_relaxed);
 }
 
 void TimeTrace::log(Formatter const& formatter) const noexcept
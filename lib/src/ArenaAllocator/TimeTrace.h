@@ -9,6 +9,7 @@
 #define ArenaAllocator_TimeTrace_h_INCLUDED
 
 #include "ArenaAllocator/Logger.h"
+#include <atomic>
 
 namespace ArenaAllocator {
 
@@ -32,7 +33,7 @@ protected:
 	void log(LogLevel level, Formatter const& formatter) const noexcept override;
 
 private:
-	LogLevel logLevel;
+	std::atomic<LogLevel> logLevel; // Set by the control thread
 };
 
 } // namespace ArenaAllocator
@@ -10,26 +10,122 @@
 #include <cerrno>
 #include <cstdio>
 #include <cstdlib>
+#include <sched.h>
+#if defined(__x86_64__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#endif
 
 namespace ArenaAllocator {
 
 namespace {
 
-// Ensure that errno is preserved across the Timer::ClockType::now() call.
-std::chrono::time_point<Timer::ClockType> now()
+// Ensure that errno is preserved across the std::chrono::steady_clock::now() call.
+std::uint64_t steadyClockNow() noexcept
 {
-	std::chrono::time_point<Timer::ClockType> result;
 	int propagateErrno{errno};
-	result = Timer::ClockType::now();
+	const auto result{static_cast<std::uint64_t>(
+		std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count())};
 	errno = propagateErrno;
 	return result;
 }
 
+#if defined(__x86_64__)
+
+struct TscCalibration
+{
+	bool invariant;
+	std::uint64_t nanosecondsPerTick; // Fixed point, 32 fractional bits
+};
+
+TscCalibration calibrate() noexcept
+{
+	TscCalibration result{false, 0};
+	unsigned eax{0};
+	unsigned ebx{0};
+	unsigned ecx{0};
+	unsigned edx{0};
+	// CPUID.80000007H:EDX[8] indicates invariant TSC, running at constant rate across P-, C- and T-states.
+	if (__get_cpuid(0x80000007U, &eax, &ebx, &ecx, &edx) != 0 && (edx & (1U << 8U)) != 0) {
+		// Busy wait a millisecond, trading startup latency for a relative error in the order of 1e-4.
+		constexpr std::uint64_t calibrationNanoseconds{1000000};
+		const std::uint64_t startTime{steadyClockNow()};
+		const std::uint64_t startTicks{__rdtsc()};
+		std::uint64_t stopTime{startTime};
+		while (stopTime - startTime < calibrationNanoseconds) {
+			stopTime = steadyClockNow();
+		}
+		const std::uint64_t ticks{__rdtsc() - startTicks};
+		if (ticks > 0) {
+			result.invariant = true;
+			result.nanosecondsPerTick = static_cast<std::uint64_t>(
+				(static_cast<unsigned __int128>(stopTime - startTime) << 32U) / static_cast<unsigned __int128>(ticks));
+		}
+	}
+	return result;
+}
+
+// Calibrated on first use, sparing processes not timing anything the calibration delay.
+TscCalibration const& getCalibration() noexcept
+{
+	static const TscCalibration calibration{calibrate()};
+	return calibration;
+}
+
+bool useTsc() noexcept
+{
+	return BuildConfiguration::timerClock == BuildConfiguration::TimerClock::TSC && getCalibration().invariant;
+}
+
+std::uint64_t ticksToNanoseconds(std::uint64_t ticks) noexcept
+{
+	return static_cast<std::uint64_t>((static_cast<unsigned __int128>(ticks) * getCalibration().nanosecondsPerTick) >> 32U);
+}
+
+std::uint64_t now(unsigned& cpu) noexcept
+{
+	std::uint64_t result{0};
+	if (useTsc()) {
+		unsigned aux{0};
+		result = __rdtscp(&aux);
+		// Linux stores the CPU number in the low 12 bits of IA32_TSC_AUX
+		cpu = aux & 0xfffU;
+	} else {
+		result = steadyClockNow();
+		if constexpr (BuildConfiguration::contextSwitchDetection == BuildConfiguration::ContextSwitchDetection::CPU_MIGRATION) {
+			cpu = static_cast<unsigned>(::sched_getcpu());
+		}
+	}
+	return result;
+}
+
+#else
+
+bool useTsc() noexcept
+{
+	return false;
+}
+
+std::uint64_t ticksToNanoseconds(std::uint64_t ticks) noexcept
+{
+	return ticks;
+}
+
+std::uint64_t now(unsigned& cpu) noexcept
+{
+	if constexpr (BuildConfiguration::contextSwitchDetection == BuildConfiguration::ContextSwitchDetection::CPU_MIGRATION) {
+		cpu = static_cast<unsigned>(::sched_getcpu());
+	}
+	return steadyClockNow();
+}
+
+#endif
+
 rusage getUsage()
 {
-	rusage result;
-	if constexpr (BuildConfiguration::discardTimingAcrossContextSwitch) {
-		if (getrusage(RUSAGE_SELF, &result) == -1) {
+	rusage result{};
+	if constexpr (BuildConfiguration::contextSwitchDetection == BuildConfiguration::ContextSwitchDetection::RUSAGE_THREAD) {
+		if (getrusage(RUSAGE_THREAD, &result) == -1) {
 			std::perror("getrusage");
 			std::exit(EXIT_FAILURE);
 		}
@@ -39,18 +135,40 @@ rusage getUsage()
 
 } // namespace
 
-Timer::Timer() noexcept : startUsage{getUsage()}, startTime{now()}
+Timer::Timer() noexcept : startUsage{getUsage()}, startCpu{0}, startTime{ArenaAllocator::now(startCpu)}
 {
 }
 
 std::chrono::nanoseconds Timer::getNanoseconds() const noexcept
 {
-	std::chrono::nanoseconds result{std::chrono::duration_cast<std::chrono::nanoseconds>(now() - startTime)};
-	if constexpr (BuildConfiguration::discardTimingAcrossContextSwitch) {
+	unsigned stopCpu{0};
+	std::chrono::nanoseconds result{getElapsed(startTime, ArenaAllocator::now(stopCpu))};
+	if constexpr (BuildConfiguration::contextSwitchDetection == BuildConfiguration::ContextSwitchDetection::RUSAGE_THREAD) {
 		rusage usage{getUsage()};
 		if (usage.ru_nvcsw > startUsage.ru_nvcsw || usage.ru_nivcsw > startUsage.ru_nivcsw) {
 			result = std::chrono::nanoseconds{0};
 		}
+	} else if constexpr (
+		BuildConfiguration::contextSwitchDetection == BuildConfiguration::ContextSwitchDetection::CPU_MIGRATION) {
+		if (stopCpu != startCpu) {
+			result = std::chrono::nanoseconds{0};
+		}
+	}
+	return result;
+}
+
+std::uint64_t Timer::now() noexcept
+{
+	unsigned cpu{0};
+	return ArenaAllocator::now(cpu);
+}
+
+std::chrono::nanoseconds Timer::getElapsed(std::uint64_t start, std::uint64_t stop) noexcept
+{
+	std::chrono::nanoseconds result{0};
+	if (stop > start) {
+		const std::uint64_t elapsed{useTsc() ? ticksToNanoseconds(stop - start) : stop - start};
+		result = std::chrono::nanoseconds{static_cast<std::chrono::nanoseconds::rep>(elapsed)};
 	}
 	return result;
 }
@@ -9,6 +9,7 @@
 #define ArenaAllocator_Timer_h_INCLUDED
 
 #include <chrono>
+#include <cstdint>
 #include <sys/resource.h>
 
 namespace ArenaAllocator {
@@ -16,15 +17,20 @@ namespace ArenaAllocator {
 class Timer
 {
 public:
-	using ClockType = std::chrono::steady_clock;
-
 	Timer() noexcept;
 
+	// Timings crossing a context switch, as detected according to BuildConfiguration::contextSwitchDetection, are
+	// reported as 0.
 	[[nodiscard]] std::chrono::nanoseconds getNanoseconds() const noexcept;
 
+	// Timestamps in units of the clock selected by BuildConfiguration::timerClock, convertible by getElapsed only.
+	[[nodiscard]] static std::uint64_t now() noexcept;
+	[[nodiscard]] static std::chrono::nanoseconds getElapsed(std::uint64_t start, std::uint64_t stop) noexcept;
+
 private:
 	rusage startUsage;
-	std::chrono::time_point<ClockType> startTime;
+	unsigned startCpu;
+	std::uint64_t startTime;
 };
 
 } // namespace ArenaAllocator
@@ -0,0 +1,279 @@
+//
+// Copyright (C) 2021 Dr. Michael Steffens
+//
+// SPDX-License-Identifier:     BSL-1.0
+//
+
+
+#ifndef ArenaAllocator_TraceWriter_h_INCLUDED
+#define ArenaAllocator_TraceWriter_h_INCLUDED
+
+#include "ArenaAllocator/BuildConfiguration.h"
+#include "ArenaAllocator/Console.h"
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <fcntl.h>
+#include <new>
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+extern "C" void* __libc_malloc(std::size_t size);
+
+namespace ArenaAllocator {
+
+// Appends binary records to per thread buffers, written to <binaryTraceDirectory>/ArenaAllocator-<pid>.<suffix> in a
+// single system call each. Every thread fills one half of its buffer while the other half is written by a background
+// thread, once started. Until then, or if the background thread falls behind, the appending thread writes the other half
+// itself before reusing it. Buffers are also written on thread exit and on flush. Each write is a block of HeaderT{
+// HeaderT::magic, nRecords, pid, tid} followed by the records. There must be at most one instance per record type.
+template<typename HeaderT, typename RecordT, std::size_t bufferRecords = 1024>
+class TraceWriter
+{
+public:
+	explicit TraceWriter(char const* suffix) noexcept : fd{openTraceFile(suffix)}, key{}, buffers{nullptr}, pending{}
+	{
+		if (::pthread_key_create(&key, &TraceWriter::releaseBuffer) != 0) {
+			Console::exit([] { return Message("TraceWriter failed to create thread specific key"); });
+		}
+		::sem_init(&pending, 0, 0);
+	}
+
+	TraceWriter(TraceWriter const&) = delete;
+	TraceWriter& operator=(TraceWriter const&) = delete;
+
+	// The semaphore is not destroyed, as the background thread may still be waiting for it.
+	~TraceWriter() noexcept
+	{
+		flush();
+		::pthread_key_delete(key);
+		::close(fd);
+	}
+
+	// Starts the background thread writing full buffer halves. It is not inherited by forked children.
+	void start() noexcept
+	{
+		::pthread_t thread;
+		::pthread_attr_t attributes;
+		::pthread_attr_init(&attributes);
+		::pthread_attr_setdetachstate(&attributes, PTHREAD_CREATE_DETACHED);
+		const int error{::pthread_create(&thread, &attributes, &TraceWriter::run, this)};
+		if (error != 0) {
+			// Appending threads keep writing their buffers themselves
+			errno = error;
+			std::perror("TraceWriter::start");
+		}
+		::pthread_attr_destroy(&attributes);
+	}
+
+	// Records are dropped rather than waiting for a concurrent flush to complete.
+	void append(RecordT const& record) const noexcept
+	{
+		Buffer* buffer{getBuffer()};
+		if (buffer != nullptr && !buffer->busy.exchange(true, std::memory_order_acquire)) {
+			Half& half{buffer->halves[buffer->current]};
+			if (half.nRecords == 0) {
+				half.pid = buffer->pid;
+				half.tid = buffer->tid;
+			}
+			half.records[half.nRecords++] = record;
+			if (half.nRecords == bufferRecords) {
+				half.state.store(HalfState::PENDING, std::memory_order_release);
+				::sem_post(&pending);
+				buffer->current ^= 1U;
+				reclaim(*buffer, buffer->halves[buffer->current]);
+			}
+			buffer->busy.store(false, std::memory_order_release);
+		}
+	}
+
+	// Writes the buffers of all threads not appending concurrently.
+	void flush() const noexcept
+	{
+		for (Buffer* buffer = buffers.load(std::memory_order_acquire); buffer != nullptr; buffer = buffer->next) {
+			if (!buffer->busy.exchange(true, std::memory_order_acquire)) {
+				writeAll(*buffer);
+				buffer->busy.store(false, std::memory_order_release);
+			}
+		}
+	}
+
+private:
+	// A half being filled is owned by the thread holding Buffer::busy, a pending one by whoever claims it for writing.
+	enum class HalfState : int { FILLING, PENDING, WRITING };
+
+	// Records tagged with the thread having appended them, as the buffer may have changed owners before they are written.
+	struct Half
+	{
+		std::atomic<HalfState> state{HalfState::FILLING};
+		::pid_t pid{0};
+		::pid_t tid{0};
+		std::size_t nRecords{0};
+		std::array<RecordT, bufferRecords> records{};
+	};
+
+	struct Buffer
+	{
+		TraceWriter const* owner{nullptr};
+		Buffer* next{nullptr};
+		std::atomic<bool> busy{false}; // Appending or writing the half being filled
+		std::atomic<bool> acquired{false}; // Assigned to a live thread
+		::pid_t pid{0}; // Of the owner, guarded by busy
+		::pid_t tid{0};
+		unsigned current{0}; // Index of the half being filled
+		std::array<Half, 2> halves{};
+	};
+
+	static int openTraceFile(char const* suffix) noexcept
+	{
+		char path[256];
+		std::snprintf(
+			path, sizeof(path), "%s/ArenaAllocator-%d.%s", BuildConfiguration::binaryTraceDirectory, ::getpid(), suffix);
+		int result{::open(path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644)};
+		if (result == -1) {
+			Console::exit([&] { return Message("TraceWriter failed to open {}", static_cast<char const*>(path)); });
+		}
+		return result;
+	}
+
+	// Buffers are never deallocated, but reused by threads started after their previous owner has exited.
+	Buffer* getBuffer() const noexcept
+	{
+		if (threadBuffer == nullptr) {
+			for (Buffer* buffer = buffers.load(std::memory_order_acquire); buffer != nullptr; buffer = buffer->next) {
+				bool expected{false};
+				if (buffer->acquired.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+					threadBuffer = buffer;
+					break;
+				}
+			}
+			if (threadBuffer == nullptr) {
+				void* memory{__libc_malloc(sizeof(Buffer))};
+				if (memory != nullptr) {
+					Buffer* buffer{new (memory) Buffer{}};
+					buffer->owner = this;
+					buffer->acquired.store(true, std::memory_order_relaxed);
+					buffer->next = buffers.load(std::memory_order_relaxed);
+					while (!buffers.compare_exchange_weak(buffer->next, buffer, std::memory_order_release)) {
+					}
+					threadBuffer = buffer;
+				}
+			}
+			if (threadBuffer != nullptr) {
+				lock(*threadBuffer);
+				threadBuffer->pid = ::getpid();
+				threadBuffer->tid = static_cast<::pid_t>(::syscall(SYS_gettid));
+				threadBuffer->busy.store(false, std::memory_order_release);
+				::pthread_setspecific(key, threadBuffer);
+			}
+		}
+		return threadBuffer;
+	}
+
+	// Waits for a concurrent flush to release Buffer::busy.
+	static void lock(Buffer& buffer) noexcept
+	{
+		while (buffer.busy.exchange(true, std::memory_order_acquire)) {
+			::sched_yield();
+		}
+	}
+
+	// Makes a half available for filling, writing it here if the background thread has not done so yet.
+	void reclaim(Buffer& buffer, Half& half) const noexcept
+	{
+		while (!writePending(buffer, half) && half.state.load(std::memory_order_acquire) != HalfState::FILLING) {
+			::sched_yield();
+		}
+	}
+
+	// Returns whether a pending half has been claimed and written.
+	bool writePending(Buffer& buffer, Half& half) const noexcept
+	{
+		HalfState expected{HalfState::PENDING};
+		const bool result{half.state.compare_exchange_strong(expected, HalfState::WRITING, std::memory_order_acquire)};
+		if (result) {
+			write(buffer, half);
+			half.state.store(HalfState::FILLING, std::memory_order_release);
+		}
+		return result;
+	}
+
+	// Writes the older pending half, if any, then the half being filled. Requires Buffer::busy.
+	void writeAll(Buffer& buffer) const noexcept
+	{
+		reclaim(buffer, buffer.halves[buffer.current ^ 1U]);
+		write(buffer, buffer.halves[buffer.current]);
+	}
+
+	void write(Buffer& buffer, Half& half) const noexcept
+	{
+		if (half.nRecords > 0) {
+			int propagateErrno{errno};
+			::pid_t pid{::getpid()};
+			if (half.pid != pid) {
+				// Forked child, continuing with the buffer of the parent thread. Only its owner writes the half being
+				// filled, as the background thread is not inherited.
+				half.pid = buffer.pid = pid;
+				half.tid = buffer.tid = static_cast<::pid_t>(::syscall(SYS_gettid));
+			}
+			HeaderT header{HeaderT::magic,
+						   static_cast<std::uint32_t>(half.nRecords),
+						   static_cast<std::uint32_t>(half.pid),
+						   static_cast<std::uint32_t>(half.tid)};
+			std::array<::iovec, 2> blocks{
+				::iovec{&header, sizeof(header)}, ::iovec{half.records.data(), half.nRecords * sizeof(RecordT)}};
+			if (::writev(fd, blocks.data(), blocks.size()) == -1) {
+				std::perror("TraceWriter::write");
+			}
+			half.nRecords = 0;
+			errno = propagateErrno;
+		}
+	}
+
+	static void* run(void* self) noexcept
+	{
+		TraceWriter const& writer{*static_cast<TraceWriter const*>(self)};
+		while (::sem_wait(&writer.pending) == 0 || errno == EINTR) {
+			for (Buffer* buffer = writer.buffers.load(std::memory_order_acquire); buffer != nullptr; buffer = buffer->next) {
+				for (Half& half : buffer->halves) {
+					writer.writePending(*buffer, half);
+				}
+			}
+		}
+		return nullptr;
+	}
+
+	// Drains both halves before the buffer can be acquired by another thread.
+	static void releaseBuffer(void* buffer) noexcept
+	{
+		Buffer* released{static_cast<Buffer*>(buffer)};
+		lock(*released);
+		released->owner->writeAll(*released);
+		released->busy.store(false, std::memory_order_release);
+		threadBuffer = nullptr;
+		released->acquired.store(false, std::memory_order_release);
+	}
+
+	// Initial exec TLS model, see ThreadShard.h
+	static thread_local Buffer* threadBuffer __attribute__((tls_model("initial-exec")));
+
+	int fd;
+	::pthread_key_t key;
+	mutable std::atomic<Buffer*> buffers;
+	mutable ::sem_t pending; // Posted for every half becoming pending
+};
+
+template<typename HeaderT, typename RecordT, std::size_t bufferRecords>
+thread_local typename TraceWriter<HeaderT, RecordT, bufferRecords>::Buffer*
+	TraceWriter<HeaderT, RecordT, bufferRecords>::threadBuffer __attribute__((tls_model("initial-exec")));
+
+} // namespace ArenaAllocator
+
+#endif // ArenaAllocator_TraceWriter_h_INCLUDED
@@ -7,9 +7,14 @@
 
 #include "ArenaAllocator/Allocator.h"
 #include "ArenaAllocator/Console.h"
+#include "ArenaAllocator/ControlChannel.h"
+#include "ArenaAllocator/Counters.h"
 #include "ArenaAllocator/EnvironmentConfiguration.h"
+#include "ArenaAllocator/Groups.h"
 #include "ArenaAllocator/InternalAllocatorFactory.h"
 #include "ArenaAllocator/InternalLoggerFactory.h"
+#include "ArenaAllocator/Phase.h"
+#include "ArenaAllocator/StatisticsPage.h"
 #include <cstdlib>
 #include <optional>
 #include <unistd.h>
@@ -26,6 +31,8 @@ public:
 	static ArenaAllocatorSingleton& getInstance() noexcept;
 	ArenaAllocator::Allocator& getAllocator() noexcept;
 	ArenaAllocator::Logger& getLogger() noexcept;
+	ArenaAllocator::InternalLoggerFactory& getLoggerFactory() noexcept;
+	ArenaAllocator::ControlChannel& getControlChannel() noexcept;
 
 private:
 	ArenaAllocatorSingleton() noexcept;
@@ -36,6 +43,7 @@ private:
 	ArenaAllocator::InternalAllocatorFactory allocatorFactory;
 	ArenaAllocator::InternalLoggerFactory loggerFactory;
 	ArenaAllocator::EnvironmentConfiguration configuration;
+	ArenaAllocator::ControlChannel controlChannel;
 };
 
 namespace {
@@ -83,12 +91,23 @@ ArenaAllocator::Logger& ArenaAllocatorSingleton::getLogger() noexcept
 	return *logger;
 }
 
+ArenaAllocator::InternalLoggerFactory& ArenaAllocatorSingleton::getLoggerFactory() noexcept
+{
+	return loggerFactory;
+}
+
+ArenaAllocator::ControlChannel& ArenaAllocatorSingleton::getControlChannel() noexcept
+{
+	return controlChannel;
+}
+
 ArenaAllocatorSingleton::ArenaAllocatorSingleton() noexcept :
 	pid{::getpid()},
 	allocator{nullptr},
 	allocatorFactory{configuration, logger},
 	logger{nullptr},
-	configuration{std::getenv("ARENA_ALLOCATOR_CONFIGURATION"), allocatorFactory, allocator, loggerFactory, logger}
+	configuration{std::getenv("ARENA_ALLOCATOR_CONFIGURATION"), allocatorFactory, allocator, loggerFactory, logger},
+	controlChannel{configuration.getControl(), *allocator, loggerFactory, *logger}
 {
 	logger->operator()(ArenaAllocator::LogLevel::DEBUG, [&] {
 		return ArenaAllocator::Message("ArenaAllocatorSingleton::ArenaAllocatorSingleton() -> this:{}", this);
@@ -99,8 +118,10 @@ ArenaAllocatorSingleton::ArenaAllocatorSingleton() noexcept :
 
 extern "C" void initializeArenaAllocator()
 {
-	Bootstrap::ArenaAllocatorSingleton::getInstance().getLogger()(
-		ArenaAllocator::LogLevel::DEBUG, [&] { return ArenaAllocator::Message("initializeArenaAllocator()"); });
+	Bootstrap::ArenaAllocatorSingleton& singleton{Bootstrap::ArenaAllocatorSingleton::getInstance()};
+	singleton.getLogger()(ArenaAllocator::LogLevel::DEBUG, [&] { return ArenaAllocator::Message("initializeArenaAllocator()"); });
+	singleton.getControlChannel().start();
+	singleton.getLoggerFactory().start();
 }
 
 extern "C" void finishArenaAllocator()
@@ -108,8 +129,29 @@ extern "C" void finishArenaAllocator()
 	if (Bootstrap::instance != nullptr) {
 		Bootstrap::instance->getLogger()(
 			ArenaAllocator::LogLevel::DEBUG, [&] { return ArenaAllocator::Message("finishArenaAllocator()"); });
-		Bootstrap::instance->getAllocator().dump();
+		Bootstrap::instance->getAllocator().dump(false);
+		Bootstrap::instance->getLoggerFactory().dump();
+	}
+	ArenaAllocator::StatisticsPage::finish();
+}
+
+extern "C" std::size_t arenaAllocatorGetCounters(
+	ArenaAllocator::PoolCounters* pools, std::size_t capacity, ArenaAllocator::DelegateCounters* delegate) noexcept
+{
+	if (delegate != nullptr) {
+		*delegate = ArenaAllocator::DelegateCounters{};
 	}
+	return Bootstrap::ArenaAllocatorSingleton::getInstance().getAllocator().getCounters(pools, capacity, delegate);
+}
+
+extern "C" int arenaAllocatorJoinGroup(char const* name) noexcept
+{
+	return name != nullptr && Bootstrap::ArenaAllocatorSingleton::getInstance().getAllocator().joinGroup(name) ? 0 : -1;
+}
+
+extern "C" int arenaAllocatorSwitchPhase() noexcept
+{
+	return Bootstrap::ArenaAllocatorSingleton::getInstance().getAllocator().switchPhase() ? 0 : -1;
 }
 
 extern "C" void* malloc(std::size_t size)
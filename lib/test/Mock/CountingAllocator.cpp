@@ -0,0 +1,76 @@
+//
+// Copyright (C) 2021 Dr. Michael Steffens
+//
+// SPDX-License-Identifier:     BSL-1.0
+//
+
+
+#include "Mock/CountingAllocator.h"
+
+namespace Mock {
+
+void* CountingAllocator::malloc(std::size_t) noexcept
+{
+	++allocations;
+	return nullptr;
+}
+
+void CountingAllocator::free(void*) noexcept
+{
+	++deallocations;
+}
+
+void* CountingAllocator::calloc(std::size_t, std::size_t) noexcept
+{
+	++allocations;
+	return nullptr;
+}
+
+void* CountingAllocator::realloc(void* ptr, std::size_t) noexcept
+{
+	++(ptr != nullptr ? reallocations : allocations);
+	return nullptr;
+}
+
+void* CountingAllocator::reallocarray(void* ptr, std::size_t, std::size_t) noexcept
+{
+	++(ptr != nullptr ? reallocations : allocations);
+	return nullptr;
+}
+
+int CountingAllocator::posix_memalign(void** memptr, std::size_t, std::size_t) noexcept
+{
+	++allocations;
+	*memptr = nullptr;
+	return 0;
+}
+
+void* CountingAllocator::aligned_alloc(std::size_t, std::size_t) noexcept
+{
+	++allocations;
+	return nullptr;
+}
+
+void* CountingAllocator::valloc(std::size_t) noexcept
+{
+	++allocations;
+	return nullptr;
+}
+
+void* CountingAllocator::memalign(std::size_t, std::size_t) noexcept
+{
+	++allocations;
+	return nullptr;
+}
+
+void* CountingAllocator::pvalloc(std::size_t) noexcept
+{
+	++allocations;
+	return nullptr;
+}
+
+void CountingAllocator::dump(bool) const noexcept
+{
+}
+
+} // namespace Mock
@@ -0,0 +1,43 @@
+//
+// Copyright (C) 2021 Dr. Michael Steffens
+//
+// SPDX-License-Identifier:     BSL-1.0
+//
+
+
+#ifndef Mock_CountingAllocator_h_INCLUDED
+#define Mock_CountingAllocator_h_INCLUDED
+
+#include "ArenaAllocator/Allocator.h"
+
+namespace Mock {
+
+// Counts the calls it receives, returning nullptr for all of them.
+class CountingAllocator : public ArenaAllocator::Allocator
+{
+public:
+	CountingAllocator() = default;
+	CountingAllocator(CountingAllocator const&) = delete;
+	CountingAllocator& operator=(CountingAllocator const&) = delete;
+	~CountingAllocator() override = default;
+
+	void* malloc(std::size_t) noexcept override;
+	void free(void*) noexcept override;
+	void* calloc(std::size_t, std::size_t) noexcept override;
+	void* realloc(void* ptr, std::size_t) noexcept override;
+	void* reallocarray(void* ptr, std::size_t, std::size_t) noexcept override;
+	int posix_memalign(void** memptr, std::size_t, std::size_t) noexcept override;
+	void* aligned_alloc(std::size_t, std::size_t) noexcept override;
+	void* valloc(std::size_t) noexcept override;
+	void* memalign(std::size_t, std::size_t) noexcept override;
+	void* pvalloc(std::size_t) noexcept override;
+	void dump(bool) const noexcept override;
+
+	std::size_t allocations{0}; // Calls allocating new memory, including realloc and reallocarray of nullptr
+	std::size_t reallocations{0}; // realloc and reallocarray of a pointer
+	std::size_t deallocations{0};
+};
+
+} // namespace Mock
+
+#endif // Mock_CountingAllocator_h_INCLUDED
@@ -0,0 +1,72 @@
+//
+// Copyright (C) 2021 Dr. Michael Steffens
+//
+// SPDX-License-Identifier:     BSL-1.0
+//
+
+
+#include "Mock/ParsedConfiguration.h"
+#include "ArenaAllocator/ParseConfiguration.h"
+
+namespace Mock {
+
+ParsedConfiguration::ParsedConfiguration(std::string_view str) noexcept
+{
+	ArenaAllocator::ParseConfiguration{str, pools, groups}(
+		className, logLevel, loggerName, sampling, control, profile, phase);
+}
+
+std::string_view const& ParsedConfiguration::getClass() const noexcept
+{
+	static constexpr std::string_view noClass{};
+	return className.has_value() ? className.value() : noClass;
+}
+
+ArenaAllocator::Configuration::PoolMapType const& ParsedConfiguration::getPools() const noexcept
+{
+	static const Configuration::PoolMapType noPools{};
+	return pools.has_value() ? pools.value() : noPools;
+}
+
+ArenaAllocator::LogLevel const& ParsedConfiguration::getLogLevel() const noexcept
+{
+	static constexpr ArenaAllocator::LogLevel none{ArenaAllocator::LogLevel::NONE};
+	return logLevel.has_value() ? logLevel.value() : none;
+}
+
+std::string_view const& ParsedConfiguration::getLogger() const noexcept
+{
+	static constexpr std::string_view noLogger{};
+	return loggerName.has_value() ? loggerName.value() : noLogger;
+}
+
+ArenaAllocator::Sampling const& ParsedConfiguration::getSampling() const noexcept
+{
+	static constexpr ArenaAllocator::Sampling recordAll{ArenaAllocator::Sampling::Mode::NONE, 0};
+	return sampling.has_value() ? sampling.value() : recordAll;
+}
+
+ArenaAllocator::Control const& ParsedConfiguration::getControl() const noexcept
+{
+	static constexpr ArenaAllocator::Control noControl{0, false, false};
+	return control.has_value() ? control.value() : noControl;
+}
+
+ArenaAllocator::Profile const& ParsedConfiguration::getProfile() const noexcept
+{
+	static constexpr ArenaAllocator::Profile noProfile{false, false};
+	return profile.has_value() ? profile.value() : noProfile;
+}
+
+ArenaAllocator::Phase const& ParsedConfiguration::getPhase() const noexcept
+{
+	static constexpr ArenaAllocator::Phase noPhase{0, 0};
+	return phase.has_value() ? phase.value() : noPhase;
+}
+
+ArenaAllocator::Configuration::PoolGroupsType const& ParsedConfiguration::getGroups() const noexcept
+{
+	return groups;
+}
+
+} // namespace Mock
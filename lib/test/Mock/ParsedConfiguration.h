@@ -0,0 +1,50 @@
+//
+// Copyright (C) 2021 Dr. Michael Steffens
+//
+// SPDX-License-Identifier:     BSL-1.0
+//
+
+
+#ifndef Mock_ParsedConfiguration_h_INCLUDED
+#define Mock_ParsedConfiguration_h_INCLUDED
+
+#include "ArenaAllocator/Configuration.h"
+#include <optional>
+
+namespace Mock {
+
+// Configuration parsed from a string, without creating allocator and logger. Items missing fall back to empty pools,
+// no groups, log level NONE, and the defaults of EnvironmentConfiguration otherwise.
+class ParsedConfiguration : public ArenaAllocator::Configuration
+{
+public:
+	explicit ParsedConfiguration(std::string_view str) noexcept;
+	ParsedConfiguration(ParsedConfiguration const&) = delete;
+	ParsedConfiguration& operator=(ParsedConfiguration const&) = delete;
+	~ParsedConfiguration() override = default;
+
+	[[nodiscard]] std::string_view const& getClass() const noexcept override;
+	[[nodiscard]] Configuration::PoolMapType const& getPools() const noexcept override;
+	[[nodiscard]] ArenaAllocator::LogLevel const& getLogLevel() const noexcept override;
+	[[nodiscard]] std::string_view const& getLogger() const noexcept override;
+	[[nodiscard]] ArenaAllocator::Sampling const& getSampling() const noexcept override;
+	[[nodiscard]] ArenaAllocator::Control const& getControl() const noexcept override;
+	[[nodiscard]] ArenaAllocator::Profile const& getProfile() const noexcept override;
+	[[nodiscard]] ArenaAllocator::Phase const& getPhase() const noexcept override;
+	[[nodiscard]] Configuration::PoolGroupsType const& getGroups() const noexcept override;
+
+private:
+	std::optional<std::string_view> className;
+	std::optional<Configuration::PoolMapType> pools;
+	std::optional<ArenaAllocator::LogLevel> logLevel;
+	std::optional<std::string_view> loggerName;
+	std::optional<ArenaAllocator::Sampling> sampling;
+	std::optional<ArenaAllocator::Control> control;
+	std::optional<ArenaAllocator::Profile> profile;
+	std::optional<ArenaAllocator::Phase> phase;
+	Configuration::PoolGroupsType groups;
+};
+
+} // namespace Mock
+
+#endif // Mock_ParsedConfiguration_h_INCLUDED
@@ -0,0 +1,103 @@
+//
+// Copyright (C) 2021 Dr. Michael Steffens
+//
+// SPDX-License-Identifier:     BSL-1.0
+//
+
+
+#include "gtest/gtest.h"
+
+#include "ArenaAllocator/FreeList.h"
+#include "Mock/NullLogger.h"
+#include <atomic>
+#include <map>
+#include <thread>
+#include <vector>
+
+class FreeListFixture : public ::testing::Test
+{
+protected:
+	static constexpr std::size_t nChunks{4096};
+
+	FreeListFixture() : testee{ArenaAllocator::SizeRange{1, 64}, nChunks, log}
+	{
+		testee.forEachChunk([&](ArenaAllocator::FreeList::ListType::iterator it) { chunks.emplace(it->data, it); });
+		testee.publish(&page);
+	}
+
+	std::vector<void*> allocate(std::size_t n)
+	{
+		std::vector<void*> result;
+		for (std::size_t i = 0; i < n; ++i) {
+			result.push_back(testee.allocate(32));
+		}
+		return result;
+	}
+
+	// Frees ptrs concurrently from nThreads threads, while the calling thread keeps taking the mutex. Frees finding it
+	// held end up on the remote free stack.
+	void freeConcurrently(std::vector<void*> const& ptrs, unsigned nThreads)
+	{
+		std::atomic<unsigned> nRunning{nThreads};
+		std::vector<std::thread> threads;
+		for (unsigned i = 0; i < nThreads; ++i) {
+			threads.emplace_back([&, i] {
+				for (std::size_t j = i; j < ptrs.size(); j += nThreads) {
+					testee.deallocate(chunks.at(ptrs[j]));
+				}
+				nRunning.fetch_sub(1);
+			});
+		}
+		ArenaAllocator::PoolCounters counters{};
+		while (nRunning.load() > 0) {
+			testee.getCounters(counters);
+		}
+		for (std::thread& thread : threads) {
+			thread.join();
+		}
+	}
+
+	// Expects the pool counters and the statistics page to agree.
+	void expectCounts(std::size_t free, std::size_t allocated)
+	{
+		ArenaAllocator::PoolCounters counters{};
+		testee.getCounters(counters);
+		EXPECT_EQ(free, counters.free);
+		EXPECT_EQ(allocated, counters.allocated);
+		EXPECT_EQ(free, page.free.load());
+		EXPECT_EQ(allocated, page.allocated.load());
+	}
+
+	Mock::NullLogger log;
+	ArenaAllocator::StatisticsPagePool page{};
+	ArenaAllocator::FreeList testee;
+	std::map<void*, ArenaAllocator::FreeList::ListType::const_iterator> chunks;
+};
+
+TEST_F(FreeListFixture, ConcurrentFreesAndDrain)
+{
+	std::vector<void*> ptrs{allocate(nChunks)};
+	ASSERT_EQ(nullptr, testee.allocate(32));
+	freeConcurrently(ptrs, 4);
+
+	// Chunks still pending on the remote free stack are counted as free by the page as well.
+	testee.countSpill();
+	expectCounts(nChunks, 0);
+	ArenaAllocator::PoolCounters counters{};
+	testee.getCounters(counters);
+	EXPECT_EQ(nChunks, counters.frees);
+
+	// Allocations drain the stack, returning all chunks to the free list.
+	ptrs = allocate(nChunks);
+	for (void* ptr : ptrs) {
+		EXPECT_NE(nullptr, ptr);
+	}
+	EXPECT_EQ(nullptr, testee.allocate(32));
+	expectCounts(0, nChunks);
+}
+
+int main(int argc, char* argv[])
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,91 @@
+//
+// Copyright (C) 2021 Dr. Michael Steffens
+//
+// SPDX-License-Identifier:     BSL-1.0
+//
+
+
+#include "gtest/gtest.h"
+
+#include "ArenaAllocator/LogLinearBuckets.h"
+#include <cstdint>
+#include <limits>
+
+using Buckets = ArenaAllocator::LogLinearBuckets<2>;
+using WideLinearBuckets = ArenaAllocator::LogLinearBuckets<3, 64>;
+
+template<typename BucketsT>
+void expectContiguous()
+{
+	EXPECT_EQ(0, BucketsT::getLowerBound(0));
+	for (std::size_t bucket = 1; bucket < BucketsT::nBuckets; ++bucket) {
+		const std::uint64_t first{BucketsT::getLowerBound(bucket)};
+		const std::uint64_t last{BucketsT::getUpperBound(bucket)};
+		ASSERT_EQ(BucketsT::getUpperBound(bucket - 1) + 1, first) << "bucket " << bucket;
+		ASSERT_LE(first, last) << "bucket " << bucket;
+		ASSERT_EQ(bucket, BucketsT::getBucket(first)) << "bucket " << bucket;
+		ASSERT_EQ(bucket, BucketsT::getBucket(last)) << "bucket " << bucket;
+	}
+}
+
+TEST(LogLinearBuckets, SmallValuesHaveOwnBuckets)
+{
+	for (std::uint64_t value = 0; value < 4; ++value) {
+		EXPECT_EQ(value, Buckets::getBucket(value));
+		EXPECT_EQ(value, Buckets::getLowerBound(value));
+		EXPECT_EQ(value, Buckets::getUpperBound(value));
+	}
+	for (std::uint64_t value = 0; value < 64; ++value) {
+		EXPECT_EQ(value, WideLinearBuckets::getBucket(value));
+	}
+}
+
+TEST(LogLinearBuckets, SubBucketsPerPowerOfTwo)
+{
+	EXPECT_EQ(4, Buckets::getBucket(4));
+	EXPECT_EQ(7, Buckets::getBucket(7));
+	EXPECT_EQ(8, Buckets::getBucket(8));
+	EXPECT_EQ(8, Buckets::getBucket(9));
+	EXPECT_EQ(9, Buckets::getBucket(10));
+	EXPECT_EQ(11, Buckets::getBucket(15));
+	EXPECT_EQ(12, Buckets::getBucket(16));
+	EXPECT_EQ(12, Buckets::getBucket(19));
+	EXPECT_EQ(13, Buckets::getBucket(20));
+
+	const std::size_t bucket{Buckets::getBucket(1000)};
+	EXPECT_EQ(896, Buckets::getLowerBound(bucket));
+	EXPECT_EQ(1023, Buckets::getUpperBound(bucket));
+
+	EXPECT_EQ(64, WideLinearBuckets::getBucket(64));
+	EXPECT_EQ(64, WideLinearBuckets::getBucket(71));
+	EXPECT_EQ(65, WideLinearBuckets::getBucket(72));
+	EXPECT_EQ(72, WideLinearBuckets::getBucket(128));
+}
+
+TEST(LogLinearBuckets, LargestValue)
+{
+	const std::size_t bucket{Buckets::getBucket(std::numeric_limits<std::uint64_t>::max())};
+	EXPECT_EQ(Buckets::nBuckets - 1, bucket);
+	EXPECT_EQ(std::numeric_limits<std::uint64_t>::max(), Buckets::getUpperBound(bucket));
+	EXPECT_EQ(WideLinearBuckets::nBuckets - 1, WideLinearBuckets::getBucket(std::numeric_limits<std::uint64_t>::max()));
+}
+
+TEST(LogLinearBuckets, BucketRangesAreContiguous)
+{
+	expectContiguous<Buckets>();
+	expectContiguous<WideLinearBuckets>();
+	expectContiguous<ArenaAllocator::LogLinearBuckets<0>>();
+}
+
+TEST(LogLinearBuckets, RuntimeParameters)
+{
+	for (std::size_t bucket = 0; bucket < WideLinearBuckets::nBuckets; ++bucket) {
+		ASSERT_EQ(WideLinearBuckets::getUpperBound(bucket), ArenaAllocator::getLogLinearUpperBound(bucket, 3, 6));
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,257 @@
+//
+// Copyright (C) 2021 Dr. Michael Steffens
+//
+// SPDX-License-Identifier:     BSL-1.0
+//
+
+
+#include "gtest/gtest.h"
+
+#include "ArenaAllocator/ParseConfiguration.h"
+
+class ParseConfigurationFixture : public ::testing::Test
+{
+protected:
+	void parse(std::string_view str)
+	{
+		ArenaAllocator::ParseConfiguration{str, pools, groups}(
+			className, logLevel, loggerName, sampling, control, profile, phase);
+	}
+
+	std::optional<ArenaAllocator::Configuration::PoolMapType> pools;
+	ArenaAllocator::Configuration::PoolGroupsType groups;
+	std::optional<std::string_view> className;
+	std::optional<ArenaAllocator::LogLevel> logLevel;
+	std::optional<std::string_view> loggerName;
+	std::optional<ArenaAllocator::Sampling> sampling;
+	std::optional<ArenaAllocator::Control> control;
+	std::optional<ArenaAllocator::Profile> profile;
+	std::optional<ArenaAllocator::Phase> phase;
+};
+
+TEST_F(ParseConfigurationFixture, AllocatorClass)
+{
+	parse("{class:SegregatedFreeLists}");
+	ASSERT_TRUE(className.has_value());
+	EXPECT_EQ("SegregatedFreeLists", *className);
+}
+
+TEST_F(ParseConfigurationFixture, AllocatorClassChain)
+{
+	parse("{class:SizeRangeStatistics(SegregatedFreeLists(PassThrough)),logLevel:INFO}");
+	ASSERT_TRUE(className.has_value());
+	EXPECT_EQ("SizeRangeStatistics(SegregatedFreeLists(PassThrough))", *className);
+	ASSERT_TRUE(logLevel.has_value());
+	EXPECT_EQ(ArenaAllocator::LogLevel::INFO, *logLevel);
+}
+
+TEST_F(ParseConfigurationFixture, AllocatorClassChainWithSpaces)
+{
+	parse("{ class: AllocationTrace( SegregatedFreeLists ) , logger: Console }");
+	ASSERT_TRUE(className.has_value());
+	EXPECT_EQ("AllocationTrace( SegregatedFreeLists )", *className);
+	ASSERT_TRUE(loggerName.has_value());
+	EXPECT_EQ("Console", *loggerName);
+}
+
+TEST_F(ParseConfigurationFixture, AllocatorClassChainUnbalanced)
+{
+	ASSERT_DEATH(
+		parse("{class:SizeRangeStatistics(SegregatedFreeLists(PassThrough)}"),
+		"ParseConfiguration: expected '.' at allocator delegate end");
+}
+
+TEST_F(ParseConfigurationFixture, AllocatorClassDuplicate)
+{
+	ASSERT_DEATH(
+		parse("{class:SegregatedFreeLists,class:PassThrough}"), "ParseConfiguration: duplicate allocator class item");
+}
+
+TEST_F(ParseConfigurationFixture, SamplingRate)
+{
+	parse("{sampling:{rate:100}}");
+	ASSERT_TRUE(sampling.has_value());
+	EXPECT_EQ(ArenaAllocator::Sampling::Mode::RATE, sampling->mode);
+	EXPECT_EQ(100, sampling->period);
+}
+
+TEST_F(ParseConfigurationFixture, SamplingInterval)
+{
+	parse("{sampling: { interval: 65536 }}");
+	ASSERT_TRUE(sampling.has_value());
+	EXPECT_EQ(ArenaAllocator::Sampling::Mode::INTERVAL, sampling->mode);
+	EXPECT_EQ(65536, sampling->period);
+}
+
+TEST_F(ParseConfigurationFixture, SamplingInvalidMode)
+{
+	ASSERT_DEATH(parse("{sampling:{ratio:100}}"), "ParseConfiguration: invalid sampling mode");
+}
+
+TEST_F(ParseConfigurationFixture, SamplingZeroPeriod)
+{
+	ASSERT_DEATH(parse("{sampling:{rate:0}}"), "ParseConfiguration: sampling period must be positive");
+}
+
+TEST_F(ParseConfigurationFixture, SamplingDuplicate)
+{
+	ASSERT_DEATH(parse("{sampling:{rate:10},sampling:{interval:10}}"), "ParseConfiguration: duplicate sampling item");
+}
+
+TEST_F(ParseConfigurationFixture, Control)
+{
+	parse("{control:{signal:10,socket:1}}");
+	ASSERT_TRUE(control.has_value());
+	EXPECT_EQ(10, control->signal);
+	EXPECT_TRUE(control->socket);
+}
+
+TEST_F(ParseConfigurationFixture, ControlEmpty)
+{
+	parse("{control:{}}");
+	ASSERT_TRUE(control.has_value());
+	EXPECT_EQ(0, control->signal);
+	EXPECT_FALSE(control->socket);
+	EXPECT_FALSE(control->page);
+}
+
+TEST_F(ParseConfigurationFixture, ControlPage)
+{
+	parse("{control:{page:1}}");
+	ASSERT_TRUE(control.has_value());
+	EXPECT_TRUE(control->page);
+	EXPECT_FALSE(control->socket);
+}
+
+TEST_F(ParseConfigurationFixture, ControlDuplicate)
+{
+	ASSERT_DEATH(parse("{control:{page:1},control:{socket:1}}"), "ParseConfiguration: duplicate control item");
+}
+
+TEST_F(ParseConfigurationFixture, ControlZeroSignal)
+{
+	ASSERT_DEATH(parse("{control:{signal:0}}"), "ParseConfiguration: control signal must be positive");
+}
+
+TEST_F(ParseConfigurationFixture, ControlInvalidChannel)
+{
+	ASSERT_DEATH(parse("{control:{fifo:1}}"), "ParseConfiguration: invalid control channel");
+}
+
+TEST_F(ParseConfigurationFixture, ProfileSizes)
+{
+	parse("{profile:{sizes:1}}");
+	ASSERT_TRUE(profile.has_value());
+	EXPECT_TRUE(profile->sizes);
+}
+
+TEST_F(ParseConfigurationFixture, ProfileThreads)
+{
+	parse("{profile:{threads:1}}");
+	ASSERT_TRUE(profile.has_value());
+	EXPECT_FALSE(profile->sizes);
+	EXPECT_TRUE(profile->threads);
+}
+
+TEST_F(ParseConfigurationFixture, ProfileSizesAndThreads)
+{
+	parse("{profile:{sizes:1, threads:1}}");
+	ASSERT_TRUE(profile.has_value());
+	EXPECT_TRUE(profile->sizes);
+	EXPECT_TRUE(profile->threads);
+}
+
+TEST_F(ParseConfigurationFixture, ProfileInvalidAspect)
+{
+	ASSERT_DEATH(parse("{profile:{bytes:1}}"), "ParseConfiguration: invalid profile aspect");
+}
+
+TEST_F(ParseConfigurationFixture, ProfileDuplicate)
+{
+	ASSERT_DEATH(parse("{profile:{sizes:1},profile:{sizes:0}}"), "ParseConfiguration: duplicate profile item");
+}
+
+TEST_F(ParseConfigurationFixture, Groups)
+{
+	parse("{pools:{[1,64]:10},groups:{rt:{threads:rt,pools:{[1,32]:4,[33,64]:2}},io:{pools:{[1,128]:8}}}}");
+	ASSERT_TRUE(pools.has_value());
+	EXPECT_EQ(1, pools->size());
+	ASSERT_EQ(2, groups.size());
+
+	ArenaAllocator::Configuration::PoolGroup& rt{groups.front()};
+	EXPECT_EQ("rt", rt.name);
+	EXPECT_EQ("rt", rt.threadPrefix);
+	ASSERT_EQ(2, rt.pools.size());
+	ASSERT_NE(nullptr, rt.pools.at(40));
+	EXPECT_EQ(2, *rt.pools.at(40));
+
+	ArenaAllocator::Configuration::PoolGroup& io{groups.back()};
+	EXPECT_EQ("io", io.name);
+	EXPECT_TRUE(io.threadPrefix.empty());
+	ASSERT_NE(nullptr, io.pools.at(100));
+	EXPECT_EQ(8, *io.pools.at(100));
+}
+
+TEST_F(ParseConfigurationFixture, GroupsReservedName)
+{
+	ASSERT_DEATH(
+		parse("{groups:{default:{pools:{[1,64]:10}}}}"), "ParseConfiguration: group name default is reserved for the pools item");
+}
+
+TEST_F(ParseConfigurationFixture, GroupsDuplicateName)
+{
+	ASSERT_DEATH(parse("{groups:{rt:{pools:{[1,64]:10}},rt:{pools:{[1,64]:10}}}}"), "ParseConfiguration: duplicate group name");
+}
+
+TEST_F(ParseConfigurationFixture, GroupsMissingPools)
+{
+	ASSERT_DEATH(parse("{groups:{rt:{threads:rt}}}"), "ParseConfiguration: missing group pools item");
+}
+
+TEST_F(ParseConfigurationFixture, GroupsInvalidItem)
+{
+	ASSERT_DEATH(parse("{groups:{rt:{pools:{[1,64]:10},priority:1}}}"), "ParseConfiguration: invalid group item");
+}
+
+TEST_F(ParseConfigurationFixture, GroupsOverlappingPools)
+{
+	ASSERT_DEATH(
+		parse("{groups:{rt:{pools:{[1,64]:10,[64,128]:10}}}}"), "ParseConfiguration: expected disjunct pool size ranges");
+}
+
+TEST_F(ParseConfigurationFixture, Phase)
+{
+	parse("{phase:{signal:12, seconds:30}}");
+	ASSERT_TRUE(phase.has_value());
+	EXPECT_EQ(12, phase->signal);
+	EXPECT_EQ(30, phase->seconds);
+}
+
+TEST_F(ParseConfigurationFixture, PhaseEmpty)
+{
+	parse("{phase:{}}");
+	ASSERT_TRUE(phase.has_value());
+	EXPECT_EQ(0, phase->signal);
+	EXPECT_EQ(0, phase->seconds);
+}
+
+TEST_F(ParseConfigurationFixture, PhaseZeroSignal)
+{
+	ASSERT_DEATH(parse("{phase:{signal:0}}"), "ParseConfiguration: phase signal must be positive");
+}
+
+TEST_F(ParseConfigurationFixture, PhaseInvalidTrigger)
+{
+	ASSERT_DEATH(parse("{phase:{allocations:1000}}"), "ParseConfiguration: invalid phase trigger");
+}
+
+TEST_F(ParseConfigurationFixture, PhaseDuplicate)
+{
+	ASSERT_DEATH(parse("{phase:{seconds:1},phase:{seconds:2}}"), "ParseConfiguration: duplicate phase item");
+}
+
+int main(int argc, char* argv[])
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,127 @@
+//
+// Copyright (C) 2021 Dr. Michael Steffens
+//
+// SPDX-License-Identifier:     BSL-1.0
+//
+
+
+#include "gtest/gtest.h"
+
+#include "ArenaAllocator/PhaseSwitch.h"
+#include "Mock/CountingAllocator.h"
+#include "Mock/NullLogger.h"
+#include "Mock/ParsedConfiguration.h"
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+class PhaseSwitchFixture : public ::testing::Test
+{
+protected:
+	void create(std::string const& str)
+	{
+		time = 0;
+		configurationStr = str;
+		configuration.emplace(configurationStr);
+		testee.emplace(*configuration, startup, delegate, log, getTime);
+	}
+
+	// Smallest power of two timestamp Timer considers at least the given time after timestamp 0.
+	static std::uint64_t after(std::chrono::seconds elapsed) noexcept
+	{
+		std::uint64_t result{1};
+		while (ArenaAllocator::Timer::getElapsed(0, result) < elapsed) {
+			result <<= 1U;
+		}
+		return result;
+	}
+
+	static std::uint64_t getTime() noexcept
+	{
+		return time;
+	}
+
+	static inline std::uint64_t time{0};
+
+	Mock::NullLogger log;
+	std::string configurationStr;
+	std::optional<Mock::ParsedConfiguration> configuration;
+	Mock::CountingAllocator startup;
+	Mock::CountingAllocator delegate;
+	std::optional<ArenaAllocator::PhaseSwitch> testee;
+};
+
+TEST_F(PhaseSwitchFixture, StartupAllocationsPassThrough)
+{
+	create("{}");
+
+	void* ptr{nullptr};
+	testee->malloc(16);
+	testee->calloc(2, 16);
+	testee->realloc(nullptr, 16);
+	testee->posix_memalign(&ptr, 64, 16);
+	testee->aligned_alloc(64, 64);
+	EXPECT_EQ(5, startup.allocations);
+	EXPECT_EQ(0, delegate.allocations);
+}
+
+TEST_F(PhaseSwitchFixture, DeallocationsGoToDelegate)
+{
+	create("{}");
+
+	int chunk{0};
+	testee->free(&chunk);
+	testee->realloc(&chunk, 16);
+	testee->reallocarray(&chunk, 2, 16);
+	EXPECT_EQ(1, delegate.deallocations);
+	EXPECT_EQ(2, delegate.reallocations);
+	EXPECT_EQ(0, startup.deallocations);
+	EXPECT_EQ(0, startup.reallocations);
+}
+
+TEST_F(PhaseSwitchFixture, SwitchPhase)
+{
+	create("{}");
+
+	testee->malloc(16);
+	EXPECT_TRUE(testee->switchPhase());
+	EXPECT_FALSE(testee->switchPhase());
+	testee->malloc(16);
+	testee->memalign(64, 16);
+	EXPECT_EQ(1, startup.allocations);
+	EXPECT_EQ(2, delegate.allocations);
+}
+
+TEST_F(PhaseSwitchFixture, SwitchPhaseBySignal)
+{
+	create("{phase:{signal:" + std::to_string(SIGUSR2) + "}}");
+
+	testee->malloc(16);
+	ASSERT_EQ(0, std::raise(SIGUSR2));
+	testee->malloc(16);
+	EXPECT_EQ(1, startup.allocations);
+	EXPECT_EQ(1, delegate.allocations);
+	EXPECT_FALSE(testee->switchPhase());
+}
+
+TEST_F(PhaseSwitchFixture, SwitchPhaseBySeconds)
+{
+	create("{phase:{seconds:1}}");
+
+	testee->malloc(16);
+	time = after(std::chrono::seconds{1}) / 2;
+	testee->malloc(16);
+	time = after(std::chrono::seconds{1});
+	testee->malloc(16);
+	EXPECT_EQ(2, startup.allocations);
+	EXPECT_EQ(1, delegate.allocations);
+	EXPECT_FALSE(testee->switchPhase());
+}
+
+int main(int argc, char* argv[])
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,106 @@
+//
+// Copyright (C) 2021 Dr. Michael Steffens
+//
+// SPDX-License-Identifier:     BSL-1.0
+//
+
+
+#include "gtest/gtest.h"
+
+#include "ArenaAllocator/PoolGroups.h"
+#include "Mock/NullLogger.h"
+#include "Mock/ParsedConfiguration.h"
+#include <pthread.h>
+#include <thread>
+#include <vector>
+
+class PoolGroupsFixture : public ::testing::Test
+{
+protected:
+	PoolGroupsFixture() :
+		configuration{"{pools:{[1,64]:4},groups:{rt:{threads:rt,pools:{[1,64]:2}},io:{pools:{[1,128]:2}}}}"},
+		defaultPools{configuration, log},
+		testee{configuration, defaultPools, log}
+	{
+		testee.forEachPoolMap([&](ArenaAllocator::PoolMap<ArenaAllocator::FreeList>& pools) { poolMaps.push_back(&pools); });
+	}
+
+	// Runs f on a thread of its own, as the group a thread is routed to is thread local state.
+	template<typename F>
+	static void runThread(char const* name, F f)
+	{
+		std::thread thread{[&] {
+			::pthread_setname_np(::pthread_self(), name);
+			f();
+		}};
+		thread.join();
+	}
+
+	// Pool map the calling thread is routed to, after running into its next name check.
+	ArenaAllocator::PoolMap<ArenaAllocator::FreeList>* getPools()
+	{
+		ArenaAllocator::PoolMap<ArenaAllocator::FreeList>* result{nullptr};
+		for (std::uint32_t i = 0; i <= ArenaAllocator::PoolGroups::maxNameCheckInterval; ++i) {
+			result = &testee.getPools();
+		}
+		return result;
+	}
+
+	Mock::NullLogger log;
+	Mock::ParsedConfiguration configuration;
+	ArenaAllocator::PoolMap<ArenaAllocator::FreeList> defaultPools;
+	ArenaAllocator::PoolGroups testee;
+	std::vector<ArenaAllocator::PoolMap<ArenaAllocator::FreeList>*> poolMaps;
+};
+
+TEST_F(PoolGroupsFixture, PoolMapsInGroupOrder)
+{
+	ASSERT_EQ(3, poolMaps.size());
+	EXPECT_EQ(&defaultPools, poolMaps[0]);
+	EXPECT_EQ(1, poolMaps[1]->size());
+	EXPECT_EQ(1, poolMaps[2]->size());
+	EXPECT_NE(poolMaps[1], poolMaps[2]);
+}
+
+TEST_F(PoolGroupsFixture, UnmatchedThreadUsesDefaultPools)
+{
+	runThread("ioWorker", [&] { EXPECT_EQ(&defaultPools, getPools()); });
+}
+
+TEST_F(PoolGroupsFixture, ThreadMatchedByNamePrefix)
+{
+	runThread("rtWorker", [&] { EXPECT_EQ(poolMaps[1], getPools()); });
+}
+
+TEST_F(PoolGroupsFixture, JoinGroupByName)
+{
+	runThread("worker", [&] {
+		ASSERT_TRUE(testee.join("io"));
+		EXPECT_EQ(poolMaps[2], getPools());
+		ASSERT_TRUE(testee.join(ArenaAllocator::PoolGroups::defaultGroupName));
+		EXPECT_EQ(&defaultPools, getPools());
+	});
+}
+
+TEST_F(PoolGroupsFixture, JoinedThreadIsNoLongerMatchedByName)
+{
+	runThread("rtWorker", [&] {
+		ASSERT_TRUE(testee.join(ArenaAllocator::PoolGroups::defaultGroupName));
+		EXPECT_EQ(&defaultPools, getPools());
+	});
+}
+
+TEST_F(PoolGroupsFixture, JoinUnknownGroup)
+{
+	runThread("worker", [&] {
+		ASSERT_TRUE(testee.join("io"));
+		EXPECT_FALSE(testee.join("db"));
+		EXPECT_EQ(poolMaps[2], getPools());
+	});
+}
+
+int main(int argc, char* argv[])
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,61 @@
+//
+// Copyright (C) 2021 Dr. Michael Steffens
+//
+// SPDX-License-Identifier:     BSL-1.0
+//
+
+
+#include "gtest/gtest.h"
+
+#include "ArenaAllocator/SizeHistogram.h"
+#include <limits>
+
+using ArenaAllocator::SizeHistogram;
+
+TEST(SizeHistogram, LinearBuckets)
+{
+	EXPECT_EQ(0, SizeHistogram::getBucket(0));
+	EXPECT_EQ(0, SizeHistogram::getBucket(1));
+	EXPECT_EQ(0, SizeHistogram::getBucket(16));
+	EXPECT_EQ(1, SizeHistogram::getBucket(17));
+	EXPECT_EQ(63, SizeHistogram::getBucket(1024));
+
+	const ArenaAllocator::SizeRange range{SizeHistogram::getBucketRange(1)};
+	EXPECT_EQ(17, range.first);
+	EXPECT_EQ(32, range.last);
+}
+
+TEST(SizeHistogram, PowerOfTwoUpperBounds)
+{
+	for (unsigned exponent = 4; exponent < 64; ++exponent) {
+		const std::size_t size{std::size_t{1} << exponent};
+		ASSERT_EQ(size, SizeHistogram::getBucketRange(SizeHistogram::getBucket(size)).last) << "size " << size;
+		ASSERT_EQ(size + 1, SizeHistogram::getBucketRange(SizeHistogram::getBucket(size + 1)).first) << "size " << size;
+	}
+}
+
+TEST(SizeHistogram, LargestSize)
+{
+	const std::size_t bucket{SizeHistogram::getBucket(std::numeric_limits<std::size_t>::max())};
+	EXPECT_EQ(SizeHistogram::nBuckets - 1, bucket);
+	EXPECT_EQ(std::numeric_limits<std::size_t>::max(), SizeHistogram::getBucketRange(bucket).last);
+}
+
+TEST(SizeHistogram, BucketRangesAreContiguous)
+{
+	EXPECT_EQ(1, SizeHistogram::getBucketRange(0).first);
+	for (std::size_t bucket = 1; bucket < SizeHistogram::nBuckets; ++bucket) {
+		const ArenaAllocator::SizeRange previous{SizeHistogram::getBucketRange(bucket - 1)};
+		const ArenaAllocator::SizeRange range{SizeHistogram::getBucketRange(bucket)};
+		ASSERT_EQ(previous.last + 1, range.first) << "bucket " << bucket;
+		ASSERT_LE(range.first, range.last) << "bucket " << bucket;
+		ASSERT_EQ(bucket, SizeHistogram::getBucket(range.first)) << "bucket " << bucket;
+		ASSERT_EQ(bucket, SizeHistogram::getBucket(range.last)) << "bucket " << bucket;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
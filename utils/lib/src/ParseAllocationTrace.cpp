@@ -0,0 +1,180 @@
+#include "ParseAllocationTrace.h"
+#include <charconv>
+#include <limits>
+#include <string>
+
+ParseAllocationTrace::Error::Error(std::string_view message) noexcept : std::runtime_error{std::string{message}}
+{
+}
+
+ParseAllocationTrace::ParseAllocationTrace(std::string_view str) noexcept :
+	Static::ParsePrimitives{getMessage(str)}, prefix{getPrefix(str)}
+{
+}
+
+void ParseAllocationTrace::operator()(Result& result)
+{
+	result = Result{parsePid(), ArenaAllocator::OperationType::UNKNOWN, 0, 0, 0};
+	if (parseIdentifier() != "PassThrough") {
+		raiseError("expected 'PassThrough' log line message prefix");
+	}
+	if (parseDelimiter(":") != ':' || parseDelimiter(":") != ':') {
+		raiseError("expected '::' after class name");
+	}
+	result.operationType = parseOperationType();
+	if (parseDelimiter("(") != '(') {
+		raiseError("expected '(' at argument list begin");
+	}
+	switch (result.operationType) {
+	case ArenaAllocator::OperationType::MALLOC:
+	case ArenaAllocator::OperationType::VALLOC:
+	case ArenaAllocator::OperationType::PVALLOC:
+		result.size = parseSize();
+		parseResultPointer(result);
+		break;
+	case ArenaAllocator::OperationType::FREE:
+		result.ptr = parsePointer();
+		if (parseDelimiter(")") != ')') {
+			raiseError("expected ')' at argument list end");
+		}
+		break;
+	case ArenaAllocator::OperationType::CALLOC:
+		result.size = parseArraySize();
+		parseResultPointer(result);
+		break;
+	case ArenaAllocator::OperationType::REALLOC:
+		result.ptr = parsePointer();
+		parseSeparator();
+		result.size = parseSize();
+		parseResultPointer(result);
+		break;
+	case ArenaAllocator::OperationType::REALLOCARRAY:
+		result.ptr = parsePointer();
+		parseSeparator();
+		result.size = parseArraySize();
+		parseResultPointer(result);
+		break;
+	case ArenaAllocator::OperationType::POSIX_MEMALIGN:
+		if (parseDelimiter("&") != '&') {
+			raiseError("expected '&' before memptr argument");
+		}
+		result.allocated = parsePointer();
+		parseSeparator();
+		parseSize();
+		parseSeparator();
+		result.size = parseSize();
+		if (parseDelimiter(")") != ')' || parseDelimiter("-") != '-' || parseDelimiter(">") != '>') {
+			raiseError("expected ') ->' after argument list");
+		}
+		if (parse<int>() != 0) {
+			result.allocated = 0;
+		}
+		break;
+	case ArenaAllocator::OperationType::ALIGNED_ALLOC:
+	case ArenaAllocator::OperationType::MEMALIGN:
+		parseSize();
+		parseSeparator();
+		result.size = parseSize();
+		parseResultPointer(result);
+		break;
+	default:
+		raiseError("unexpected operation type");
+	}
+	skipSpaceChars();
+	if (!empty()) {
+		raiseError("unexpected character at log line end");
+	}
+}
+
+std::string_view ParseAllocationTrace::getPrefix(std::string_view str) noexcept
+{
+	return str.substr(0, str.find('\t'));
+}
+
+std::string_view ParseAllocationTrace::getMessage(std::string_view str) noexcept
+{
+	std::size_t pos{str.rfind('\t')};
+	return pos == std::string_view::npos ? std::string_view{} : str.substr(pos + 1);
+}
+
+::pid_t ParseAllocationTrace::parsePid() const
+{
+	constexpr std::string_view pidPrefix{"[pid:"};
+	::pid_t result{0};
+	if (prefix.substr(0, pidPrefix.size()) != pidPrefix || prefix.back() != ']' ||
+		std::from_chars(prefix.data() + pidPrefix.size(), prefix.data() + prefix.size() - 1, result).ec != std::errc{}) {
+		throw Error{"expected '[pid:<pid>]' log line prefix"};
+	}
+	return result;
+}
+
+ArenaAllocator::OperationType ParseAllocationTrace::parseOperationType()
+{
+	std::string_view operationTypeStr{parseIdentifier()};
+	ArenaAllocator::OperationType result{ArenaAllocator::OperationType::UNKNOWN};
+	for (unsigned typeIndex{0}; typeIndex != static_cast<unsigned>(ArenaAllocator::OperationType::UNKNOWN); ++typeIndex) {
+		ArenaAllocator::OperationType operationType{typeIndex};
+		if (operationTypeStr == to_string(operationType)) {
+			result = operationType;
+			break;
+		}
+	}
+	return result;
+}
+
+// Pointers are formatted either as "(nil)" or as hexadecimal number with "0x" prefix.
+std::uintptr_t ParseAllocationTrace::parsePointer()
+{
+	std::uintptr_t result{0};
+	if (parseDelimiter("(") == '(') {
+		if (parseIdentifier() != "nil" || parseDelimiter(")") != ')') {
+			raiseError("expected '(nil)' null pointer");
+		}
+	} else {
+		if (parse<unsigned>() != 0) {
+			raiseError("expected '0x' pointer prefix");
+		}
+		std::string_view digits{parseIdentifier()};
+		if (digits.size() < 2 || digits.front() != 'x' ||
+			std::from_chars(digits.data() + 1, digits.data() + digits.size(), result, 16).ec != std::errc{}) {
+			raiseError("expected hexadecimal pointer");
+		}
+	}
+	return result;
+}
+
+std::size_t ParseAllocationTrace::parseSize()
+{
+	return parse<std::size_t>();
+}
+
+std::size_t ParseAllocationTrace::parseArraySize()
+{
+	std::size_t nmemb{parseSize()};
+	parseSeparator();
+	std::size_t size{parseSize()};
+	if (size > 0 && nmemb > std::numeric_limits<std::size_t>::max() / size) {
+		raiseError("nmemb * size overflows");
+	}
+	return nmemb * size;
+}
+
+void ParseAllocationTrace::parseResultPointer(Result& result)
+{
+	if (parseDelimiter(")") != ')' || parseDelimiter("-") != '-' || parseDelimiter(">") != '>') {
+		raiseError("expected ') ->' after argument list");
+	}
+	result.allocated = parsePointer();
+}
+
+void ParseAllocationTrace::parseSeparator()
+{
+	if (parseDelimiter(",") != ',') {
+		raiseError("expected ',' argument separator");
+	}
+}
+
+void ParseAllocationTrace::raiseError(std::string_view message)
+{
+	throw Error{message};
+}
@@ -0,0 +1,52 @@
+#ifndef ParseAllocationTrace_h_INCLUDED
+#define ParseAllocationTrace_h_INCLUDED
+
+#include <ArenaAllocator/OperationType.h>
+#include <Static/ParsePrimitives.h>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <sys/types.h>
+
+// Parses PassThrough log lines of log level TRACE and Console logger, e.g.
+// [pid:4711]	523ns	PassThrough::realloc(0x55a5176ea3a0, 42) -> 0x7f046c000dd0
+class ParseAllocationTrace : public Static::ParsePrimitives
+{
+public:
+	class Error : public std::runtime_error
+	{
+	public:
+		Error(std::string_view message) noexcept;
+		~Error() noexcept override = default;
+	};
+
+	struct Result
+	{
+		::pid_t pid;
+		ArenaAllocator::OperationType operationType;
+		std::uintptr_t ptr; // Deallocated or reallocated, 0 if none
+		std::size_t size; // Requested, 0 if none
+		std::uintptr_t allocated; // 0 if none
+	};
+
+	ParseAllocationTrace(std::string_view str) noexcept;
+	~ParseAllocationTrace() noexcept override = default;
+
+	void operator()(Result& result);
+
+private:
+	static std::string_view getPrefix(std::string_view str) noexcept;
+	static std::string_view getMessage(std::string_view str) noexcept;
+	::pid_t parsePid() const;
+	ArenaAllocator::OperationType parseOperationType();
+	std::uintptr_t parsePointer();
+	std::size_t parseSize();
+	std::size_t parseArraySize();
+	void parseResultPointer(Result& result);
+	void parseSeparator();
+	[[noreturn]] void raiseError(std::string_view message) override;
+
+	const std::string_view prefix;
+};
+
+#endif // ParseAllocationTrace_h_INCLUDED
@@ -0,0 +1,99 @@
+#include "ParsePoolStatistics.h"
+#include <string>
+
+ParsePoolStatistics::Error::Error(std::string_view message) noexcept : std::runtime_error{std::string{message}}
+{
+}
+
+ParsePoolStatistics::ParsePoolStatistics(std::string_view str) noexcept : Static::ParsePrimitives{skipPidPrefix(str)}
+{
+}
+
+void ParsePoolStatistics::operator()(Result& result)
+{
+	result = Result{};
+	result.range = parseSizeRange();
+	if (parseDelimiter(":") != ':') {
+		raiseError("expected ':' after pool size range");
+	}
+	parseItems(result, {});
+	if (result.range.first > result.range.last) {
+		raiseError("pool size range first greater than last");
+	}
+	skipSpaceChars();
+	if (!empty()) {
+		raiseError("unexpected character after '}' at log line end");
+	}
+}
+
+std::string_view ParsePoolStatistics::skipPidPrefix(std::string_view str) noexcept
+{
+	if (str.substr(0, 5) == "[pid:") {
+		std::size_t end{str.find(']')};
+		str.remove_prefix(end == std::string_view::npos ? str.size() : end + 1);
+	}
+	return str;
+}
+
+ArenaAllocator::SizeRange ParsePoolStatistics::parseSizeRange()
+{
+	ArenaAllocator::SizeRange result{};
+	if (parseDelimiter("[") != '[') {
+		raiseError("expected '[' at size range begin");
+	}
+	result.first = parse<std::size_t>();
+	if (parseDelimiter(",") != ',') {
+		raiseError("expected ',' separating size range first and last");
+	}
+	result.last = parse<std::size_t>();
+	if (parseDelimiter("]") != ']') {
+		raiseError("expected ']' at size range end");
+	}
+	return result;
+}
+
+void ParsePoolStatistics::parseItems(Result& result, std::string_view context)
+{
+	if (parseDelimiter("{") != '{') {
+		raiseError("expected '{' at item list begin");
+	}
+	bool hasHwm{!context.empty()};
+	char delimiter{parseDelimiter("}")};
+	while (delimiter != '}') {
+		std::string_view item{parseIdentifier()};
+		if (parseDelimiter(":") != ':') {
+			raiseError("expected ':' after item identifier");
+		}
+		if (item == "sampled" || item == "confidence95") {
+			parseItems(result, item);
+		} else if (context == "confidence95") {
+			ArenaAllocator::SizeRange interval{parseSizeRange()};
+			if (item == "hwm") {
+				result.hwmUpperBound = interval.last;
+			}
+		} else {
+			std::size_t value{parse<std::size_t>()};
+			if (context.empty()) {
+				if (item == "hwm") {
+					result.hwm = value;
+					hasHwm = true;
+				} else if (item == "minSize") {
+					result.minSize = value;
+				} else if (item == "maxSize") {
+					result.maxSize = value;
+				}
+			}
+		}
+		if ((delimiter = parseDelimiter(",}")) == 0) {
+			raiseError("expected ',' item delimiter");
+		}
+	}
+	if (!hasHwm) {
+		raiseError("expected hwm item");
+	}
+}
+
+void ParsePoolStatistics::raiseError(std::string_view message)
+{
+	throw Error{message};
+}
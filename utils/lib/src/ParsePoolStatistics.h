@@ -0,0 +1,44 @@
+#ifndef ParsePoolStatistics_h_INCLUDED
+#define ParsePoolStatistics_h_INCLUDED
+
+#include <ArenaAllocator/SizeRange.h>
+#include <Static/ParsePrimitives.h>
+#include <cstddef>
+#include <optional>
+#include <stdexcept>
+
+// Parses pool lines of SizeRangeStatistics and SegregatedFreeLists dumps, optionally prefixed by [pid:<pid>], e.g.
+// [17, 32]: {limit: 512, allocations: 3, minSize: 17, maxSize: 30, hwm: 42}
+// [17, 32]: {free: 470, allocated: 42, hwm: 42}
+class ParsePoolStatistics : public Static::ParsePrimitives
+{
+public:
+	class Error : public std::runtime_error
+	{
+	public:
+		Error(std::string_view message) noexcept;
+		~Error() noexcept override = default;
+	};
+
+	struct Result
+	{
+		ArenaAllocator::SizeRange range;
+		std::size_t hwm;
+		std::optional<std::size_t> minSize; // SizeRangeStatistics only
+		std::optional<std::size_t> maxSize; // SizeRangeStatistics only
+		std::optional<std::size_t> hwmUpperBound; // SizeRangeStatistics sampling only
+	};
+
+	ParsePoolStatistics(std::string_view str) noexcept;
+	~ParsePoolStatistics() noexcept override = default;
+
+	void operator()(Result& result);
+
+private:
+	static std::string_view skipPidPrefix(std::string_view str) noexcept;
+	ArenaAllocator::SizeRange parseSizeRange();
+	void parseItems(Result& result, std::string_view context);
+	[[noreturn]] void raiseError(std::string_view message) override;
+};
+
+#endif // ParsePoolStatistics_h_INCLUDED
@@ -1,4 +1,5 @@
 #include "ParseTimeTrace.h"
+#include <charconv>
 #include <string>
 
 ParseTimeTrace::Error::Error(std::string_view message) noexcept : std::runtime_error{std::string{message}}
@@ -41,6 +42,37 @@ void ParseTimeTrace::operator()(::pid_t& pid, ArenaAllocator::OperationType& ope
 	}
 }
 
+bool ParseTimeTrace::scan(
+	std::string_view line, ::pid_t& pid, ArenaAllocator::OperationType& operationType, unsigned long& nanoseconds) noexcept
+{
+	constexpr std::string_view pidPrefix{"[pid:"};
+	constexpr std::string_view entryPrefix{"]\tTimeTrace:"};
+	bool result{false};
+	if (line.substr(0, pidPrefix.size()) == pidPrefix) {
+		char const* const end{line.data() + line.size()};
+		std::from_chars_result pidResult{std::from_chars(line.data() + pidPrefix.size(), end, pid)};
+		std::string_view rest{pidResult.ptr, static_cast<std::size_t>(end - pidResult.ptr)};
+		if (pidResult.ec == std::errc{} && rest.substr(0, entryPrefix.size()) == entryPrefix) {
+			rest.remove_prefix(entryPrefix.size());
+			const std::size_t comma{rest.find(',')};
+			if (comma != std::string_view::npos) {
+				const std::string_view operationTypeStr{rest.substr(0, comma)};
+				operationType = ArenaAllocator::OperationType::UNKNOWN;
+				for (unsigned typeIndex{0}; typeIndex != static_cast<unsigned>(ArenaAllocator::OperationType::UNKNOWN);
+					 ++typeIndex) {
+					if (operationTypeStr == to_string(ArenaAllocator::OperationType{typeIndex})) {
+						operationType = ArenaAllocator::OperationType{typeIndex};
+						break;
+					}
+				}
+				std::from_chars_result nanosecondsResult{std::from_chars(rest.data() + comma + 1, end, nanoseconds)};
+				result = nanosecondsResult.ec == std::errc{} && nanosecondsResult.ptr == end;
+			}
+		}
+	}
+	return result;
+}
+
 ArenaAllocator::OperationType ParseTimeTrace::parseOperationType()
 {
 	std::string_view operationTypeStr{parseIdentifier()};
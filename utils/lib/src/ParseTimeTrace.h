@@ -21,6 +21,10 @@ public:
 
 	void operator()(::pid_t& pid, ArenaAllocator::OperationType& operationType, unsigned long& nanoseconds);
 
+	// Fast path for lines exactly as written by the TimeTrace logger, returning false rather than raising errors.
+	static bool scan(
+		std::string_view line, ::pid_t& pid, ArenaAllocator::OperationType& operationType, unsigned long& nanoseconds) noexcept;
+
 private:
 	ArenaAllocator::OperationType parseOperationType();
 	[[noreturn]] void raiseError(std::string_view message) override;
@@ -0,0 +1,29 @@
+//
+// Copyright (C) 2021 Dr. Michael Steffens
+//
+// SPDX-License-Identifier:     BSL-1.0
+//
+
+
+#include "ProcStatus.h"
+#include <cstdlib>
+#include <fstream>
+
+std::size_t getProcStatusKiB(std::string const& field)
+{
+	std::size_t result{0};
+	std::ifstream status{"/proc/self/status"};
+	for (std::string line; std::getline(status, line);) {
+		if (line.compare(0, field.size() + 1, field + ":") == 0) {
+			result = std::strtoul(line.c_str() + field.size() + 1, nullptr, 10);
+			break;
+		}
+	}
+	return result;
+}
+
+void resetPeakRss()
+{
+	std::ofstream clearRefs{"/proc/self/clear_refs"};
+	clearRefs << "5" << std::endl;
+}
@@ -0,0 +1,20 @@
+//
+// Copyright (C) 2021 Dr. Michael Steffens
+//
+// SPDX-License-Identifier:     BSL-1.0
+//
+
+
+#ifndef ProcStatus_h_INCLUDED
+#define ProcStatus_h_INCLUDED
+
+#include <cstddef>
+#include <string>
+
+// Reads a field of /proc/self/status in kB, 0 if not available.
+std::size_t getProcStatusKiB(std::string const& field);
+
+// Resets VmHWM to the current VmRSS, see proc(5).
+void resetPeakRss();
+
+#endif // ProcStatus_h_INCLUDED
@@ -0,0 +1,154 @@
+//
+// Copyright (C) 2021 Dr. Michael Steffens
+//
+// SPDX-License-Identifier:     BSL-1.0
+//
+
+
+#include "SizeDistribution.h"
+#include "ParseAllocationTrace.h"
+#include "ParsePoolStatistics.h"
+#include <ArenaAllocator/AllocationTraceFormat.h>
+#include <algorithm>
+#include <limits>
+#include <string>
+
+SizeDistribution SizeDistribution::fixed(std::size_t size)
+{
+	return SizeDistribution{Mode::FIXED, size};
+}
+
+SizeDistribution SizeDistribution::uniform(std::size_t maxSize)
+{
+	SizeDistribution result{Mode::UNIFORM, std::max(maxSize, std::size_t{1})};
+	result.uniformSize = std::uniform_int_distribution<std::size_t>{1, result.maxSize};
+	return result;
+}
+
+SizeDistribution SizeDistribution::geometric(std::size_t maxSize)
+{
+	SizeDistribution result{Mode::GEOMETRIC, std::max(maxSize, std::size_t{1})};
+	// Failures before the first success have mean 1 / p - 1, p kept below 1 as required by std::geometric_distribution.
+	result.geometricSize = std::geometric_distribution<std::size_t>{8.0 / std::max(result.maxSize, std::size_t{9})};
+	return result;
+}
+
+SizeDistribution SizeDistribution::zipf(std::size_t maxSize)
+{
+	SizeDistribution result{Mode::ZIPF, std::max(maxSize, std::size_t{1})};
+	std::vector<double> weights(result.maxSize);
+	for (std::size_t size = 1; size <= result.maxSize; ++size) {
+		weights[size - 1] = 1.0 / size;
+	}
+	result.zipfSize = std::discrete_distribution<std::size_t>{weights.begin(), weights.end()};
+	return result;
+}
+
+std::optional<SizeDistribution> SizeDistribution::fromName(
+	std::string_view name, std::size_t fixedSize, std::size_t maxSize)
+{
+	std::optional<SizeDistribution> result;
+	if (name == "fixed") {
+		result = fixed(fixedSize);
+	} else if (name == "uniform") {
+		result = uniform(maxSize);
+	} else if (name == "geometric") {
+		result = geometric(maxSize);
+	} else if (name == "zipf") {
+		result = zipf(maxSize);
+	}
+	return result;
+}
+
+SizeDistribution SizeDistribution::fromDump(std::istream& in)
+{
+	SizeDistribution result{Mode::RANGES, 0};
+	std::vector<double> weights;
+	for (std::string line; std::getline(in, line);) {
+		try {
+			ParsePoolStatistics::Result statistics;
+			ParsePoolStatistics{line}(statistics);
+			const std::size_t first{statistics.minSize.value_or(statistics.range.first)};
+			const std::size_t last{statistics.maxSize.value_or(statistics.range.last)};
+			if (statistics.hwm > 0 && last != std::numeric_limits<std::size_t>::max()) {
+				result.ranges.emplace_back(first, last);
+				weights.push_back(static_cast<double>(statistics.hwm));
+			}
+		} catch (ParsePoolStatistics::Error&) {
+		}
+	}
+	result.rangeIndex = std::discrete_distribution<std::size_t>{weights.begin(), weights.end()};
+	return result;
+}
+
+SizeDistribution SizeDistribution::fromTrace(std::istream& in)
+{
+	SizeDistribution result{Mode::SAMPLES, 0};
+	ArenaAllocator::AllocationTraceHeader header{};
+	if (in.read(reinterpret_cast<char*>(&header), sizeof(header)) &&
+		header.blockMagic == ArenaAllocator::AllocationTraceHeader::magic) {
+		std::vector<ArenaAllocator::AllocationTraceRecord> records;
+		do {
+			records.resize(header.nRecords);
+			in.read(reinterpret_cast<char*>(records.data()), records.size() * sizeof(ArenaAllocator::AllocationTraceRecord));
+			for (ArenaAllocator::AllocationTraceRecord const& record : records) {
+				if (record.id != 0 && record.operationType != static_cast<unsigned>(ArenaAllocator::OperationType::FREE)) {
+					result.samples.push_back(record.nmemb * record.size);
+				}
+			}
+		} while (in.read(reinterpret_cast<char*>(&header), sizeof(header)) &&
+				 header.blockMagic == ArenaAllocator::AllocationTraceHeader::magic);
+	} else {
+		in.clear();
+		in.seekg(0);
+		for (std::string line; std::getline(in, line);) {
+			try {
+				ParseAllocationTrace::Result allocation;
+				ParseAllocationTrace{line}(allocation);
+				if (allocation.allocated != 0) {
+					result.samples.push_back(allocation.size);
+				}
+			} catch (ParseAllocationTrace::Error&) {
+			}
+		}
+	}
+	result.sampleIndex = std::uniform_int_distribution<std::size_t>{0, std::max(result.samples.size(), std::size_t{1}) - 1};
+	return result;
+}
+
+bool SizeDistribution::empty() const noexcept
+{
+	return (mode == Mode::RANGES && ranges.empty()) || (mode == Mode::SAMPLES && samples.empty());
+}
+
+std::size_t SizeDistribution::operator()(std::mt19937& gen)
+{
+	std::size_t result{0};
+	switch (mode) {
+	case Mode::FIXED:
+		result = maxSize;
+		break;
+	case Mode::UNIFORM:
+		result = uniformSize(gen);
+		break;
+	case Mode::GEOMETRIC:
+		result = std::min(geometricSize(gen) + 1, maxSize);
+		break;
+	case Mode::ZIPF:
+		result = zipfSize(gen) + 1;
+		break;
+	case Mode::RANGES: {
+		auto const& [first, last]{ranges[rangeIndex(gen)]};
+		result = std::uniform_int_distribution<std::size_t>{first, last}(gen);
+		break;
+	}
+	case Mode::SAMPLES:
+		result = samples[sampleIndex(gen)];
+		break;
+	}
+	return result;
+}
+
+SizeDistribution::SizeDistribution(Mode mode, std::size_t maxSize) noexcept : mode{mode}, maxSize{maxSize}
+{
+}
@@ -0,0 +1,64 @@
+//
+// Copyright (C) 2021 Dr. Michael Steffens
+//
+// SPDX-License-Identifier:     BSL-1.0
+//
+
+
+#ifndef SizeDistribution_h_INCLUDED
+#define SizeDistribution_h_INCLUDED
+
+#include <cstddef>
+#include <istream>
+#include <optional>
+#include <random>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Sizes of allocations, drawn either from a parametric distribution or from the empirical distribution of a
+// SizeRangeStatistics dump or an allocation trace. Parametric sizes are within [1, maxSize].
+class SizeDistribution
+{
+public:
+	static SizeDistribution fixed(std::size_t size);
+	static SizeDistribution uniform(std::size_t maxSize);
+	// Mean about maxSize / 8, truncated at maxSize
+	static SizeDistribution geometric(std::size_t maxSize);
+	// P(size) proportional to 1 / size
+	static SizeDistribution zipf(std::size_t maxSize);
+	// Parametric distribution fixed, uniform, geometric or zipf, none if name is unknown.
+	static std::optional<SizeDistribution> fromName(std::string_view name, std::size_t fixedSize, std::size_t maxSize);
+	// Size ranges weighted by their hwm, uniform within [minSize, maxSize] of each range.
+	static SizeDistribution fromDump(std::istream& in);
+	// Requested sizes of allocating operations in a PassThrough TRACE log or an AllocationTrace file.
+	static SizeDistribution fromTrace(std::istream& in);
+
+	bool empty() const noexcept;
+	std::size_t operator()(std::mt19937& gen);
+
+private:
+	enum class Mode
+	{
+		FIXED,
+		UNIFORM,
+		GEOMETRIC,
+		ZIPF,
+		RANGES,
+		SAMPLES
+	};
+
+	SizeDistribution(Mode mode, std::size_t maxSize) noexcept;
+
+	Mode mode;
+	std::size_t maxSize;
+	std::uniform_int_distribution<std::size_t> uniformSize;
+	std::geometric_distribution<std::size_t> geometricSize;
+	std::discrete_distribution<std::size_t> zipfSize;
+	std::vector<std::pair<std::size_t, std::size_t>> ranges;
+	std::discrete_distribution<std::size_t> rangeIndex;
+	std::vector<std::size_t> samples;
+	std::uniform_int_distribution<std::size_t> sampleIndex;
+};
+
+#endif // SizeDistribution_h_INCLUDED
@@ -0,0 +1,50 @@
+//
+// Copyright (C) 2021 Dr. Michael Steffens
+//
+// SPDX-License-Identifier:     BSL-1.0
+//
+
+
+#ifndef SpscQueue_h_INCLUDED
+#define SpscQueue_h_INCLUDED
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+// Bounded single producer single consumer queue of pointers
+template<std::size_t capacity>
+class SpscQueue
+{
+public:
+	bool push(void* ptr) noexcept
+	{
+		const std::size_t tail{tailIndex.load(std::memory_order_relaxed)};
+		bool result{tail - headIndex.load(std::memory_order_acquire) < capacity};
+		if (result) {
+			slots[tail & (capacity - 1)] = ptr;
+			tailIndex.store(tail + 1, std::memory_order_release);
+		}
+		return result;
+	}
+
+	bool pop(void*& ptr) noexcept
+	{
+		const std::size_t head{headIndex.load(std::memory_order_relaxed)};
+		bool result{head != tailIndex.load(std::memory_order_acquire)};
+		if (result) {
+			ptr = slots[head & (capacity - 1)];
+			headIndex.store(head + 1, std::memory_order_release);
+		}
+		return result;
+	}
+
+private:
+	static_assert(capacity > 0 && (capacity & (capacity - 1)) == 0, "capacity must be a power of 2");
+
+	alignas(64) std::atomic<std::size_t> headIndex{0};
+	alignas(64) std::atomic<std::size_t> tailIndex{0};
+	std::array<void*, capacity> slots{};
+};
+
+#endif // SpscQueue_h_INCLUDED
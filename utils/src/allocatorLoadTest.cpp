@@ -1,9 +1,25 @@
+#include "ProcStatus.h"
+#include "SizeDistribution.h"
+#include "SpscQueue.h"
 #include <Logger.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
 #include <cxxopts/cxxopts.hpp>
-#include <mutex>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <optional>
 #include <random>
+#include <sys/resource.h>
 #include <thread>
 #include <unistd.h>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
 
 Logger logger;
 std::size_t preallocateBytes;
@@ -12,7 +28,59 @@ unsigned nThreads;
 std::size_t nInvocations;
 std::size_t maxChunkSize;
 bool doWriteToAllocated;
+unsigned handoffPercent;
+
+// Hands allocations over to the thread freeing them.
+using HandoffQueue = SpscQueue<256>;
+
+// One queue per pair of sender and receiver
+class Handoff
+{
+public:
+	explicit Handoff(unsigned nThreads) : nThreads{nThreads}, queues(nThreads * nThreads)
+	{
+	}
+
+	bool send(unsigned sender, unsigned receiver, void* ptr) noexcept
+	{
+		return queues[receiver * nThreads + sender].push(ptr);
+	}
+
+	template<typename F>
+	std::size_t receive(unsigned receiver, F freeF) noexcept
+	{
+		std::size_t result{0};
+		for (unsigned sender = 0; sender < nThreads; ++sender) {
+			for (void* ptr; queues[receiver * nThreads + sender].pop(ptr); ++result) {
+				freeF(ptr);
+			}
+		}
+		return result;
+	}
+
+private:
+	unsigned nThreads;
+	std::vector<HandoffQueue> queues;
+};
 
+// Operation counters of a thread, read by the main thread for measurement windows.
+struct alignas(64) ThreadCounters
+{
+	std::atomic<std::size_t> operations{0};
+	std::atomic<std::size_t> handoffsSent{0};
+	std::atomic<std::size_t> handoffsReceived{0};
+};
+
+enum class Phase
+{
+	WARMUP,
+	MEASURE,
+	STOP
+};
+
+std::atomic<Phase> phase{Phase::WARMUP};
+
+// A slot owned by a single thread, no synchronization required.
 class Allocation
 {
 public:
@@ -26,11 +94,11 @@ public:
 	void calloc(std::size_t nmemb, std::size_t size) noexcept;
 	void realloc(std::size_t nmemb) noexcept;
 	void reallocarray(std::size_t nmemb, std::size_t size) noexcept;
+	void* release() noexcept;
 
 private:
 	void write(std::size_t size) noexcept;
 
-	std::mutex mutex;
 	void* ptr;
 };
 
@@ -48,7 +116,6 @@ Allocation::~Allocation() noexcept
 
 void Allocation::malloc(std::size_t size) noexcept
 {
-	std::lock_guard<std::mutex> guard{mutex};
 	if (ptr != nullptr) {
 		::free(ptr);
 	}
@@ -60,7 +127,6 @@ void Allocation::malloc(std::size_t size) noexcept
 
 void Allocation::free() noexcept
 {
-	std::lock_guard<std::mutex> guard{mutex};
 	::free(ptr);
 	logger([&] { return Message("Allocation::free({})", ptr); });
 	ptr = nullptr;
@@ -68,7 +134,6 @@ void Allocation::free() noexcept
 
 void Allocation::calloc(std::size_t nmemb, std::size_t size) noexcept
 {
-	std::lock_guard<std::mutex> guard{mutex};
 	if (ptr != nullptr) {
 		::free(ptr);
 	}
@@ -80,20 +145,30 @@ void Allocation::calloc(std::size_t nmemb, std::size_t size) noexcept
 
 void Allocation::realloc(std::size_t size) noexcept
 {
-	std::lock_guard<std::mutex> guard{mutex};
 	void* result{::realloc(ptr, size)};
 	logger([&] { return Message("Allocation::realloc({}, {}) -> {}", ptr, size, result); });
-	ptr = result;
-	write(size);
+	if (result != nullptr || size == 0) {
+		ptr = result;
+		write(size);
+	}
 }
 
 void Allocation::reallocarray(std::size_t nmemb, std::size_t size) noexcept
 {
-	std::lock_guard<std::mutex> guard{mutex};
 	void* result{::reallocarray(ptr, nmemb, size)};
 	logger([&] { return Message("Allocation::reallocarray({}, {}, {}) -> {}", ptr, nmemb, size, result); });
-	ptr = result;
-	write(nmemb * size);
+	if (result != nullptr || nmemb == 0 || size == 0) {
+		ptr = result;
+		write(nmemb * size);
+	}
+}
+
+// Passes ownership of the allocated memory to the caller.
+void* Allocation::release() noexcept
+{
+	void* result{ptr};
+	ptr = nullptr;
+	return result;
 }
 
 void Allocation::write(std::size_t size) noexcept
@@ -104,36 +179,71 @@ void Allocation::write(std::size_t size) noexcept
 	}
 }
 
-void loadAllocations(std::vector<Allocation>* allocations, std::uint_fast32_t randomSeed)
+// Each thread operates on its own partition of allocation slots. Freeing operations hand the allocation over to a
+// random other thread with probability handoffPercent instead.
+void loadAllocations(
+	unsigned threadIndex,
+	SizeDistribution sizeDistribution,
+	std::uint_fast32_t randomSeed,
+	Handoff& handoff,
+	ThreadCounters& counters)
 {
-	logger([&] { return Message("loadAllocations({}, {}) start", allocations, randomSeed); });
+	logger([&] { return Message("loadAllocations({}, {}) start", threadIndex, randomSeed); });
+	std::vector<Allocation> allocations(nAllocations);
 	std::mt19937 gen(randomSeed);
-	std::uniform_int_distribution<std::size_t> allocationDistribution{0, allocations->size() - 1};
-	std::uniform_int_distribution<std::size_t> sizeDistribution{0, maxChunkSize};
+	std::uniform_int_distribution<std::size_t> allocationDistribution{0, allocations.size() - 1};
 	std::uniform_int_distribution<int> opIndexDistribution{0, 4};
-	for (std::size_t i = 0; nInvocations == 0 || i < nInvocations; ++i) {
-		Allocation& allocation{allocations->at(allocationDistribution(gen))};
+	std::uniform_int_distribution<unsigned> percentDistribution{0, 99};
+	std::uniform_int_distribution<unsigned> receiverDistribution{0, nThreads - 1};
+	std::array<std::size_t, 5> elementSizes{1, 2, 4, 8, 16};
+	std::uniform_int_distribution<std::size_t> elementSizeDistribution{0, elementSizes.size() - 1};
+	auto freeReceived = [&](void* ptr) {
+		::free(ptr);
+		logger([&] { return Message("loadAllocations({}) free({}) received", threadIndex, ptr); });
+	};
+	std::size_t nMeasured{0};
+	for (Phase current; (current = phase.load(std::memory_order_relaxed)) != Phase::STOP;) {
+		Allocation& allocation{allocations[allocationDistribution(gen)]};
+		const std::size_t size{sizeDistribution(gen)};
+		const std::size_t elementSize{elementSizes[elementSizeDistribution(gen)]};
 		switch (opIndexDistribution(gen)) {
 		case 0:
-			allocation.malloc(sizeDistribution(gen));
+			allocation.malloc(size);
 			break;
 		case 1:
-			allocation.free();
+			if (handoffPercent > 0 && percentDistribution(gen) < handoffPercent) {
+				void* ptr{allocation.release()};
+				if (ptr != nullptr && !handoff.send(threadIndex, receiverDistribution(gen), ptr)) {
+					::free(ptr);
+				} else if (ptr != nullptr) {
+					counters.handoffsSent.fetch_add(1, std::memory_order_relaxed);
+				}
+			} else {
+				allocation.free();
+			}
 			break;
 		case 2:
-			allocation.calloc(sizeDistribution(gen), sizeDistribution(gen));
+			allocation.calloc((size + elementSize - 1) / elementSize, elementSize);
 			break;
 		case 3:
-			allocation.realloc(sizeDistribution(gen));
+			allocation.realloc(size);
 			break;
 		case 4:
-			allocation.reallocarray(sizeDistribution(gen), sizeDistribution(gen));
+			allocation.reallocarray((size + elementSize - 1) / elementSize, elementSize);
 			break;
 		default:
-			logger([&] { return Message("loadAllocations({}, {}) unexpected operation index", allocations, randomSeed); });
+			logger([&] { return Message("loadAllocations({}, {}) unexpected operation index", threadIndex, randomSeed); });
+		}
+		counters.operations.fetch_add(1, std::memory_order_relaxed);
+		if (handoffPercent > 0 && (counters.operations.load(std::memory_order_relaxed) & 63U) == 0) {
+			counters.handoffsReceived.fetch_add(handoff.receive(threadIndex, freeReceived), std::memory_order_relaxed);
+		}
+		if (current == Phase::MEASURE && nInvocations > 0 && ++nMeasured == nInvocations) {
+			break;
 		}
 	}
-	logger([&] { return Message("loadAllocations({}, {}) end", allocations, randomSeed); });
+	counters.handoffsReceived.fetch_add(handoff.receive(threadIndex, freeReceived), std::memory_order_relaxed);
+	logger([&] { return Message("loadAllocations({}, {}) end", threadIndex, randomSeed); });
 };
 
 void preallocate(std::size_t size)
@@ -148,21 +258,67 @@ void preallocate(std::size_t size)
 	}
 }
 
+struct Snapshot
+{
+	Clock::time_point time;
+	std::vector<std::size_t> operations;
+	long minorFaults;
+};
+
+Snapshot takeSnapshot(std::vector<ThreadCounters> const& counters)
+{
+	Snapshot result{Clock::now(), {}, 0};
+	for (ThreadCounters const& threadCounters : counters) {
+		result.operations.push_back(threadCounters.operations.load(std::memory_order_relaxed));
+	}
+	::rusage usage{};
+	if (::getrusage(RUSAGE_SELF, &usage) == 0) {
+		result.minorFaults = usage.ru_minflt;
+	}
+	return result;
+}
+
+double getSeconds(Clock::duration duration)
+{
+	return std::chrono::duration<double>(duration).count();
+}
+
 int main(int argc, char* argv[])
 {
+	std::string distribution;
+	std::string source;
+	double warmupSeconds;
+	double durationSeconds;
+	unsigned nWindows;
 	{
 		cxxopts::Options options("allocatorLoadTest", "Load test POSIX heap API with random operations");
 
 		options.add_options()("h,help", "Print usage")(
 			"v,verbose", "Verbose output", cxxopts::value<bool>()->default_value("false"))(
 			"p,preallocate", "Number of bytes to preallocate >= 0", cxxopts::value<std::size_t>()->default_value("0"))(
-			"a,allocations", "Number of allocations >= 1", cxxopts::value<std::size_t>()->default_value("1000"))(
+			"a,allocations", "Number of allocation slots per thread >= 1", cxxopts::value<std::size_t>()->default_value("1000"))(
 			"t,threads", "Number of allocation threads >= 1", cxxopts::value<unsigned>()->default_value("1"))(
 			"i,invocations",
-			"Number of invocations per thread >= 0 (0 -> infinite)",
+			"Number of measured invocations per thread >= 0 (0 -> until end of duration)",
 			cxxopts::value<std::size_t>()->default_value("1000000"))(
 			"m,maxsize", "Max number of bytes per chunk >= 1", cxxopts::value<std::size_t>()->default_value("15"))(
-			"w,write", "Write after allocation", cxxopts::value<bool>()->default_value("false"));
+			"w,write", "Write after allocation", cxxopts::value<bool>()->default_value("false"))(
+			"x,handoff",
+			"Percentage of frees handed over to a random thread",
+			cxxopts::value<unsigned>()->default_value("0"))(
+			"d,distribution",
+			"Size distribution fixed at maxsize, uniform, geometric, zipf, dump or trace",
+			cxxopts::value<std::string>()->default_value("uniform"))(
+			"s,source",
+			"SizeRangeStatistics dump for distribution dump, PassThrough TRACE log or AllocationTrace file for distribution trace",
+			cxxopts::value<std::string>()->default_value(""))(
+			"warmup", "Seconds of unmeasured operations", cxxopts::value<double>()->default_value("0"))(
+			"duration",
+			"Seconds of measured operations (0 -> until all invocations are done)",
+			cxxopts::value<double>()->default_value("0"))(
+			"windows",
+			"Number of measurement windows the duration is divided into",
+			cxxopts::value<unsigned>()->default_value("1"));
 
 		cxxopts::ParseResult result{options.parse(argc, argv)};
 		if (result.count("help")) {
@@ -172,23 +328,118 @@ int main(int argc, char* argv[])
 
 		logger.enable(result["verbose"].as<bool>());
 		preallocateBytes = result["preallocate"].as<std::size_t>();
-		nAllocations = result["allocations"].as<std::size_t>();
-		nThreads = result["threads"].as<unsigned>();
+		nAllocations = std::max(result["allocations"].as<std::size_t>(), std::size_t{1});
+		nThreads = std::max(result["threads"].as<unsigned>(), 1U);
 		nInvocations = result["invocations"].as<std::size_t>();
 		maxChunkSize = result["maxsize"].as<std::size_t>();
 		doWriteToAllocated = result["write"].as<bool>();
+		handoffPercent = std::min(result["handoff"].as<unsigned>(), 100U);
+		distribution = result["distribution"].as<std::string>();
+		source = result["source"].as<std::string>();
+		warmupSeconds = result["warmup"].as<double>();
+		durationSeconds = result["duration"].as<double>();
+		nWindows = std::max(result["windows"].as<unsigned>(), 1U);
+		if (durationSeconds <= 0 && nInvocations == 0) {
+			std::cerr << "Either duration or invocations must be > 0" << std::endl;
+			return 1;
+		}
+	}
+
+	std::unique_ptr<SizeDistribution> sizeDistribution;
+	if (std::optional<SizeDistribution> parametric{SizeDistribution::fromName(distribution, maxChunkSize, maxChunkSize)}) {
+		sizeDistribution = std::make_unique<SizeDistribution>(*parametric);
+	} else if (distribution == "dump" || distribution == "trace") {
+		std::ifstream in{source, std::ios::binary};
+		if (!in) {
+			std::cerr << "Failed to open " << source << std::endl;
+			return 1;
+		}
+		sizeDistribution = std::make_unique<SizeDistribution>(
+			distribution == "dump" ? SizeDistribution::fromDump(in) : SizeDistribution::fromTrace(in));
+		if (sizeDistribution->empty()) {
+			std::cerr << "No allocation sizes found in " << source << std::endl;
+			return 1;
+		}
+	} else {
+		std::cerr << "Unknown size distribution " << distribution << std::endl;
+		return 1;
 	}
 
 	std::mt19937 gen(0);
-	std::vector<Allocation> allocations{nAllocations};
+	Handoff handoff{nThreads};
+	std::vector<ThreadCounters> counters(nThreads);
 	std::vector<std::thread> threads;
+	std::vector<Snapshot> snapshots;
 	preallocate(preallocateBytes);
 
-	for (int i = 0; i < nThreads; ++i) {
-		threads.emplace_back(loadAllocations, &allocations, gen());
+	if (warmupSeconds <= 0) {
+		phase.store(Phase::MEASURE, std::memory_order_relaxed);
+		snapshots.push_back(takeSnapshot(counters));
+	}
+	for (unsigned i = 0; i < nThreads; ++i) {
+		threads.emplace_back(loadAllocations, i, *sizeDistribution, gen(), std::ref(handoff), std::ref(counters[i]));
+	}
+	if (warmupSeconds > 0) {
+		std::this_thread::sleep_for(std::chrono::duration<double>(warmupSeconds));
+		snapshots.push_back(takeSnapshot(counters));
+		phase.store(Phase::MEASURE, std::memory_order_relaxed);
+	}
+	if (durationSeconds > 0) {
+		for (unsigned window = 0; window < nWindows; ++window) {
+			std::this_thread::sleep_for(std::chrono::duration<double>(durationSeconds / nWindows));
+			snapshots.push_back(takeSnapshot(counters));
+		}
+		phase.store(Phase::STOP, std::memory_order_relaxed);
+	}
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+	if (durationSeconds <= 0) {
+		snapshots.push_back(takeSnapshot(counters));
+	}
+	const std::size_t rssKiB{getProcStatusKiB("VmRSS")};
+	const std::size_t peakRssKiB{getProcStatusKiB("VmHWM")};
+
+	Snapshot const& first{snapshots.front()};
+	Snapshot const& last{snapshots.back()};
+	const double seconds{getSeconds(last.time - first.time)};
+	std::vector<double> threadRates;
+	std::size_t totalOperations{0};
+	for (unsigned i = 0; i < nThreads; ++i) {
+		const std::size_t operations{last.operations[i] - first.operations[i]};
+		totalOperations += operations;
+		threadRates.push_back(seconds > 0 ? operations / seconds : 0.0);
+	}
+	double sum{0};
+	double sumOfSquares{0};
+	for (double rate : threadRates) {
+		sum += rate;
+		sumOfSquares += rate * rate;
+	}
+	auto [minRate, maxRate]{std::minmax_element(threadRates.begin(), threadRates.end())};
+
+	std::cout << "loadTest:{threads:" << nThreads << ",seconds:" << seconds << ",operations:" << totalOperations
+			  << ",operationsPerSecond:" << (seconds > 0 ? totalOperations / seconds : 0.0)
+			  << ",minorFaults:" << last.minorFaults - first.minorFaults << ",rssKiB:" << rssKiB << ",peakRssKiB:" << peakRssKiB
+			  << "}" << std::endl;
+	// Jain's fairness index, 1 if all threads progress at the same rate, 1 / threads if only one does
+	std::cout << "fairness:{jainIndex:" << (sumOfSquares > 0 ? sum * sum / (nThreads * sumOfSquares) : 1.0)
+			  << ",minOperationsPerSecond:" << *minRate << ",maxOperationsPerSecond:" << *maxRate << "}" << std::endl;
+	for (std::size_t window = 1; window < snapshots.size() && durationSeconds > 0; ++window) {
+		std::size_t operations{0};
+		for (unsigned i = 0; i < nThreads; ++i) {
+			operations += snapshots[window].operations[i] - snapshots[window - 1].operations[i];
+		}
+		const double windowSeconds{getSeconds(snapshots[window].time - snapshots[window - 1].time)};
+		std::cout << "window:{index:" << window - 1 << ",seconds:" << windowSeconds
+				  << ",operationsPerSecond:" << (windowSeconds > 0 ? operations / windowSeconds : 0.0)
+				  << ",minorFaults:" << snapshots[window].minorFaults - snapshots[window - 1].minorFaults << "}" << std::endl;
 	}
-	for (std::vector<std::thread>::iterator it = threads.begin(); it != threads.end(); ++it) {
-		it->join();
+	for (unsigned i = 0; i < nThreads; ++i) {
+		std::cout << "thread:{index:" << i << ",operationsPerSecond:" << threadRates[i]
+				  << ",handoffsSent:" << counters[i].handoffsSent.load()
+				  << ",handoffsReceived:" << counters[i].handoffsReceived.load()
+				  << "}" << std::endl;
 	}
 
 	return 0;
@@ -0,0 +1,289 @@
+//
+// Copyright (C) 2021 Dr. Michael Steffens
+//
+// SPDX-License-Identifier:     BSL-1.0
+//
+
+
+#include <ArenaAllocator/BuildConfiguration.h>
+#include <ArenaAllocator/StatisticsPageFormat.h>
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cxxopts/cxxopts.hpp>
+#include <dirent.h>
+#include <fcntl.h>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+constexpr char const* pagePrefix{"ArenaAllocator-"};
+
+struct PoolSnapshot
+{
+	std::uint64_t first;
+	std::uint64_t last;
+	std::uint64_t nChunks;
+	std::uint64_t group;
+	std::uint64_t free;
+	std::uint64_t allocated;
+	std::uint64_t hwm;
+	std::uint64_t allocations;
+	std::uint64_t failures;
+	std::uint64_t spills;
+};
+
+struct Snapshot
+{
+	Clock::time_point time;
+	std::uint64_t delegateCalls;
+	std::vector<PoolSnapshot> pools;
+};
+
+// Read only mapping of the statistics page of a process
+class Page
+{
+public:
+	explicit Page(std::string const& path) : size{0}, header{nullptr}
+	{
+		int fd{::open(path.c_str(), O_RDONLY | O_CLOEXEC)};
+		struct ::stat status{};
+		if (fd != -1 && ::fstat(fd, &status) == 0 &&
+			status.st_size >= static_cast<::off_t>(sizeof(ArenaAllocator::StatisticsPageHeader))) {
+			size = static_cast<std::size_t>(status.st_size);
+			void* mapped{::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0)};
+			if (mapped != MAP_FAILED) {
+				header = static_cast<ArenaAllocator::StatisticsPageHeader const*>(mapped);
+			}
+		}
+		if (fd != -1) {
+			::close(fd);
+		}
+	}
+
+	Page(Page const&) = delete;
+	Page& operator=(Page const&) = delete;
+
+	~Page()
+	{
+		if (header != nullptr) {
+			::munmap(const_cast<ArenaAllocator::StatisticsPageHeader*>(header), size);
+		}
+	}
+
+	// Published by a process still running
+	bool isValid() const noexcept
+	{
+		return header != nullptr &&
+			header->pageMagic.load(std::memory_order_acquire) == ArenaAllocator::StatisticsPageHeader::magic &&
+			size >= sizeof(ArenaAllocator::StatisticsPageHeader) + header->nPools * sizeof(ArenaAllocator::StatisticsPagePool) &&
+			(::kill(static_cast<::pid_t>(header->pid), 0) == 0 || errno == EPERM);
+	}
+
+	Snapshot read() const
+	{
+		Snapshot result{Clock::now(), header->delegateCalls.load(std::memory_order_relaxed), {}};
+		ArenaAllocator::StatisticsPagePool const* pools{reinterpret_cast<ArenaAllocator::StatisticsPagePool const*>(header + 1)};
+		for (std::uint32_t i = 0; i < header->nPools; ++i) {
+			result.pools.push_back(read(pools[i]));
+		}
+		return result;
+	}
+
+private:
+	static PoolSnapshot read(ArenaAllocator::StatisticsPagePool const& pool) noexcept
+	{
+		PoolSnapshot result{pool.first, pool.last, pool.nChunks, pool.group, 0, 0, 0, 0, 0, 0};
+		std::uint64_t before{0};
+		std::uint64_t after{0};
+		do {
+			while ((before = pool.sequence.load(std::memory_order_acquire)) & 1U) {
+				std::this_thread::yield();
+			}
+			result.free = pool.free.load(std::memory_order_relaxed);
+			result.allocated = pool.allocated.load(std::memory_order_relaxed);
+			result.hwm = pool.hwm.load(std::memory_order_relaxed);
+			result.allocations = pool.allocations.load(std::memory_order_relaxed);
+			result.failures = pool.failures.load(std::memory_order_relaxed);
+			result.spills = pool.spills.load(std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_acquire);
+			after = pool.sequence.load(std::memory_order_relaxed);
+		} while (before != after);
+		return result;
+	}
+
+	std::size_t size;
+	ArenaAllocator::StatisticsPageHeader const* header;
+};
+
+std::string getPagePath(std::string const& pid)
+{
+	return std::string{ArenaAllocator::BuildConfiguration::statisticsPageDirectory} + "/" + pagePrefix + pid;
+}
+
+// Pid of a statistics page name suffix, none if it is not a number.
+std::optional<::pid_t> parsePid(std::string const& pid) noexcept
+{
+	std::optional<::pid_t> result;
+	::pid_t value{0};
+	auto [end, error]{std::from_chars(pid.data(), pid.data() + pid.size(), value)};
+	if (error == std::errc{} && end == pid.data() + pid.size() && value > 0) {
+		result = value;
+	}
+	return result;
+}
+
+// Pids of all processes having published a statistics page, ascending
+std::vector<std::string> findPids()
+{
+	std::vector<std::pair<::pid_t, std::string>> pids;
+	if (::DIR* directory = ::opendir(ArenaAllocator::BuildConfiguration::statisticsPageDirectory)) {
+		while (::dirent* entry = ::readdir(directory)) {
+			std::string name{entry->d_name};
+			if (name.compare(0, std::char_traits<char>::length(pagePrefix), pagePrefix) == 0) {
+				std::string pid{name.substr(std::char_traits<char>::length(pagePrefix))};
+				if (std::optional<::pid_t> value{parsePid(pid)}) {
+					pids.emplace_back(*value, std::move(pid));
+				}
+			}
+		}
+		::closedir(directory);
+	}
+	std::sort(pids.begin(), pids.end());
+	std::vector<std::string> result;
+	for (auto& [value, pid] : pids) {
+		result.push_back(std::move(pid));
+	}
+	return result;
+}
+
+// Pages are invalid as well while a process is still setting them up, so only a process gone is taken for terminated.
+bool isTerminated(std::string const& pid) noexcept
+{
+	std::optional<::pid_t> value{parsePid(pid)};
+	return value.has_value() && ::kill(*value, 0) == -1 && errno == ESRCH;
+}
+
+double perSecond(std::uint64_t current, std::uint64_t previous, double seconds)
+{
+	return seconds > 0 ? static_cast<double>(current - previous) / seconds : 0.0;
+}
+
+void print(std::string const& pid, Snapshot const& current, Snapshot const* previous)
+{
+	const double seconds{previous != nullptr ? std::chrono::duration<double>(current.time - previous->time).count() : 0.0};
+	std::printf(
+		"pid %s  delegateCalls %llu  %.0f/s\n",
+		pid.c_str(),
+		static_cast<unsigned long long>(current.delegateCalls),
+		previous != nullptr ? perSecond(current.delegateCalls, previous->delegateCalls, seconds) : 0.0);
+	std::printf(
+		"  %5s %-22s %10s %10s %10s %6s %10s %12s %10s %10s %10s\n",
+		"group",
+		"range",
+		"chunks",
+		"free",
+		"allocated",
+		"use%",
+		"hwm",
+		"allocs/s",
+		"failures",
+		"fails/s",
+		"spills");
+	for (std::size_t i = 0; i < current.pools.size(); ++i) {
+		PoolSnapshot const& pool{current.pools[i]};
+		PoolSnapshot const* last{previous != nullptr && i < previous->pools.size() ? &previous->pools[i] : nullptr};
+		const std::string range{"[" + std::to_string(pool.first) + ", " + std::to_string(pool.last) + "]"};
+		std::printf(
+			"  %5llu %-22s %10llu %10llu %10llu %5.1f%% %10llu %12.0f %10llu %10.0f %10llu\n",
+			static_cast<unsigned long long>(pool.group),
+			range.c_str(),
+			static_cast<unsigned long long>(pool.nChunks),
+			static_cast<unsigned long long>(pool.free),
+			static_cast<unsigned long long>(pool.allocated),
+			pool.nChunks > 0 ? 100.0 * pool.allocated / pool.nChunks : 0.0,
+			static_cast<unsigned long long>(pool.hwm),
+			last != nullptr ? perSecond(pool.allocations, last->allocations, seconds) : 0.0,
+			static_cast<unsigned long long>(pool.failures),
+			last != nullptr ? perSecond(pool.failures, last->failures, seconds) : 0.0,
+			static_cast<unsigned long long>(pool.spills));
+	}
+	std::printf("\n");
+}
+
+int main(int argc, char* argv[])
+{
+	std::vector<std::string> pids;
+	double interval;
+	std::size_t nIterations;
+	bool batch;
+	bool clean;
+	{
+		cxxopts::Options options("arenaTop", "Live pool occupancy and rates of processes publishing a statistics page");
+
+		options.add_options()("h,help", "Print usage")(
+			"d,delay", "Seconds between updates", cxxopts::value<double>()->default_value("1"))(
+			"n,iterations", "Number of updates, 0 for unlimited", cxxopts::value<std::size_t>()->default_value("0"))(
+			"b,batch", "Append updates rather than redrawing the terminal", cxxopts::value<bool>()->default_value("false"))(
+			"c,clean", "Remove statistics pages of terminated processes", cxxopts::value<bool>()->default_value("false"))(
+			"pids", "Process ids, all publishing processes if none", cxxopts::value<std::vector<std::string>>());
+		options.parse_positional({"pids"});
+		options.positional_help("[pid...]");
+
+		cxxopts::ParseResult result{options.parse(argc, argv)};
+		if (result.count("help")) {
+			std::cout << options.help() << std::endl;
+			exit(0);
+		}
+
+		interval = result["delay"].as<double>();
+		nIterations = result["iterations"].as<std::size_t>();
+		batch = result["batch"].as<bool>();
+		clean = result["clean"].as<bool>();
+		if (result.count("pids")) {
+			pids = result["pids"].as<std::vector<std::string>>();
+		}
+	}
+
+	std::map<std::string, Snapshot> previous;
+	for (std::size_t iteration = 0; nIterations == 0 || iteration < nIterations; ++iteration) {
+		if (iteration > 0) {
+			std::this_thread::sleep_for(std::chrono::duration<double>(interval));
+		}
+		if (!batch) {
+			std::printf("\033[H\033[2J");
+		}
+		std::map<std::string, Snapshot> current;
+		for (std::string const& pid : pids.empty() ? findPids() : pids) {
+			Page page{getPagePath(pid)};
+			if (page.isValid()) {
+				Snapshot snapshot{page.read()};
+				auto it{previous.find(pid)};
+				print(pid, snapshot, it != previous.end() ? &it->second : nullptr);
+				current.emplace(pid, std::move(snapshot));
+			} else if (clean && isTerminated(pid)) {
+				::unlink(getPagePath(pid).c_str());
+			}
+		}
+		if (current.empty()) {
+			std::printf("no statistics pages in %s\n", ArenaAllocator::BuildConfiguration::statisticsPageDirectory);
+		}
+		std::fflush(stdout);
+		previous = std::move(current);
+	}
+
+	return 0;
+}
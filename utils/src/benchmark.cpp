@@ -5,59 +5,484 @@
 //
 
 
-#include <cstddef>
+#include "ArenaAllocator/Allocator.h"
+#include "ArenaAllocator/EnvironmentConfiguration.h"
+#include "ArenaAllocator/InternalAllocatorFactory.h"
+#include "ArenaAllocator/InternalLoggerFactory.h"
+#include "ProcStatus.h"
+#include "SizeDistribution.h"
+#include "SpscQueue.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <cstdlib>
+#include <cstring>
+#include <cxxopts/cxxopts.hpp>
 #include <iostream>
-#include <list>
+#include <malloc.h>
+#include <memory>
+#include <optional>
 #include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
 
-class Allocation
+using Clock = std::chrono::steady_clock;
+
+// The POSIX heap API of the process, i.e. glibc or the preloaded library.
+class Heap : public ArenaAllocator::Allocator
 {
 public:
-	Allocation(std::size_t size) : ptr{malloc(size)}
+	void* malloc(std::size_t size) noexcept override
 	{
+		return ::malloc(size);
 	}
 
-	~Allocation()
+	void free(void* ptr) noexcept override
 	{
-		free(ptr);
+		::free(ptr);
+	}
+
+	void* calloc(std::size_t nmemb, std::size_t size) noexcept override
+	{
+		return ::calloc(nmemb, size);
+	}
+
+	void* realloc(void* ptr, std::size_t size) noexcept override
+	{
+		return ::realloc(ptr, size);
+	}
+
+	void* reallocarray(void* ptr, std::size_t nmemb, std::size_t size) noexcept override
+	{
+		return ::reallocarray(ptr, nmemb, size);
+	}
+
+	int posix_memalign(void** memptr, std::size_t alignment, std::size_t size) noexcept override
+	{
+		return ::posix_memalign(memptr, alignment, size);
+	}
+
+	void* aligned_alloc(std::size_t alignment, std::size_t size) noexcept override
+	{
+		return ::aligned_alloc(alignment, size);
+	}
+
+	void* valloc(std::size_t size) noexcept override
+	{
+		return ::valloc(size);
+	}
+
+	void* memalign(std::size_t alignment, std::size_t size) noexcept override
+	{
+		return ::memalign(alignment, size);
+	}
+
+	void* pvalloc(std::size_t size) noexcept override
+	{
+		return ::pvalloc(size);
+	}
+
+	void dump(bool) const noexcept override
+	{
+	}
+
+	static constexpr char const* className{"heap"};
+};
+
+// An allocator instantiated in process, wired like Bootstrap::ArenaAllocatorSingleton, but configured by a string
+// rather than the environment. Invoked through the Allocator interface, bypassing the preloaded library, if any.
+class Engine
+{
+public:
+	Engine(std::string const& className, std::string const& pools) :
+		configStr{"{pools:" + pools + ",class:" + className + ",logLevel:NONE,logger:Console}"},
+		allocator{nullptr},
+		logger{nullptr},
+		allocatorFactory{configuration, logger},
+		configuration{configStr.c_str(), allocatorFactory, allocator, loggerFactory, logger}
+	{
+	}
+
+	ArenaAllocator::Allocator& getAllocator() noexcept
+	{
+		return *allocator;
 	}
 
 private:
-	void* ptr;
+	const std::string configStr;
+	ArenaAllocator::Allocator* allocator;
+	ArenaAllocator::Logger* logger;
+	ArenaAllocator::InternalLoggerFactory loggerFactory; // Outlives the allocators logging to it
+	ArenaAllocator::InternalAllocatorFactory allocatorFactory;
+	ArenaAllocator::EnvironmentConfiguration configuration;
+};
+
+SizeDistribution getSizeDistribution(std::string const& name, std::size_t fixedSize, std::size_t maxSize)
+{
+	std::optional<SizeDistribution> result{SizeDistribution::fromName(name, fixedSize, maxSize)};
+	if (!result) {
+		throw std::invalid_argument{"unknown size distribution " + name};
+	}
+	return *result;
+}
+
+using Queue = SpscQueue<1024>;
+
+struct Parameters
+{
+	std::size_t operations;
+	std::size_t liveAllocations;
+	std::size_t maxSize;
+	bool doWriteToAllocated;
 };
 
-void stressAllocator(int seed)
+// Per thread workload, returning the number of heap operations performed.
+class Workload
 {
-	std::mt19937 gen(seed);
-	std::uniform_int_distribution<> sizeDistribution{1, 1000};
-	std::uniform_int_distribution<> opDistribution{0, 1};
+public:
+	Workload(
+		ArenaAllocator::Allocator& allocator,
+		SizeDistribution sizes,
+		Parameters const& parameters,
+		std::uint_fast32_t seed) :
+		allocator{allocator}, sizes{std::move(sizes)}, parameters{parameters}, gen{seed}
+	{
+	}
+
+	// Replaces random members of a working set, freed by the allocating thread.
+	std::size_t sameThread()
+	{
+		std::vector<void*> live(parameters.liveAllocations);
+		std::uniform_int_distribution<std::size_t> slotDistribution{0, live.size() - 1};
+		std::size_t result{0};
+		for (; result < parameters.operations; result += 2) {
+			void*& slot{live[slotDistribution(gen)]};
+			allocator.free(slot);
+			slot = allocate(sizes(gen));
+		}
+		return result + freeAll(live);
+	}
+
+	// Allocations are passed to the next thread in a ring, which frees them.
+	std::size_t crossThread(Queue& outgoing, Queue& incoming, std::atomic<unsigned>& producing)
+	{
+		std::size_t result{0};
+		for (; result < parameters.operations; result += 2) {
+			void* ptr{allocate(sizes(gen))};
+			while (!outgoing.push(ptr)) {
+				result += drain(incoming);
+				std::this_thread::yield();
+			}
+			void* received;
+			if (incoming.pop(received)) {
+				allocator.free(received);
+			} else {
+				--result;
+			}
+		}
+		producing.fetch_sub(1, std::memory_order_acq_rel);
+		while (producing.load(std::memory_order_acquire) > 0) {
+			result += drain(incoming);
+			std::this_thread::yield();
+		}
+		return result + drain(incoming);
+	}
+
+	// Allocations passed to a consumer thread freeing them, as by pipelines of producers and consumers.
+	std::size_t produce(Queue& outgoing, std::atomic<unsigned>& producing)
+	{
+		std::size_t result{0};
+		for (; result < parameters.operations; ++result) {
+			void* ptr{allocate(sizes(gen))};
+			while (!outgoing.push(ptr)) {
+				std::this_thread::yield();
+			}
+		}
+		producing.fetch_sub(1, std::memory_order_acq_rel);
+		return result;
+	}
 
-	std::list<Allocation> allocations;
+	std::size_t consume(Queue& incoming, std::atomic<unsigned>& producing)
+	{
+		std::size_t result{0};
+		while (producing.load(std::memory_order_acquire) > 0) {
+			const std::size_t nFreed{drain(incoming)};
+			if (nFreed == 0) {
+				std::this_thread::yield();
+			}
+			result += nFreed;
+		}
+		return result + drain(incoming);
+	}
 
-	for (int i = 0; i < 100; ++i) {
-		allocations.emplace_front(sizeDistribution(gen));
+	// Each chain grows an allocation by a factor of 1.5 up to a size drawn from the distribution, then frees it.
+	std::size_t reallocChain()
+	{
+		std::size_t result{0};
+		while (result < parameters.operations) {
+			const std::size_t finalSize{sizes(gen)};
+			void* ptr{nullptr};
+			for (std::size_t size = std::min(finalSize, std::size_t{8}); ptr == nullptr || size < finalSize;) {
+				size = ptr == nullptr ? size : std::min(size + size / 2 + 1, finalSize);
+				void* reallocated{allocator.realloc(ptr, size)};
+				if (reallocated != nullptr) {
+					ptr = reallocated;
+					write(ptr, size);
+				}
+				++result;
+				if (reallocated == nullptr) {
+					break;
+				}
+			}
+			allocator.free(ptr);
+			++result;
+		}
+		return result;
 	}
 
-	for (int i = 0; i < 100; ++i) {
-		if (opDistribution(gen)) {
-			allocations.emplace_front(sizeDistribution(gen));
-		} else {
-			if (!allocations.empty()) {
-				std::uniform_int_distribution<std::size_t> indexDistribution{0, allocations.size() - 1};
-				std::size_t index{indexDistribution(gen)};
-				std::list<Allocation>::iterator pos{allocations.begin()};
-				for (std::size_t j = 0; j < index; ++j) {
-					++pos;
+	// Working set of allocations with alignments from 16 to 4096, alternating posix_memalign and aligned_alloc.
+	std::size_t aligned()
+	{
+		std::vector<void*> live(parameters.liveAllocations);
+		std::uniform_int_distribution<std::size_t> slotDistribution{0, live.size() - 1};
+		std::uniform_int_distribution<unsigned> alignmentDistribution{4, 12};
+		std::size_t result{0};
+		for (; result < parameters.operations; result += 2) {
+			void*& slot{live[slotDistribution(gen)]};
+			allocator.free(slot);
+			const std::size_t alignment{std::size_t{1} << alignmentDistribution(gen)};
+			const std::size_t size{sizes(gen)};
+			if (result % 4 == 0) {
+				if (allocator.posix_memalign(&slot, alignment, size) != 0) {
+					slot = nullptr;
 				}
-				allocations.erase(pos);
+			} else {
+				slot = allocator.aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
 			}
+			write(slot, size);
 		}
+		return result + freeAll(live);
+	}
+
+private:
+	void* allocate(std::size_t size) noexcept
+	{
+		void* result{allocator.malloc(size)};
+		write(result, size);
+		return result;
 	}
+
+	void write(void* ptr, std::size_t size) const noexcept
+	{
+		if (parameters.doWriteToAllocated && ptr != nullptr) {
+			std::memset(ptr, 17, size);
+		}
+	}
+
+	std::size_t drain(Queue& incoming) noexcept
+	{
+		std::size_t result{0};
+		for (void* ptr; incoming.pop(ptr); ++result) {
+			allocator.free(ptr);
+		}
+		return result;
+	}
+
+	std::size_t freeAll(std::vector<void*>& live) noexcept
+	{
+		for (void*& ptr : live) {
+			allocator.free(ptr);
+			ptr = nullptr;
+		}
+		return live.size();
+	}
+
+	ArenaAllocator::Allocator& allocator;
+	SizeDistribution sizes;
+	Parameters const& parameters;
+	std::mt19937 gen;
+};
+
+struct Result
+{
+	std::size_t operations;
+	std::chrono::nanoseconds elapsed; // Wall clock
+	std::chrono::nanoseconds threadTime; // Sum over threads
+	std::size_t rssKiB;
+	std::size_t peakRssKiB;
+};
+
+Result run(
+	ArenaAllocator::Allocator& allocator,
+	std::string const& sizeName,
+	std::string const& pattern,
+	unsigned nThreads,
+	Parameters const& parameters,
+	std::size_t fixedSize)
+{
+	std::vector<Queue> queues(nThreads);
+	std::vector<std::size_t> operations(nThreads);
+	std::vector<std::chrono::nanoseconds> threadTimes(nThreads);
+	std::atomic<unsigned> ready{0};
+	// Threads pair up as producer and consumer, an odd one out frees its own allocations like crossThread.
+	std::atomic<unsigned> producing{pattern == "producerConsumer" ? (nThreads + 1) / 2 : nThreads};
+	std::atomic<bool> start{false};
+	std::vector<std::thread> threads;
+	resetPeakRss();
+	for (unsigned i = 0; i < nThreads; ++i) {
+		threads.emplace_back([&, i] {
+			Workload workload{allocator, getSizeDistribution(sizeName, fixedSize, parameters.maxSize), parameters, i + 1};
+			ready.fetch_add(1, std::memory_order_acq_rel);
+			while (!start.load(std::memory_order_acquire)) {
+				std::this_thread::yield();
+			}
+			Clock::time_point startTime{Clock::now()};
+			if (pattern == "sameThread") {
+				operations[i] = workload.sameThread();
+			} else if (pattern == "crossThread") {
+				operations[i] = workload.crossThread(queues[(i + 1) % nThreads], queues[i], producing);
+			} else if (pattern == "producerConsumer") {
+				if (i % 2 != 0) {
+					operations[i] = workload.consume(queues[i - 1], producing);
+				} else if (i + 1 < nThreads) {
+					operations[i] = workload.produce(queues[i], producing);
+				} else {
+					operations[i] = workload.crossThread(queues[i], queues[i], producing);
+				}
+			} else if (pattern == "realloc") {
+				operations[i] = workload.reallocChain();
+			} else {
+				operations[i] = workload.aligned();
+			}
+			threadTimes[i] = Clock::now() - startTime;
+		});
+	}
+	while (ready.load(std::memory_order_acquire) < nThreads) {
+		std::this_thread::yield();
+	}
+	Clock::time_point startTime{Clock::now()};
+	start.store(true, std::memory_order_release);
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+	Result result{0, Clock::now() - startTime, std::chrono::nanoseconds{0}, getProcStatusKiB("VmRSS"), getProcStatusKiB("VmHWM")};
+	for (unsigned i = 0; i < nThreads; ++i) {
+		result.operations += operations[i];
+		result.threadTime += threadTimes[i];
+	}
+	return result;
+}
+
+std::vector<std::string> split(std::string const& list)
+{
+	std::vector<std::string> result;
+	std::istringstream in{list};
+	for (std::string item; std::getline(in, item, ',');) {
+		result.push_back(item);
+	}
+	return result;
 }
 
 int main(int argc, char* argv[])
 {
-	stressAllocator(17);
+	std::vector<std::string> allocators;
+	std::vector<std::string> sizeNames;
+	std::vector<std::string> patterns;
+	std::vector<unsigned> threadCounts;
+	std::string pools;
+	std::size_t fixedSize;
+	Parameters parameters{};
+	{
+		cxxopts::Options options("benchmark", "Microbenchmarks of allocator classes and the heap API, results as JSON");
+
+		options.add_options()("h,help", "Print usage")(
+			"a,allocators",
+			"Comma separated allocator classes or delegate chains, heap for the POSIX heap API",
+			cxxopts::value<std::string>()->default_value("PassThrough,SegregatedFreeLists,SizeRangeStatistics,heap"))(
+			"s,sizes",
+			"Comma separated size distributions of fixed, uniform, geometric and zipf",
+			cxxopts::value<std::string>()->default_value("fixed,uniform,geometric,zipf"))(
+			"p,patterns",
+			"Comma separated patterns of sameThread, crossThread, producerConsumer, realloc and aligned",
+			cxxopts::value<std::string>()->default_value("sameThread,crossThread,producerConsumer,realloc,aligned"))(
+			"t,threads", "Comma separated thread counts", cxxopts::value<std::string>()->default_value("1,4"))(
+			"c,pools",
+			"Pools configuration of the allocator classes",
+			cxxopts::value<std::string>()->default_value(
+				"{[1,16]:65536,[17,32]:65536,[33,64]:65536,[65,128]:32768,[129,256]:32768,[257,512]:16384,[513,1024]:16384}"))(
+			"i,invocations", "Number of heap operations per thread", cxxopts::value<std::size_t>()->default_value("200000"))(
+			"l,live", "Number of live allocations per thread", cxxopts::value<std::size_t>()->default_value("1000"))(
+			"f,fixed", "Size of fixed size distribution", cxxopts::value<std::size_t>()->default_value("64"))(
+			"m,maxsize", "Max size of other size distributions", cxxopts::value<std::size_t>()->default_value("1024"))(
+			"w,write", "Write after allocation", cxxopts::value<bool>()->default_value("false"));
+
+		cxxopts::ParseResult result{options.parse(argc, argv)};
+		if (result.count("help")) {
+			std::cout << options.help() << std::endl;
+			exit(0);
+		}
+
+		allocators = split(result["allocators"].as<std::string>());
+		sizeNames = split(result["sizes"].as<std::string>());
+		patterns = split(result["patterns"].as<std::string>());
+		for (std::string const& threads : split(result["threads"].as<std::string>())) {
+			threadCounts.push_back(std::max(static_cast<unsigned>(std::stoul(threads)), 1U));
+		}
+		pools = result["pools"].as<std::string>();
+		parameters.operations = result["invocations"].as<std::size_t>();
+		parameters.liveAllocations = std::max(result["live"].as<std::size_t>(), std::size_t{1});
+		fixedSize = result["fixed"].as<std::size_t>();
+		parameters.maxSize = std::max(result["maxsize"].as<std::size_t>(), std::size_t{1});
+		parameters.doWriteToAllocated = result["write"].as<bool>();
+	}
+
+	try {
+		for (std::string const& sizeName : sizeNames) {
+			getSizeDistribution(sizeName, fixedSize, parameters.maxSize);
+		}
+		for (std::string const& pattern : patterns) {
+			if (pattern != "sameThread" && pattern != "crossThread" && pattern != "producerConsumer" && pattern != "realloc" &&
+				pattern != "aligned") {
+				throw std::invalid_argument{"unknown pattern " + pattern};
+			}
+		}
+	} catch (std::invalid_argument const& e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+
+	std::string separator;
+	std::cout << "{\"pools\":\"" << pools << "\",\"results\":[";
+	for (std::string const& allocatorName : allocators) {
+		Heap heap;
+		std::unique_ptr<Engine> engine;
+		if (allocatorName != Heap::className) {
+			engine = std::make_unique<Engine>(allocatorName, pools);
+		}
+		ArenaAllocator::Allocator& allocator{engine ? engine->getAllocator() : heap};
+		for (std::string const& sizeName : sizeNames) {
+			for (std::string const& pattern : patterns) {
+				for (unsigned nThreads : threadCounts) {
+					const Result result{run(allocator, sizeName, pattern, nThreads, parameters, fixedSize)};
+					const double elapsed(result.elapsed.count());
+					std::cout << separator << "\n{\"allocator\":\"" << allocatorName << "\",\"sizes\":\"" << sizeName
+							  << "\",\"pattern\":\"" << pattern << "\",\"threads\":" << nThreads
+							  << ",\"operations\":" << result.operations << ",\"nanoseconds\":" << result.elapsed.count()
+							  << ",\"nsPerOperation\":"
+							  << (result.operations > 0 ? double(result.threadTime.count()) / result.operations : 0.0)
+							  << ",\"operationsPerSecond\":" << (elapsed > 0 ? result.operations * 1e9 / elapsed : 0.0)
+							  << ",\"rssKiB\":" << result.rssKiB << ",\"peakRssKiB\":" << result.peakRssKiB << "}"
+							  << std::flush;
+					separator = ",";
+				}
+			}
+		}
+	}
+	std::cout << "\n]}" << std::endl;
+
 	return 0;
-};
+}
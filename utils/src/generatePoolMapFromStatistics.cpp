@@ -0,0 +1,215 @@
+//
+// Copyright (C) 2021 Dr. Michael Steffens
+//
+// SPDX-License-Identifier:     BSL-1.0
+//
+
+
+#include "ParsePoolStatistics.h"
+#include <ArenaAllocator/SizeRange.h>
+#include <algorithm>
+#include <cstddef>
+#include <cxxopts/cxxopts.hpp>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct Pool
+{
+	ArenaAllocator::SizeRange range;
+	std::size_t hwm;
+	std::size_t minSize;
+	std::size_t maxSize;
+};
+
+std::size_t getChunkSize(std::size_t size)
+{
+	return ((size + sizeof(std::max_align_t) - 1U) / sizeof(std::max_align_t)) * sizeof(std::max_align_t);
+}
+
+bool isDelegatePool(ArenaAllocator::SizeRange const& range)
+{
+	return range.first == 1 && range.last == std::numeric_limits<std::size_t>::max();
+}
+
+// Pools of all dumps, keyed by size range first and last. As every process has its own arena, the hwm of a size range is the maximum over
+// all dumps. With useHistogram, the size ranges are the buckets of SizeHistogram lines rather than the configured pools.
+std::map<std::pair<std::size_t, std::size_t>, Pool> aggregate(std::istream& in, bool useHwmUpperBound, bool useHistogram)
+{
+	static const std::string histogramPrefix{"SizeHistogram ["};
+	std::map<std::pair<std::size_t, std::size_t>, Pool> result;
+	for (std::string line; std::getline(in, line);) {
+		try {
+			std::size_t histogramPos{line.find(histogramPrefix)};
+			if (useHistogram != (histogramPos != std::string::npos)) {
+				continue;
+			}
+			if (useHistogram) {
+				line.erase(0, histogramPos + histogramPrefix.size() - 1);
+			}
+			ParsePoolStatistics::Result statistics;
+			ParsePoolStatistics{line}(statistics);
+			std::size_t hwm{
+				useHwmUpperBound && statistics.hwmUpperBound ? *statistics.hwmUpperBound : statistics.hwm};
+			auto [it, inserted]{result.try_emplace(
+				std::make_pair(statistics.range.first, statistics.range.last),
+				Pool{statistics.range,
+					 hwm,
+					 statistics.minSize.value_or(statistics.range.first),
+					 statistics.maxSize.value_or(statistics.range.last)})};
+			if (!inserted) {
+				it->second.hwm = std::max(it->second.hwm, hwm);
+				it->second.minSize = std::min(it->second.minSize, statistics.minSize.value_or(statistics.range.first));
+				it->second.maxSize = std::max(it->second.maxSize, statistics.maxSize.value_or(statistics.range.last));
+			}
+		} catch (ParsePoolStatistics::Error&) {
+		}
+	}
+	return result;
+}
+
+// Pools with allocations up to maxSize only, whose chunk size exceeds the chunk size required for maxSize by more than
+// wastePercent, are narrowed to the chunk size required for maxSize. The remainder becomes a pool without allocations.
+// Splitting by the spread between minSize and maxSize is deliberately not done: Dumps carry a single hwm per size range,
+// so each part of such a split would need that full hwm to stay exhaustion free, costing more than it saves. Finer
+// ranges require finer input, e.g. --histogram.
+std::vector<Pool> split(std::vector<Pool> const& pools, std::size_t wastePercent)
+{
+	std::vector<Pool> result;
+	for (Pool const& pool : pools) {
+		std::size_t chunkSize{getChunkSize(pool.range.last)};
+		std::size_t requiredChunkSize{getChunkSize(pool.maxSize)};
+		if (pool.hwm > 0 && pool.maxSize < pool.range.last &&
+			(chunkSize - requiredChunkSize) * 100 > wastePercent * chunkSize) {
+			std::size_t last{std::max(requiredChunkSize, pool.range.first)};
+			result.push_back(Pool{{pool.range.first, last}, pool.hwm, pool.minSize, pool.maxSize});
+			result.push_back(Pool{{last + 1, pool.range.last}, 0, last + 1, pool.range.last});
+		} else {
+			result.push_back(pool);
+		}
+	}
+	return result;
+}
+
+// Adjacent pools are merged as long as the sum of their hwm does not exceed maxHwm. The sum is an upper bound of the hwm
+// of the merged pool.
+std::vector<Pool> merge(std::vector<Pool> const& pools, std::size_t maxHwm)
+{
+	std::vector<Pool> result;
+	for (Pool const& pool : pools) {
+		if (!result.empty() && result.back().range.last + 1 == pool.range.first && result.back().hwm + pool.hwm <= maxHwm) {
+			Pool& previous{result.back()};
+			previous.range.last = pool.range.last;
+			previous.hwm += pool.hwm;
+			previous.minSize = std::min(previous.minSize, pool.minSize);
+			previous.maxSize = std::max(previous.maxSize, pool.maxSize);
+		} else {
+			result.push_back(pool);
+		}
+	}
+	return result;
+}
+
+std::size_t getNChunks(Pool const& pool, std::size_t headroomPercent, bool keepUnused)
+{
+	std::size_t result{(pool.hwm * (100 + headroomPercent) + 99) / 100};
+	return keepUnused ? std::max(result, static_cast<std::size_t>(1)) : result;
+}
+
+int main(int argc, char* argv[])
+{
+	bool verbose;
+	std::size_t headroomPercent;
+	std::size_t wastePercent;
+	std::size_t mergeHwm;
+	bool keepUnused;
+	bool useHwmUpperBound;
+	bool useHistogram;
+	{
+		cxxopts::Options options(
+			"generatePoolMapFromStatistics", "Generate pools configuration from SizeRangeStatistics dumps read from stdin");
+
+		options.add_options()("h,help", "Print usage")(
+			"v,verbose", "Print pool derivation to stderr", cxxopts::value<bool>()->default_value("false"))(
+			"r,headroom", "Percentage of chunks added to hwm", cxxopts::value<std::size_t>()->default_value("25"))(
+			"s,split",
+			"Narrow pools wasting more than percentage of chunk size above max size (>= 100 -> never)",
+			cxxopts::value<std::size_t>()->default_value("25"))(
+			"c,merge",
+			"Merge adjacent pools while sum of hwm is <= number of chunks (0 -> never)",
+			cxxopts::value<std::size_t>()->default_value("0"))(
+			"u,unused", "Keep pools without allocations with one chunk", cxxopts::value<bool>()->default_value("false"))(
+			"e,estimate",
+			"Use sampled hwm estimate rather than upper bound of its 95% confidence interval",
+			cxxopts::value<bool>()->default_value("false"))(
+			"g,histogram",
+			"Use the size histogram of profile:{sizes:1} rather than the configured pools",
+			cxxopts::value<bool>()->default_value("false"));
+
+		cxxopts::ParseResult result{options.parse(argc, argv)};
+		if (result.count("help")) {
+			std::cout << options.help() << std::endl;
+			exit(0);
+		}
+
+		verbose = result["verbose"].as<bool>();
+		headroomPercent = result["headroom"].as<std::size_t>();
+		wastePercent = result["split"].as<std::size_t>();
+		mergeHwm = result["merge"].as<std::size_t>();
+		keepUnused = result["unused"].as<bool>();
+		useHwmUpperBound = !result["estimate"].as<bool>();
+		useHistogram = result["histogram"].as<bool>();
+	}
+
+	std::vector<Pool> pools;
+	for (auto const& [key, pool] : aggregate(std::cin, useHwmUpperBound, useHistogram)) {
+		ArenaAllocator::SizeRange const& range{pool.range};
+		if (isDelegatePool(range)) {
+			if (pool.hwm > 0) {
+				std::cerr << "delegate: {minSize: " << pool.minSize << ", maxSize: " << pool.maxSize << ", hwm: " << pool.hwm
+						  << "}" << std::endl;
+			}
+		} else if (!pools.empty() && pools.back().range.last >= range.first) {
+			std::cerr << "Size range [" << range.first << ", " << range.last << "] overlaps [" << pools.back().range.first
+					  << ", " << pools.back().range.last << "], dumps of different pools configurations?" << std::endl;
+			return 1;
+		} else {
+			pools.push_back(pool);
+		}
+	}
+	if (wastePercent < 100) {
+		pools = split(pools, wastePercent);
+	}
+	if (mergeHwm > 0) {
+		pools = merge(pools, mergeHwm);
+	}
+
+	if (verbose) {
+		std::size_t totalBytes{0};
+		for (Pool const& pool : pools) {
+			std::size_t nChunks{getNChunks(pool, headroomPercent, keepUnused)};
+			std::size_t bytes{nChunks * getChunkSize(pool.range.last)};
+			std::cerr << "[" << pool.range.first << ", " << pool.range.last << "]: {minSize: " << pool.minSize
+					  << ", maxSize: " << pool.maxSize << ", hwm: " << pool.hwm << ", nChunks: " << nChunks
+					  << ", bytes: " << bytes << "}" << std::endl;
+			totalBytes += bytes;
+		}
+		std::cerr << "total: {bytes: " << totalBytes << "}" << std::endl;
+	}
+
+	std::string separator;
+	std::cout << "pools:{";
+	for (Pool const& pool : pools) {
+		std::size_t nChunks{getNChunks(pool, headroomPercent, keepUnused)};
+		if (nChunks > 0) {
+			std::cout << separator << "[" << pool.range.first << "," << pool.range.last << "]:" << nChunks;
+			separator = ",";
+		}
+	}
+	std::cout << "}" << std::endl;
+
+	return 0;
+}
@@ -0,0 +1,488 @@
+//
+// Copyright (C) 2021 Dr. Michael Steffens
+//
+// SPDX-License-Identifier:     BSL-1.0
+//
+
+
+#include "ParseAllocationTrace.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cxxopts/cxxopts.hpp>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <string>
+#include <sys/types.h>
+#include <unordered_map>
+#include <vector>
+
+constexpr std::size_t chunkAlignment{sizeof(std::max_align_t)};
+
+// Allocations are live within [begin, end), measured in allocation events of their process.
+struct Lifetime
+{
+	std::size_t sizeClass;
+	std::size_t size;
+	std::size_t begin;
+	std::size_t end;
+};
+
+struct Process
+{
+	std::unordered_map<std::uintptr_t, std::size_t> live; // Allocated pointer to index into lifetimes
+	std::vector<Lifetime> lifetimes;
+	std::size_t nAllocations{0};
+};
+
+struct Trace
+{
+	std::vector<Lifetime> lifetimes; // Allocation events of all processes on a single time axis
+	std::size_t nAllocations{0};
+	std::size_t nDelegated{0};
+	std::size_t maxDelegatedSize{0};
+};
+
+// Candidate pool upper bound, with the lifetimes of allocations above the previous candidate.
+struct Boundary
+{
+	std::size_t sizeClass;
+	std::vector<Lifetime> lifetimes;
+};
+
+struct Pool
+{
+	std::size_t first;
+	std::size_t last;
+	std::size_t peak;
+	std::size_t nChunks;
+	std::vector<std::size_t> arrivals; // Number of allocations arriving with given number of allocations live
+};
+
+std::size_t getChunkSize(std::size_t sizeClass)
+{
+	return (sizeClass + 1) * chunkAlignment;
+}
+
+void deallocate(Process& process, std::uintptr_t ptr)
+{
+	auto it{process.live.find(ptr)};
+	if (it != process.live.end()) {
+		process.lifetimes[it->second].end = process.nAllocations;
+		process.live.erase(it);
+	}
+}
+
+void allocate(Process& process, Trace& trace, std::uintptr_t ptr, std::size_t size, std::size_t maxSize)
+{
+	// Deallocation missing in trace, e.g. by a not logged code path
+	deallocate(process, ptr);
+	if (size > maxSize) {
+		++trace.nDelegated;
+		trace.maxDelegatedSize = std::max(trace.maxDelegatedSize, size);
+	} else if (size > 0) {
+		process.live[ptr] = process.lifetimes.size();
+		process.lifetimes.push_back(Lifetime{(size - 1) / chunkAlignment, size, process.nAllocations, 0});
+		++process.nAllocations;
+	}
+}
+
+Trace readTrace(std::istream& in, std::size_t maxSize)
+{
+	std::map<::pid_t, Process> processes;
+	Trace result;
+	for (std::string line; std::getline(in, line);) {
+		try {
+			ParseAllocationTrace::Result event;
+			ParseAllocationTrace{line}(event);
+			Process& process{processes[event.pid]};
+			if (event.ptr != 0 && (event.allocated != 0 || event.size == 0)) {
+				deallocate(process, event.ptr);
+			}
+			if (event.allocated != 0) {
+				allocate(process, result, event.allocated, event.size, maxSize);
+			}
+		} catch (ParseAllocationTrace::Error&) {
+		}
+	}
+	for (auto& [pid, process] : processes) {
+		for (auto const& [ptr, index] : process.live) {
+			process.lifetimes[index].end = process.nAllocations;
+		}
+		for (Lifetime lifetime : process.lifetimes) {
+			lifetime.begin += result.nAllocations;
+			lifetime.end += result.nAllocations;
+			result.lifetimes.push_back(lifetime);
+		}
+		result.nAllocations += process.nAllocations;
+	}
+	return result;
+}
+
+// Candidate boundaries are the used size classes. If there are more than maxBoundaries, adjacent size classes are
+// grouped, such that every group holds a similar number of allocations.
+std::vector<Boundary> getBoundaries(Trace const& trace, std::size_t maxSize, std::size_t maxBoundaries)
+{
+	std::vector<std::vector<Lifetime>> byClass((maxSize + chunkAlignment - 1) / chunkAlignment);
+	for (Lifetime const& lifetime : trace.lifetimes) {
+		byClass[lifetime.sizeClass].push_back(lifetime);
+	}
+	std::size_t nUsedClasses{0};
+	for (std::vector<Lifetime> const& lifetimes : byClass) {
+		nUsedClasses += lifetimes.empty() ? 0 : 1;
+	}
+	std::vector<Boundary> result;
+	std::size_t nRemaining{trace.lifetimes.size()};
+	Boundary group{0, {}};
+	for (std::size_t sizeClass = 0; sizeClass < byClass.size(); ++sizeClass) {
+		if (!byClass[sizeClass].empty()) {
+			group.sizeClass = sizeClass;
+			group.lifetimes.insert(group.lifetimes.end(), byClass[sizeClass].begin(), byClass[sizeClass].end());
+			--nUsedClasses;
+			std::size_t nGroups{maxBoundaries > result.size() ? maxBoundaries - result.size() : 1};
+			if (nUsedClasses < nGroups || group.lifetimes.size() * nGroups >= nRemaining) {
+				nRemaining -= group.lifetimes.size();
+				result.push_back(std::move(group));
+				group = Boundary{0, {}};
+			}
+		}
+	}
+	return result;
+}
+
+// Live allocation counts of all ranges of boundaries, keeping the maximum each range has reached. A segment tree over the
+// last boundary of a range holds a pending (sum, maximum prefix sum) of count changes per first boundary in every node.
+// A change of boundary b applies to the ranges [i, j] with i <= b <= j, so each node it touches updates the same run of
+// first boundaries [0, b], costing O(B log B) per change for B boundaries in loops over contiguous counts.
+class RangeCounts
+{
+public:
+	explicit RangeCounts(std::size_t nBoundaries) :
+		nBoundaries{nBoundaries},
+		nLeaves{getLeaves(nBoundaries)},
+		sums(2 * nLeaves * nBoundaries, 0),
+		maxima(2 * nLeaves * nBoundaries, 0)
+	{
+	}
+
+	void add(std::size_t boundary, std::int32_t delta)
+	{
+		const std::size_t nFirst{boundary + 1};
+		std::size_t node{1};
+		std::size_t nodeBegin{0};
+		std::size_t nodeEnd{nLeaves};
+		while (nodeBegin < boundary) {
+			push(node, nFirst);
+			const std::size_t middle{nodeBegin + (nodeEnd - nodeBegin) / 2};
+			if (boundary < middle) {
+				apply(2 * node + 1, nFirst, delta);
+				node = 2 * node;
+				nodeEnd = middle;
+			} else {
+				node = 2 * node + 1;
+				nodeBegin = middle;
+			}
+		}
+		apply(node, nFirst, delta);
+	}
+
+	// peaks[i][j - i] is the maximum count reached by range [i, j].
+	std::vector<std::vector<std::size_t>> getPeaks()
+	{
+		for (std::size_t node = 1; node < nLeaves; ++node) {
+			push(node, nBoundaries);
+		}
+		std::vector<std::vector<std::size_t>> result(nBoundaries);
+		for (std::size_t first = 0; first < nBoundaries; ++first) {
+			for (std::size_t last = first; last < nBoundaries; ++last) {
+				result[first].push_back(static_cast<std::size_t>(maxima[(nLeaves + last) * nBoundaries + first]));
+			}
+		}
+		return result;
+	}
+
+private:
+	static std::size_t getLeaves(std::size_t nBoundaries)
+	{
+		std::size_t result{1};
+		while (result < nBoundaries) {
+			result *= 2;
+		}
+		return result;
+	}
+
+	void apply(std::size_t node, std::size_t nFirst, std::int32_t delta)
+	{
+		std::int32_t* sum{&sums[node * nBoundaries]};
+		std::int32_t* max{&maxima[node * nBoundaries]};
+		for (std::size_t first = 0; first < nFirst; ++first) {
+			sum[first] += delta;
+			max[first] = std::max(max[first], sum[first]);
+		}
+	}
+
+	// Passes the pending changes of the first nFirst first boundaries to the children, as they precede any change
+	// applied to the children from now on.
+	void push(std::size_t node, std::size_t nFirst)
+	{
+		std::int32_t* sum{&sums[node * nBoundaries]};
+		std::int32_t* max{&maxima[node * nBoundaries]};
+		for (std::size_t child = 2 * node; child <= 2 * node + 1; ++child) {
+			std::int32_t* childSum{&sums[child * nBoundaries]};
+			std::int32_t* childMax{&maxima[child * nBoundaries]};
+			for (std::size_t first = 0; first < nFirst; ++first) {
+				childMax[first] = std::max(childMax[first], childSum[first] + max[first]);
+				childSum[first] += sum[first];
+			}
+		}
+		std::fill(sum, sum + nFirst, 0);
+		std::fill(max, max + nFirst, 0);
+	}
+
+	std::size_t nBoundaries;
+	std::size_t nLeaves;
+	std::vector<std::int32_t> sums;
+	std::vector<std::int32_t> maxima;
+};
+
+// peaks[i][j - i] is the maximum number of live allocations above boundaries[i - 1] up to boundaries[j]. A single sweep
+// over all events updates the ranges containing the boundary of each event.
+std::vector<std::vector<std::size_t>> getPeaks(std::vector<Boundary> const& boundaries)
+{
+	struct Event
+	{
+		std::size_t index;
+		bool allocation; // Deallocations sort before allocations of the same event index
+		std::size_t boundary;
+	};
+
+	const std::size_t nBoundaries{boundaries.size()};
+	std::vector<Event> events;
+	for (std::size_t boundary = 0; boundary < nBoundaries; ++boundary) {
+		for (Lifetime const& lifetime : boundaries[boundary].lifetimes) {
+			events.push_back(Event{lifetime.begin, true, boundary});
+			events.push_back(Event{lifetime.end, false, boundary});
+		}
+	}
+	std::sort(events.begin(), events.end(), [](Event const& lhs, Event const& rhs) {
+		return lhs.index < rhs.index || (lhs.index == rhs.index && lhs.allocation < rhs.allocation);
+	});
+
+	RangeCounts counts{nBoundaries};
+	for (Event const& event : events) {
+		counts.add(event.boundary, event.allocation ? 1 : -1);
+	}
+	return counts.getPeaks();
+}
+
+std::size_t getNChunks(std::size_t peak, std::size_t headroomPercent)
+{
+	return (peak * (100 + headroomPercent) + 99) / 100;
+}
+
+// Partitions the candidate boundaries into at most maxPools consecutive pools, minimizing the sum of reserved bytes plus
+// poolCost per pool, without any pool being exhausted by the trace.
+std::vector<Pool> optimize(
+	std::vector<Boundary> const& boundaries,
+	std::vector<std::vector<std::size_t>> const& peaks,
+	std::size_t headroomPercent,
+	std::size_t poolCost,
+	std::size_t maxPools)
+{
+	constexpr std::size_t infinite{std::numeric_limits<std::size_t>::max()};
+	const std::size_t nBoundaries{boundaries.size()};
+	maxPools = std::min(maxPools, nBoundaries);
+	// cost[p][j] is the minimum cost of covering boundaries [0, j) with p pools, begin[p][j] the first boundary of the
+	// last pool.
+	std::vector<std::vector<std::size_t>> cost(maxPools + 1, std::vector<std::size_t>(nBoundaries + 1, infinite));
+	std::vector<std::vector<std::size_t>> begin(maxPools + 1, std::vector<std::size_t>(nBoundaries + 1, 0));
+	cost[0][0] = 0;
+	for (std::size_t p = 1; p <= maxPools; ++p) {
+		for (std::size_t j = 1; j <= nBoundaries; ++j) {
+			for (std::size_t i = p - 1; i < j; ++i) {
+				if (cost[p - 1][i] != infinite) {
+					std::size_t poolBytes{
+						getNChunks(peaks[i][j - 1 - i], headroomPercent) * getChunkSize(boundaries[j - 1].sizeClass) +
+						poolCost};
+					if (cost[p - 1][i] + poolBytes < cost[p][j]) {
+						cost[p][j] = cost[p - 1][i] + poolBytes;
+						begin[p][j] = i;
+					}
+				}
+			}
+		}
+	}
+	std::size_t nPools{1};
+	for (std::size_t p = 1; p <= maxPools; ++p) {
+		if (cost[p][nBoundaries] < cost[nPools][nBoundaries]) {
+			nPools = p;
+		}
+	}
+	std::vector<Pool> result(nPools);
+	for (std::size_t p = nPools, j = nBoundaries; p > 0; j = begin[p][j], --p) {
+		std::size_t i{begin[p][j]};
+		std::size_t peak{peaks[i][j - 1 - i]};
+		result[p - 1] = Pool{i == 0 ? 1 : getChunkSize(boundaries[i - 1].sizeClass) + 1,
+							 getChunkSize(boundaries[j - 1].sizeClass),
+							 peak,
+							 getNChunks(peak, headroomPercent),
+							 {}};
+	}
+	return result;
+}
+
+void setArrivals(std::vector<Pool>& pools, std::vector<Lifetime> const& lifetimes)
+{
+	for (Pool& pool : pools) {
+		std::vector<std::pair<std::size_t, int>> events;
+		for (Lifetime const& lifetime : lifetimes) {
+			if (pool.first <= lifetime.size && lifetime.size <= pool.last) {
+				events.emplace_back(lifetime.end, -1);
+				events.emplace_back(lifetime.begin, 1);
+			}
+		}
+		// Deallocations sort before allocations of the same event index
+		std::sort(events.begin(), events.end());
+		pool.arrivals.assign(pool.peak + 1, 0);
+		std::size_t live{0};
+		for (auto const& [index, delta] : events) {
+			if (delta > 0) {
+				++pool.arrivals[live++];
+			} else {
+				--live;
+			}
+		}
+	}
+}
+
+std::size_t getExhaustions(Pool const& pool)
+{
+	std::size_t result{0};
+	for (std::size_t live = pool.nChunks; live < pool.arrivals.size(); ++live) {
+		result += pool.arrivals[live];
+	}
+	return result;
+}
+
+std::size_t getReservedBytes(std::vector<Pool> const& pools)
+{
+	std::size_t result{0};
+	for (Pool const& pool : pools) {
+		result += pool.nChunks * pool.last;
+	}
+	return result;
+}
+
+// Number of additional exhaustions when removing one chunk from pool.
+std::size_t getMarginalExhaustions(Pool const& pool)
+{
+	return pool.nChunks - 1 < pool.arrivals.size() ? pool.arrivals[pool.nChunks - 1] : 0;
+}
+
+// Removes chunks one at a time from the pool losing the fewest allocations per byte saved, until within budget. As
+// allocations failing on an exhausted pool are not replayed, the exhaustion counts are approximations.
+void fitBudget(std::vector<Pool>& pools, std::size_t budget)
+{
+	std::size_t reservedBytes{getReservedBytes(pools)};
+	while (reservedBytes > budget) {
+		Pool* cheapest{nullptr};
+		for (Pool& pool : pools) {
+			if (pool.nChunks > 0 &&
+				(cheapest == nullptr ||
+				 getMarginalExhaustions(pool) * cheapest->last < getMarginalExhaustions(*cheapest) * pool.last)) {
+				cheapest = &pool;
+			}
+		}
+		if (cheapest == nullptr) {
+			break;
+		}
+		--cheapest->nChunks;
+		reservedBytes -= cheapest->last;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	bool verbose;
+	std::size_t maxSize;
+	std::size_t headroomPercent;
+	std::size_t poolCost;
+	std::size_t maxPools;
+	std::size_t maxBoundaries;
+	std::size_t budget;
+	{
+		cxxopts::Options options(
+			"optimizePoolMap", "Optimize pools configuration for a PassThrough allocation trace read from stdin");
+
+		options.add_options()("h,help", "Print usage")(
+			"v,verbose", "Print pool statistics to stderr", cxxopts::value<bool>()->default_value("false"))(
+			"m,maxsize", "Max allocation size served by pools", cxxopts::value<std::size_t>()->default_value("65536"))(
+			"r,headroom", "Percentage of chunks added to peak", cxxopts::value<std::size_t>()->default_value("0"))(
+			"c,poolcost", "Cost of an additional pool in bytes", cxxopts::value<std::size_t>()->default_value("4096"))(
+			"p,pools", "Max number of pools", cxxopts::value<std::size_t>()->default_value("64"))(
+			"k,boundaries",
+			"Max number of candidate pool boundaries, grouping size classes if exceeded",
+			cxxopts::value<std::size_t>()->default_value("256"))(
+			"b,budget",
+			"Max reserved bytes, removing chunks causing fewest exhaustions if exceeded (0 -> unlimited)",
+			cxxopts::value<std::size_t>()->default_value("0"));
+
+		cxxopts::ParseResult result{options.parse(argc, argv)};
+		if (result.count("help")) {
+			std::cout << options.help() << std::endl;
+			exit(0);
+		}
+
+		verbose = result["verbose"].as<bool>();
+		maxSize = result["maxsize"].as<std::size_t>();
+		headroomPercent = result["headroom"].as<std::size_t>();
+		poolCost = result["poolcost"].as<std::size_t>();
+		maxPools = std::max(result["pools"].as<std::size_t>(), static_cast<std::size_t>(1));
+		maxBoundaries = std::max(result["boundaries"].as<std::size_t>(), static_cast<std::size_t>(1));
+		budget = result["budget"].as<std::size_t>();
+	}
+
+	Trace trace{readTrace(std::cin, maxSize)};
+	std::vector<Boundary> boundaries{getBoundaries(trace, maxSize, maxBoundaries)};
+	if (boundaries.empty()) {
+		std::cerr << "No allocations found in trace" << std::endl;
+		return 1;
+	}
+
+	std::vector<Pool> pools{optimize(boundaries, getPeaks(boundaries), headroomPercent, poolCost, maxPools)};
+	setArrivals(pools, trace.lifetimes);
+	if (budget > 0) {
+		fitBudget(pools, budget);
+	}
+
+	if (verbose) {
+		std::size_t totalExhaustions{0};
+		for (Pool const& pool : pools) {
+			// Pools without chunks are omitted from the configuration, their allocations are delegated.
+			std::size_t exhaustions{getExhaustions(pool)};
+			std::cerr << "[" << pool.first << ", " << pool.last << "]: {peak: " << pool.peak << ", nChunks: " << pool.nChunks
+					  << ", bytes: " << pool.nChunks * pool.last << (pool.nChunks > 0 ? ", exhaustions: " : ", delegated: ")
+					  << exhaustions << "}" << std::endl;
+			if (pool.nChunks > 0) {
+				totalExhaustions += exhaustions;
+			}
+		}
+		std::cerr << "total: {allocations: " << trace.lifetimes.size() << ", bytes: " << getReservedBytes(pools)
+				  << ", exhaustions: " << totalExhaustions << "}" << std::endl;
+		std::cerr << "delegate: {allocations: " << trace.nDelegated << ", maxSize: " << trace.maxDelegatedSize << "}"
+				  << std::endl;
+	}
+
+	std::string separator;
+	std::cout << "pools:{";
+	for (Pool const& pool : pools) {
+		if (pool.nChunks > 0) {
+			std::cout << separator << "[" << pool.first << "," << pool.last << "]:" << pool.nChunks;
+			separator = ",";
+		}
+	}
+	std::cout << "}" << std::endl;
+
+	return 0;
+}
@@ -0,0 +1,299 @@
+//
+// Copyright (C) 2021 Dr. Michael Steffens
+//
+// SPDX-License-Identifier:     BSL-1.0
+//
+
+
+#include "ProcStatus.h"
+#include <ArenaAllocator/AllocationTraceFormat.h>
+#include <ArenaAllocator/OperationType.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <cxxopts/cxxopts.hpp>
+#include <fstream>
+#include <iostream>
+#include <malloc.h>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+constexpr unsigned nOperationTypes{static_cast<unsigned>(ArenaAllocator::OperationType::UNKNOWN)};
+
+using Clock = std::chrono::steady_clock;
+
+// Sequence of records of a traced thread
+struct ThreadTrace
+{
+	std::uint32_t tid;
+	std::vector<ArenaAllocator::AllocationTraceRecord> records;
+	std::array<std::vector<std::uint64_t>, nOperationTypes> nanoseconds;
+};
+
+// Live allocations by symbolic id. A thread consuming an allocation produced by another thread waits for it, such that
+// every thread replays its records in order while cross thread dependencies of the traced process are preserved.
+class Slots
+{
+public:
+	explicit Slots(std::vector<ThreadTrace> const& threads)
+	{
+		std::uint64_t maxId{0};
+		for (ThreadTrace const& thread : threads) {
+			for (ArenaAllocator::AllocationTraceRecord const& record : thread.records) {
+				maxId = std::max(maxId, record.id);
+			}
+		}
+		slots = std::vector<std::atomic<void*>>(maxId + 1);
+		produced.resize(maxId + 1);
+		for (ThreadTrace const& thread : threads) {
+			for (ArenaAllocator::AllocationTraceRecord const& record : thread.records) {
+				produced[record.id] = record.id != 0;
+			}
+		}
+	}
+
+	void produce(std::uint64_t id, void* ptr) noexcept
+	{
+		slots[id].store(ptr != nullptr ? ptr : nullMarker(), std::memory_order_release);
+	}
+
+	// Allocations not produced by any record, e.g. due to records dropped while tracing, are replaced by nullptr.
+	void* consume(std::uint64_t id) noexcept
+	{
+		void* result{nullptr};
+		if (id < produced.size() && produced[id]) {
+			while ((result = slots[id].exchange(nullptr, std::memory_order_acquire)) == nullptr) {
+				std::this_thread::yield();
+			}
+			if (result == nullMarker()) {
+				result = nullptr;
+			}
+		}
+		return result;
+	}
+
+private:
+	static void* nullMarker() noexcept
+	{
+		static char marker;
+		return &marker;
+	}
+
+	std::vector<std::atomic<void*>> slots;
+	std::vector<char> produced;
+};
+
+class Replay
+{
+public:
+	Replay(Slots& slots, bool doWriteToAllocated) noexcept : slots{slots}, doWriteToAllocated{doWriteToAllocated}
+	{
+	}
+
+	void operator()(ThreadTrace& thread, std::atomic<bool> const& start) noexcept
+	{
+		while (!start.load(std::memory_order_acquire)) {
+			std::this_thread::yield();
+		}
+		for (ArenaAllocator::AllocationTraceRecord const& record : thread.records) {
+			if (record.operationType < nOperationTypes) {
+				thread.nanoseconds[record.operationType].push_back(execute(record));
+			}
+		}
+	}
+
+private:
+	// Returns the duration of the heap operation only.
+	std::uint64_t execute(ArenaAllocator::AllocationTraceRecord const& record) noexcept
+	{
+		void* ptr{record.ptrId != 0 ? slots.consume(record.ptrId) : nullptr};
+		void* result{nullptr};
+		Clock::time_point startTime{Clock::now()};
+		switch (ArenaAllocator::OperationType{record.operationType}) {
+		case ArenaAllocator::OperationType::MALLOC:
+			result = ::malloc(record.size);
+			break;
+		case ArenaAllocator::OperationType::FREE:
+			::free(ptr);
+			break;
+		case ArenaAllocator::OperationType::CALLOC:
+			result = ::calloc(record.nmemb, record.size);
+			break;
+		case ArenaAllocator::OperationType::REALLOC:
+			result = ::realloc(ptr, record.size);
+			break;
+		case ArenaAllocator::OperationType::REALLOCARRAY:
+			result = ::reallocarray(ptr, record.nmemb, record.size);
+			break;
+		case ArenaAllocator::OperationType::POSIX_MEMALIGN:
+			if (::posix_memalign(&result, record.alignment, record.size) != 0) {
+				result = nullptr;
+			}
+			break;
+		case ArenaAllocator::OperationType::ALIGNED_ALLOC:
+			result = ::aligned_alloc(record.alignment, record.size);
+			break;
+		case ArenaAllocator::OperationType::VALLOC:
+			result = ::valloc(record.size);
+			break;
+		case ArenaAllocator::OperationType::MEMALIGN:
+			result = ::memalign(record.alignment, record.size);
+			break;
+		case ArenaAllocator::OperationType::PVALLOC:
+			result = ::pvalloc(record.size);
+			break;
+		default:
+			break;
+		}
+		Clock::time_point stopTime{Clock::now()};
+
+		const std::size_t size{record.nmemb * record.size};
+		const bool isReallocation{record.operationType == static_cast<unsigned>(ArenaAllocator::OperationType::REALLOC) ||
+								  record.operationType == static_cast<unsigned>(ArenaAllocator::OperationType::REALLOCARRAY)};
+		if (doWriteToAllocated && result != nullptr) {
+			std::memset(result, 17, size);
+		}
+		if (isReallocation && result == nullptr && size > 0) {
+			// A failed reallocation leaves ptr allocated.
+			result = ptr;
+		}
+		if (record.id != 0) {
+			slots.produce(record.id, result);
+		} else if (result != nullptr) {
+			// Failed while tracing only, keep the heap state of the traced process.
+			::free(result);
+		}
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(stopTime - startTime).count();
+	}
+
+	Slots& slots;
+	bool doWriteToAllocated;
+};
+
+// Reads the records of the given pid, or of the first pid found, grouped by thread.
+bool readTrace(std::string const& fileName, std::uint32_t& pid, std::vector<ThreadTrace>& threads)
+{
+	std::ifstream in{fileName, std::ios::binary};
+	if (!in) {
+		std::cerr << "Failed to open " << fileName << std::endl;
+		return false;
+	}
+	std::map<std::uint32_t, std::size_t> threadIndex;
+	std::vector<ArenaAllocator::AllocationTraceRecord> records;
+	for (ArenaAllocator::AllocationTraceHeader header; in.read(reinterpret_cast<char*>(&header), sizeof(header));) {
+		if (header.blockMagic != ArenaAllocator::AllocationTraceHeader::magic) {
+			std::cerr << "Unexpected block header in " << fileName << std::endl;
+			return false;
+		}
+		records.resize(header.nRecords);
+		if (!in.read(reinterpret_cast<char*>(records.data()), records.size() * sizeof(ArenaAllocator::AllocationTraceRecord))) {
+			std::cerr << "Truncated block in " << fileName << std::endl;
+			return false;
+		}
+		if (pid == 0) {
+			pid = header.pid;
+		}
+		if (header.pid == pid) {
+			auto [it, inserted]{threadIndex.try_emplace(header.tid, threads.size())};
+			if (inserted) {
+				threads.push_back(ThreadTrace{header.tid, {}, {}});
+			}
+			std::vector<ArenaAllocator::AllocationTraceRecord>& threadRecords{threads[it->second].records};
+			threadRecords.insert(threadRecords.end(), records.begin(), records.end());
+		}
+	}
+	return true;
+}
+
+void printLatencies(std::vector<ThreadTrace> const& threads)
+{
+	for (unsigned typeIndex{0}; typeIndex != nOperationTypes; ++typeIndex) {
+		std::vector<std::uint64_t> nanoseconds;
+		for (ThreadTrace const& thread : threads) {
+			nanoseconds.insert(nanoseconds.end(), thread.nanoseconds[typeIndex].begin(), thread.nanoseconds[typeIndex].end());
+		}
+		std::sort(nanoseconds.begin(), nanoseconds.end());
+		ArenaAllocator::OperationType operationType{typeIndex};
+		std::cout << to_string(operationType) << ":{total:" << nanoseconds.size();
+		if (!nanoseconds.empty()) {
+			auto percentile = [&](std::size_t partsPerThousand) {
+				return nanoseconds[std::max((nanoseconds.size() * partsPerThousand + 999) / 1000, std::size_t{1}) - 1];
+			};
+			std::cout << ",minNanoseconds:" << nanoseconds.front() << ",maxNanoseconds:" << nanoseconds.back()
+					  << ",p50:" << percentile(500) << ",p99:" << percentile(990) << ",p999:" << percentile(999);
+		}
+		std::cout << "}" << std::endl;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	std::string fileName;
+	std::uint32_t pid;
+	bool doWriteToAllocated;
+	{
+		cxxopts::Options options(
+			"replayAllocationTrace",
+			"Replay a trace written by the AllocationTrace allocator, one thread per traced thread, against the heap API");
+
+		options.add_options()("h,help", "Print usage")(
+			"p,pid",
+			"Process to replay, if the trace contains forked children (0 -> first)",
+			cxxopts::value<std::uint32_t>()->default_value("0"))(
+			"w,write", "Write after allocation", cxxopts::value<bool>()->default_value("false"))(
+			"trace", "AllocationTrace file", cxxopts::value<std::string>());
+		options.parse_positional({"trace"});
+		options.positional_help("<AllocationTrace file>");
+
+		cxxopts::ParseResult result{options.parse(argc, argv)};
+		if (result.count("help") || !result.count("trace")) {
+			std::cout << options.help() << std::endl;
+			exit(result.count("help") ? 0 : 1);
+		}
+
+		fileName = result["trace"].as<std::string>();
+		pid = result["pid"].as<std::uint32_t>();
+		doWriteToAllocated = result["write"].as<bool>();
+	}
+
+	std::vector<ThreadTrace> threads;
+	if (!readTrace(fileName, pid, threads)) {
+		return 1;
+	}
+	std::size_t nOperations{0};
+	for (ThreadTrace const& thread : threads) {
+		nOperations += thread.records.size();
+	}
+
+	Slots slots{threads};
+	Replay replay{slots, doWriteToAllocated};
+	std::atomic<bool> start{false};
+	std::vector<std::thread> replayThreads;
+	for (ThreadTrace& thread : threads) {
+		replayThreads.emplace_back([&] { replay(thread, start); });
+	}
+	const std::size_t rssBeforeKiB{getProcStatusKiB("VmRSS")};
+	resetPeakRss();
+	Clock::time_point startTime{Clock::now()};
+	start.store(true, std::memory_order_release);
+	for (std::thread& replayThread : replayThreads) {
+		replayThread.join();
+	}
+	Clock::time_point stopTime{Clock::now()};
+	const std::size_t peakRssKiB{getProcStatusKiB("VmHWM")};
+
+	const auto nanoseconds{std::chrono::duration_cast<std::chrono::nanoseconds>(stopTime - startTime).count()};
+	std::cout << "replay:{pid:" << pid << ",threads:" << threads.size() << ",operations:" << nOperations
+			  << ",nanoseconds:" << nanoseconds << ",operationsPerSecond:"
+			  << (nanoseconds > 0 ? static_cast<std::uint64_t>(nOperations * 1e9 / nanoseconds) : 0)
+			  << ",rssBeforeKiB:" << rssBeforeKiB << ",peakRssKiB:" << peakRssKiB << "}" << std::endl;
+	printLatencies(threads);
+
+	return 0;
+}
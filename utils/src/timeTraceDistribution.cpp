@@ -6,19 +6,97 @@
 
 
 #include "ParseTimeTrace.h"
+#include <ArenaAllocator/BinaryTraceFormat.h>
+#include <ArenaAllocator/LogLinearBuckets.h>
 #include <ArenaAllocator/OperationType.h>
+#include <algorithm>
 #include <array>
+#include <cstdio>
+#include <cstring>
+#include <cxxopts/cxxopts.hpp>
+#include <fstream>
+#include <functional>
 #include <iostream>
+#include <limits>
+#include <map>
+#include <queue>
 #include <string>
 #include <sys/types.h>
+#include <utility>
+#include <vector>
 
-constexpr unsigned long nanosecondsInterval{100};
-constexpr unsigned long intervals{300};
+constexpr unsigned nOperationTypes{static_cast<unsigned>(ArenaAllocator::OperationType::UNKNOWN)};
+
+// Percentiles in parts per ten thousand
+constexpr std::array<std::pair<unsigned long, char const*>, 5> percentiles{
+	{{5000, "p50"}, {9000, "p90"}, {9900, "p99"}, {9990, "p999"}, {9999, "p9999"}}};
+
+// Either linear buckets of fixed interval, the last one collecting all larger values, or log-linear buckets with
+// 2^subBucketBits linear sub buckets per power of two.
+class Buckets
+{
+public:
+	static Buckets linear(unsigned long interval, unsigned long intervals) noexcept
+	{
+		return Buckets{std::max(interval, 1UL), std::max(intervals, 1UL), 0};
+	}
+
+	static Buckets logLinear(unsigned subBucketBits) noexcept
+	{
+		subBucketBits = std::min(subBucketBits, 16U);
+		return Buckets{0, (64UL - subBucketBits + 1) << subBucketBits, subBucketBits};
+	}
+
+	std::size_t size() const noexcept
+	{
+		return nBuckets;
+	}
+
+	std::size_t getIndex(unsigned long nanoseconds) const noexcept
+	{
+		std::size_t result{0};
+		if (interval > 0) {
+			result = std::min(nanoseconds / interval, nBuckets - 1);
+		} else {
+			result = ArenaAllocator::getLogLinearBucket(nanoseconds, subBucketBits, subBucketBits);
+		}
+		return result;
+	}
+
+	// Largest value in bucket
+	unsigned long getUpperBound(std::size_t index) const noexcept
+	{
+		unsigned long result{0};
+		if (interval > 0) {
+			result = index + 1 < nBuckets ? (index + 1) * interval - 1 : std::numeric_limits<unsigned long>::max();
+		} else {
+			result = ArenaAllocator::getLogLinearUpperBound(index, subBucketBits, subBucketBits);
+		}
+		return result;
+	}
+
+private:
+	Buckets(unsigned long interval, unsigned long nBuckets, unsigned subBucketBits) noexcept :
+		interval{interval}, nBuckets{nBuckets}, subBucketBits{subBucketBits}
+	{
+	}
+
+	unsigned long interval;
+	unsigned long nBuckets;
+	unsigned subBucketBits;
+};
 
 class Distribution
 {
 public:
-	Distribution() noexcept : total{0}, minNanoseconds{std::numeric_limits<unsigned long>::max()}, maxNanoseconds{0}, occurrencies{}
+	Distribution(Buckets const& buckets, bool exact) :
+		buckets{buckets},
+		exact{exact},
+		sorted{true},
+		total{0},
+		minNanoseconds{std::numeric_limits<unsigned long>::max()},
+		maxNanoseconds{0},
+		occurrencies(buckets.size())
 	{
 	}
 
@@ -27,80 +105,322 @@ public:
 		++total;
 		minNanoseconds = std::min(minNanoseconds, nanoseconds);
 		maxNanoseconds = std::max(maxNanoseconds, nanoseconds);
-		++occurrencies.at(std::min(nanoseconds / nanosecondsInterval, intervals - 1));
+		++occurrencies[buckets.getIndex(nanoseconds)];
+		if (exact) {
+			samples.push_back(nanoseconds);
+			sorted = false;
+		}
 	}
-	std::array<unsigned long, intervals> const& getOccurrencies() const
+
+	std::vector<unsigned long> const& getOccurrencies() const noexcept
 	{
 		return occurrencies;
 	}
 
+	// Nearest rank percentile. Exact if samples are retained, upper bound of the bucket holding it otherwise.
+	unsigned long getPercentile(unsigned long partsPerTenThousand)
+	{
+		unsigned long result{0};
+		if (total > 0) {
+			const unsigned long rank{std::max((total * partsPerTenThousand + 9999) / 10000, 1UL)};
+			if (exact) {
+				if (!sorted) {
+					std::sort(samples.begin(), samples.end());
+					sorted = true;
+				}
+				result = samples[rank - 1];
+			} else {
+				unsigned long cumulated{0};
+				for (std::size_t index = 0; cumulated < rank; ++index) {
+					cumulated += occurrencies[index];
+					result = std::min(buckets.getUpperBound(index), maxNanoseconds);
+				}
+			}
+		}
+		return result;
+	}
+
 private:
-	friend std::ostream& operator<<(std::ostream&, const Distribution&);
+	friend std::ostream& operator<<(std::ostream&, Distribution&);
 
+	Buckets const& buckets;
+	bool exact;
+	bool sorted;
 	unsigned long total;
 	unsigned long minNanoseconds;
 	unsigned long maxNanoseconds;
-	std::array<unsigned long, intervals> occurrencies;
+	std::vector<unsigned long> occurrencies;
+	std::vector<unsigned long> samples;
 };
 
-std::ostream& operator<<(std::ostream& out, const Distribution& distribution)
+std::ostream& operator<<(std::ostream& out, Distribution& distribution)
 {
 	out << "{total:" << distribution.total;
 	if (distribution.total > 0) {
 		out << ",minNanoseconds:" << distribution.minNanoseconds << ",maxNanoseconds:" << distribution.maxNanoseconds;
+		for (auto const& [partsPerTenThousand, name] : percentiles) {
+			out << "," << name << ":" << distribution.getPercentile(partsPerTenThousand);
+		}
 	}
 	return out << "}";
 };
 
-void printDistributionStatistics(
-	std::array<Distribution, static_cast<unsigned>(ArenaAllocator::OperationType::UNKNOWN)> const& distributions)
+struct Outlier
 {
-	for (unsigned typeIndex{0}; typeIndex != static_cast<unsigned>(ArenaAllocator::OperationType::UNKNOWN); ++typeIndex) {
-		ArenaAllocator::OperationType operationType{typeIndex};
-		std::cout << to_string(operationType) << ":" << distributions.at(typeIndex) << std::endl;
+	unsigned long nanoseconds;
+	::pid_t pid;
+
+	bool operator>(Outlier const& other) const noexcept
+	{
+		return nanoseconds > other.nanoseconds;
 	}
-}
+};
 
-void printDistributions(
-	std::array<Distribution, static_cast<unsigned>(ArenaAllocator::OperationType::UNKNOWN)> const& distributions)
+// Distributions per operation type, optionally per pid, and the largest timings per operation type.
+class Statistics
 {
-	std::cout << "\"nanoseconds\"";
-	for (unsigned typeIndex{0}; typeIndex != static_cast<unsigned>(ArenaAllocator::OperationType::UNKNOWN); ++typeIndex) {
-		ArenaAllocator::OperationType operationType{typeIndex};
-		std::cout << ",\"" << to_string(operationType) << "\"";
-	}
-	std::cout << std::endl;
-	for (unsigned long i = 0; i < intervals; ++i) {
-		std::cout << (i + 1) * nanosecondsInterval;
-		for (unsigned typeIndex{0}; typeIndex != static_cast<unsigned>(ArenaAllocator::OperationType::UNKNOWN); ++typeIndex) {
+public:
+	Statistics(Buckets const& buckets, bool exact, bool perPid, std::size_t maxOutliers) :
+		buckets{buckets}, exact{exact}, perPid{perPid}, maxOutliers{maxOutliers}, outliers(nOperationTypes)
+	{
+		for (unsigned typeIndex{0}; typeIndex != nOperationTypes; ++typeIndex) {
+			merged.emplace_back(buckets, exact && !perPid);
+		}
+	}
+
+	void add(::pid_t pid, ArenaAllocator::OperationType operationType, unsigned long nanoseconds)
+	{
+		if (nanoseconds > 0 && operationType != ArenaAllocator::OperationType::UNKNOWN) {
+			const unsigned typeIndex{static_cast<unsigned>(operationType)};
+			merged[typeIndex].add(nanoseconds);
+			if (perPid) {
+				byPid.try_emplace({pid, typeIndex}, buckets, exact).first->second.add(nanoseconds);
+			}
+			if (maxOutliers > 0) {
+				auto& largest{outliers[typeIndex]};
+				if (largest.size() < maxOutliers) {
+					largest.push(Outlier{nanoseconds, pid});
+				} else if (nanoseconds > largest.top().nanoseconds) {
+					largest.pop();
+					largest.push(Outlier{nanoseconds, pid});
+				}
+			}
+		}
+	}
+
+	void print()
+	{
+		printStatistics();
+		printDistributions();
+		printOutliers();
+	}
+
+private:
+	void printStatistics()
+	{
+		if (perPid) {
+			for (auto& [key, distribution] : byPid) {
+				ArenaAllocator::OperationType operationType{key.second};
+				std::cout << "[pid:" << key.first << "]" << to_string(operationType) << ":" << distribution << std::endl;
+			}
+		} else {
+			for (unsigned typeIndex{0}; typeIndex != nOperationTypes; ++typeIndex) {
+				ArenaAllocator::OperationType operationType{typeIndex};
+				std::cout << to_string(operationType) << ":" << merged[typeIndex] << std::endl;
+			}
+		}
+	}
+
+	// CSV of bucket upper bounds and occurrencies per operation type, restricted to the range of non empty buckets.
+	void printDistributions()
+	{
+		std::size_t first{buckets.size()};
+		std::size_t last{0};
+		for (Distribution const& distribution : merged) {
+			std::vector<unsigned long> const& occurrencies{distribution.getOccurrencies()};
+			for (std::size_t index = 0; index < occurrencies.size(); ++index) {
+				if (occurrencies[index] > 0) {
+					first = std::min(first, index);
+					last = std::max(last, index);
+				}
+			}
+		}
+		std::cout << "\"nanoseconds\"";
+		for (unsigned typeIndex{0}; typeIndex != nOperationTypes; ++typeIndex) {
 			ArenaAllocator::OperationType operationType{typeIndex};
-			std::cout << "," << distributions.at(typeIndex).getOccurrencies().at(i);
+			std::cout << ",\"" << to_string(operationType) << "\"";
 		}
 		std::cout << std::endl;
+		for (std::size_t index = first; index <= last && first < buckets.size(); ++index) {
+			std::cout << buckets.getUpperBound(index);
+			for (Distribution const& distribution : merged) {
+				std::cout << "," << distribution.getOccurrencies()[index];
+			}
+			std::cout << std::endl;
+		}
+	}
+
+	void printOutliers()
+	{
+		for (unsigned typeIndex{0}; typeIndex != nOperationTypes; ++typeIndex) {
+			ArenaAllocator::OperationType operationType{typeIndex};
+			std::vector<Outlier> largest;
+			for (auto& queue{outliers[typeIndex]}; !queue.empty(); queue.pop()) {
+				largest.push_back(queue.top());
+			}
+			for (auto it = largest.rbegin(); it != largest.rend(); ++it) {
+				std::cout << "outlier:" << to_string(operationType) << ":{pid:" << it->pid
+						  << ",nanoseconds:" << it->nanoseconds << "}" << std::endl;
+			}
+		}
+	}
+
+	Buckets const& buckets;
+	bool exact;
+	bool perPid;
+	std::size_t maxOutliers;
+	std::vector<Distribution> merged;
+	std::map<std::pair<::pid_t, unsigned>, Distribution> byPid;
+	std::vector<std::priority_queue<Outlier, std::vector<Outlier>, std::greater<Outlier>>> outliers;
+};
+
+// Reads in large blocks, passing complete lines to lineF. Only lines crossing block boundaries are copied.
+template<typename F>
+void forEachLine(std::FILE* in, F lineF)
+{
+	constexpr std::size_t blockSize{1U << 20U};
+	std::vector<char> block(blockSize);
+	std::string carry;
+	for (std::size_t n; (n = std::fread(block.data(), 1, block.size(), in)) > 0;) {
+		char const* begin{block.data()};
+		char const* const end{block.data() + n};
+		for (char const* newline; (newline = static_cast<char const*>(std::memchr(begin, '\n', end - begin))) != nullptr;
+			 begin = newline + 1) {
+			if (carry.empty()) {
+				lineF(std::string_view(begin, newline - begin));
+			} else {
+				carry.append(begin, newline);
+				lineF(std::string_view{carry});
+				carry.clear();
+			}
+		}
+		carry.append(begin, end);
+	}
+	if (!carry.empty()) {
+		lineF(std::string_view{carry});
 	}
 }
 
-int main(int argc, char* argv[])
+void addTextTrace(std::FILE* in, Statistics& statistics)
 {
-	std::array<Distribution, static_cast<unsigned>(ArenaAllocator::OperationType::UNKNOWN)> distributions{};
-
-	for (std::string line; std::getline(std::cin, line);) {
-		try {
-			::pid_t pid;
-			ArenaAllocator::OperationType operationType;
-			unsigned long nanoseconds;
-			ParseTimeTrace{line}(pid, operationType, nanoseconds);
-			// std::cout << "pid:" << pid << " operationType:" << to_string(operationType) << " nanoseconds:" << nanoseconds <<
-			// std::endl;
-			if (nanoseconds > 0) {
-				distributions.at(static_cast<unsigned>(operationType)).add(nanoseconds);
+	forEachLine(in, [&](std::string_view line) {
+		::pid_t pid;
+		ArenaAllocator::OperationType operationType;
+		unsigned long nanoseconds;
+		if (ParseTimeTrace::scan(line, pid, operationType, nanoseconds)) {
+			statistics.add(pid, operationType, nanoseconds);
+		} else if (line.find("TimeTrace:") != std::string_view::npos) {
+			try {
+				ParseTimeTrace{line}(pid, operationType, nanoseconds);
+				statistics.add(pid, operationType, nanoseconds);
+			} catch (ParseTimeTrace::Error&) {
 			}
-		} catch (ParseTimeTrace::Error&) {
 		}
+	});
+}
+
+// Reads a file written by the BinaryTrace logger.
+bool addBinaryTrace(std::string const& fileName, Statistics& statistics)
+{
+	std::ifstream in{fileName, std::ios::binary};
+	if (!in) {
+		std::cerr << "Failed to open " << fileName << std::endl;
+		return false;
 	}
+	std::vector<ArenaAllocator::BinaryTraceRecord> records;
+	for (ArenaAllocator::BinaryTraceHeader header; in.read(reinterpret_cast<char*>(&header), sizeof(header));) {
+		if (header.blockMagic != ArenaAllocator::BinaryTraceHeader::magic) {
+			std::cerr << "Unexpected block header in " << fileName << std::endl;
+			return false;
+		}
+		records.resize(header.nRecords);
+		if (!in.read(reinterpret_cast<char*>(records.data()), records.size() * sizeof(ArenaAllocator::BinaryTraceRecord))) {
+			std::cerr << "Truncated block in " << fileName << std::endl;
+			return false;
+		}
+		for (ArenaAllocator::BinaryTraceRecord const& record : records) {
+			if (record.operationType < nOperationTypes) {
+				statistics.add(
+					static_cast<::pid_t>(header.pid), ArenaAllocator::OperationType{record.operationType}, record.nanoseconds);
+			}
+		}
+	}
+	return true;
+}
 
-	printDistributionStatistics(distributions);
-	printDistributions(distributions);
+int main(int argc, char* argv[])
+{
+	bool linear;
+	unsigned long interval;
+	unsigned long intervals;
+	unsigned precision;
+	bool approximate;
+	bool perPid;
+	std::size_t maxOutliers;
+	std::vector<std::string> binaryTraces;
+	{
+		cxxopts::Options options(
+			"timeTraceDistribution",
+			"Timing distributions of TimeTrace log lines read from stdin, or of BinaryTrace files given as arguments");
+
+		options.add_options()("h,help", "Print usage")(
+			"l,linear", "Linear rather than log-linear buckets", cxxopts::value<bool>()->default_value("false"))(
+			"i,interval", "Linear bucket width in nanoseconds", cxxopts::value<unsigned long>()->default_value("100"))(
+			"n,intervals", "Number of linear buckets", cxxopts::value<unsigned long>()->default_value("300"))(
+			"s,precision",
+			"Log-linear sub buckets per power of two, as power of two",
+			cxxopts::value<unsigned>()->default_value("3"))(
+			"a,approximate",
+			"Percentiles from bucket bounds rather than from retained timings",
+			cxxopts::value<bool>()->default_value("false"))(
+			"p,pid", "Statistics per pid", cxxopts::value<bool>()->default_value("false"))(
+			"o,outliers",
+			"Number of largest timings listed per operation type",
+			cxxopts::value<std::size_t>()->default_value("0"))(
+			"binaryTraces", "BinaryTrace files", cxxopts::value<std::vector<std::string>>());
+		options.parse_positional({"binaryTraces"});
+		options.positional_help("[BinaryTrace files...]");
+
+		cxxopts::ParseResult result{options.parse(argc, argv)};
+		if (result.count("help")) {
+			std::cout << options.help() << std::endl;
+			exit(0);
+		}
+
+		linear = result["linear"].as<bool>();
+		interval = result["interval"].as<unsigned long>();
+		intervals = result["intervals"].as<unsigned long>();
+		precision = result["precision"].as<unsigned>();
+		approximate = result["approximate"].as<bool>();
+		perPid = result["pid"].as<bool>();
+		maxOutliers = result["outliers"].as<std::size_t>();
+		if (result.count("binaryTraces")) {
+			binaryTraces = result["binaryTraces"].as<std::vector<std::string>>();
+		}
+	}
+
+	const Buckets buckets{linear ? Buckets::linear(interval, intervals) : Buckets::logLinear(precision)};
+	Statistics statistics{buckets, !approximate, perPid, maxOutliers};
+	if (binaryTraces.empty()) {
+		addTextTrace(stdin, statistics);
+	} else {
+		for (std::string const& fileName : binaryTraces) {
+			if (!addBinaryTrace(fileName, statistics)) {
+				return 1;
+			}
+		}
+	}
+	statistics.print();
 
 	return 0;
 }